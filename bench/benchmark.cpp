@@ -0,0 +1,835 @@
+// Microbenchmarks for the data structures in elearning.h.
+//
+//   g++ -std=c++17 -O2 -pthread bench/benchmark.cpp src/*.cpp -o elearning-bench
+//   ./elearning-bench [--max N] [--filter TEXT] [--csv] [--no-metrics]
+//
+// Every benchmark runs at 1k, 10k, 100k, ... up to --max records (default
+// 1M, at most 10M) and reports ns/op, heap allocations/op and a growth
+// exponent: how per-op cost scales with n between consecutive sizes
+// (0 = constant, 1 = linear per op). Setup is excluded from the timings.
+// --no-metrics turns off the latency histograms to measure their overhead.
+#include <iostream>
+#include <iomanip>
+#include <functional>
+#include <random>
+#include <cmath>
+#include <thread>
+#include "../elearning.h"
+
+// ============== ALLOCATION COUNTING ==============
+static atomic<uint64_t> heapAllocations{0};
+
+void* operator new(size_t size) {
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    heapAllocations.fetch_add(1, memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+// Kept out of line so GCC does not pair the inlined malloc/free with new/delete
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void operator delete(void* p) noexcept { free(p); }
+BENCH_NOINLINE void operator delete[](void* p) noexcept { free(p); }
+BENCH_NOINLINE void operator delete(void* p, size_t) noexcept { free(p); }
+BENCH_NOINLINE void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// ============== TIMER ==============
+// Accumulates time and allocations between start() and stop(), so a
+// benchmark can keep its setup out of the measurement
+class Timer {
+private:
+    chrono::steady_clock::time_point begin;
+    uint64_t allocationsAtStart;
+
+public:
+    double seconds = 0;
+    uint64_t allocations = 0;
+
+    void start() {
+        allocationsAtStart = heapAllocations.load(memory_order_relaxed);
+        begin = chrono::steady_clock::now();
+    }
+
+    void stop() {
+        seconds += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        allocations += heapAllocations.load(memory_order_relaxed) - allocationsAtStart;
+    }
+};
+
+// ============== WORKLOAD GENERATORS ==============
+// Zipf(s) over ranks [0, count): a few keys take most of the traffic
+class ZipfGenerator {
+private:
+    vector<double> cdf;
+
+public:
+    ZipfGenerator(size_t count, double s = 1.1) : cdf(count) {
+        double sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += 1.0 / pow((double)(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (double& value : cdf) value /= sum;
+    }
+
+    template <typename Rng>
+    size_t next(Rng& rng) {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+        return min(cdf.size() - 1, (size_t)(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin()));
+    }
+};
+
+string padded(size_t value, int width) {
+    string digits = to_string(value);
+    return string(width > (int)digits.size() ? width - digits.size() : 0, '0') + digits;
+}
+
+// "2025-MM-DD" for day 0..335 of a 28-day-month calendar
+string dateForDay(size_t day) {
+    return "2025-" + padded(day / 28 % 12 + 1, 2) + "-" + padded(day % 28 + 1, 2);
+}
+
+enum TitleShape { TITLES_SORTED, TITLES_SKEWED, TITLES_RANDOM };
+enum DateShape { DATES_UNIFORM, DATES_BURST };
+
+vector<string> makeTitles(size_t n, TitleShape shape, mt19937_64& rng) {
+    vector<string> titles(n);
+    if (shape == TITLES_SORTED) {
+        for (size_t i = 0; i < n; i++) titles[i] = "Lab " + padded(i, 8);
+    } else if (shape == TITLES_SKEWED) {
+        // Many assignments share a handful of popular titles
+        ZipfGenerator zipf(1000);
+        for (size_t i = 0; i < n; i++) titles[i] = "Topic " + to_string(zipf.next(rng));
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            titles[i].resize(12);
+            for (char& c : titles[i]) c = 'a' + rng() % 26;
+        }
+    }
+    return titles;
+}
+
+// Burst: 90% of due dates fall on three end-of-term deadlines
+vector<string> makeDates(size_t n, DateShape shape, mt19937_64& rng) {
+    vector<string> dates(n);
+    for (size_t i = 0; i < n; i++) {
+        if (shape == DATES_BURST && rng() % 10 != 0)
+            dates[i] = dateForDay(300 + rng() % 3);
+        else
+            dates[i] = dateForDay(rng() % 336);
+    }
+    return dates;
+}
+
+vector<Assignment> makeAssignments(size_t n, TitleShape titles, DateShape dates, mt19937_64& rng) {
+    vector<string> titleList = makeTitles(n, titles, rng);
+    vector<string> dateList = makeDates(n, dates, rng);
+    vector<Assignment> out(n);
+    for (size_t i = 0; i < n; i++) {
+        out[i].assignmentID = "ASSG" + to_string(1001 + i);
+        out[i].title = move(titleList[i]);
+        out[i].description = "";
+        out[i].dueDate = move(dateList[i]);
+        out[i].maxScore = 100;
+        out[i].next = nullptr;
+    }
+    return out;
+}
+
+Student makeStudent(size_t index) {
+    return Student{"S" + to_string(100000 + index), "Student " + to_string(index), "", 0, 0};
+}
+
+// n distinct (student, assignment) submissions: Zipf-distributed students,
+// each submitting to assignments in order, so busy students submit a lot
+void fillSubmissions(SubmissionQueue& queue, vector<Assignment>& assignments,
+                     size_t n, ZipfGenerator& students, mt19937_64& rng) {
+    unordered_map<size_t, size_t> nextAssignment;
+    size_t added = 0;
+    while (added < n) {
+        size_t student = students.next(rng);
+        size_t& slot = nextAssignment[student];
+        if (slot >= assignments.size()) continue;
+        queue.submit(makeStudent(student), &assignments[slot++], "file");
+        added++;
+    }
+}
+
+// n rows with Zipf-distributed students (interned, so ranking ties compare
+// real IDs) over n/1000 assignments; three in four rows are graded
+void fillColumns(SubmissionColumns& columns, size_t n) {
+    mt19937_64 rng(10);
+    size_t studentCount = max<size_t>(n / 10, 10);
+    ZipfGenerator students(studentCount);
+    vector<uint32_t> studentSlots(studentCount);
+    for (size_t i = 0; i < studentCount; i++)
+        studentSlots[i] = columns.studentSlot(intern(makeStudent(i).studentID));
+    size_t assignmentCount = max<size_t>(n / 1000, 50);
+    for (size_t i = 0; i < assignmentCount; i++) columns.assignmentSlot(intern("ASSG" + to_string(1001 + i)));
+    columns.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        bool graded = rng() % 4 != 0;
+        columns.append(studentSlots[students.next(rng)], (uint32_t)(rng() % assignmentCount),
+                       graded ? SUBMISSION_GRADED : SUBMISSION_PENDING, (int)(rng() % 101));
+    }
+}
+
+// n feedback-like texts of six words from a Zipf-distributed 5000-word vocabulary
+vector<string> makeFeedback(size_t n, mt19937_64& rng) {
+    ZipfGenerator words(5000);
+    vector<string> texts(n);
+    for (string& text : texts) {
+        for (int i = 0; i < 6; i++) text += "word" + to_string(words.next(rng)) + " ";
+    }
+    return texts;
+}
+
+// ============== BENCHMARKS ==============
+// Results are written here so the compiler cannot drop the measured work
+volatile size_t benchmarkSink;
+
+struct Benchmark {
+    string name;
+    size_t maxN;   // quadratic benchmarks stop early
+    // Builds the state for n records, times the measured part with the
+    // timer and returns the number of operations it performed
+    function<size_t(size_t n, Timer& timer)> run;
+};
+
+vector<Benchmark> makeBenchmarks() {
+    vector<Benchmark> list;
+    const size_t unlimited = SIZE_MAX;
+
+    const pair<const char*, TitleShape> titleShapes[] = {
+        {"sorted", TITLES_SORTED}, {"skewed", TITLES_SKEWED}, {"random", TITLES_RANDOM}};
+    for (auto shape : titleShapes) {
+        TitleShape titleShape = shape.second;
+        list.push_back({string("BPlusTree/insert/") + shape.first, unlimited,
+            [titleShape](size_t n, Timer& timer) {
+                mt19937_64 rng(1);
+                vector<Assignment> items = makeAssignments(n, titleShape, DATES_UNIFORM, rng);
+                BPlusTree tree;
+                timer.start();
+                for (Assignment& item : items) tree.insertItem(item.title, &item);
+                timer.stop();
+                return n;
+            }});
+        list.push_back({string("BPlusTree/search/") + shape.first, unlimited,
+            [titleShape](size_t n, Timer& timer) {
+                mt19937_64 rng(2);
+                vector<Assignment> items = makeAssignments(n, titleShape, DATES_UNIFORM, rng);
+                BPlusTree tree;
+                for (Assignment& item : items) tree.insertItem(item.title, &item);
+                vector<string> probes(n);
+                for (string& probe : probes) probe = items[rng() % n].title;
+                size_t found = 0;
+                timer.start();
+                for (const string& probe : probes) found += tree.searchByTitle(probe) != nullptr;
+                timer.stop();
+                if (found != n) cerr << "BPlusTree/search: missing keys\n";
+                return n;
+            }});
+    }
+
+    list.push_back({"BPlusTree/bulkInsert/random", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(3);
+        vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, DATES_UNIFORM, rng);
+        vector<Assignment*> pointers;
+        for (Assignment& item : items) pointers.push_back(&item);
+        BPlusTree tree;
+        timer.start();
+        tree.bulkInsert(pointers);
+        timer.stop();
+        return n;
+    }});
+
+    // Undo and redo of edits relink nodes next to their old neighbour, so
+    // the cost stays flat however long the due-date list is
+    list.push_back({"ChangeHistory/undoRedo", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(12);
+        vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, DATES_UNIFORM, rng);
+        AssignmentLinkedList assignments;
+        SubmissionQueue submissions;
+        ChangeHistory history(assignments, submissions);
+        assignments.bulkInsert(items);
+        for (size_t i = 0; i < HISTORY_LIMIT; i++) {
+            const Assignment& item = items[i % items.size()];
+            history.editAssignment(item.assignmentID, {item.title + "'", "", item.dueDate, item.maxScore});
+        }
+        timer.start();
+        for (size_t i = 0; i < n; i++) {
+            if (i % (2 * HISTORY_LIMIT) < HISTORY_LIMIT) history.undo();
+            else history.redo();
+        }
+        timer.stop();
+        return n;
+    }});
+
+    // The calendar index finds each insert's place in the due-date list in O(log n)
+    const pair<const char*, DateShape> dateShapes[] = {{"uniform", DATES_UNIFORM}, {"burst", DATES_BURST}};
+    for (auto shape : dateShapes) {
+        DateShape dateShape = shape.second;
+        list.push_back({string("AssignmentList/sortedInsert/") + shape.first, unlimited,
+            [dateShape](size_t n, Timer& timer) {
+                mt19937_64 rng(4);
+                vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, dateShape, rng);
+                AssignmentLinkedList assignments;
+                timer.start();
+                for (Assignment& item : items)
+                    assignments.createAssignment({item.title, "", item.dueDate, item.maxScore});
+                timer.stop();
+                return n;
+            }});
+        list.push_back({string("AssignmentList/bulkInsert/") + shape.first, unlimited,
+            [dateShape](size_t n, Timer& timer) {
+                mt19937_64 rng(5);
+                vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, dateShape, rng);
+                AssignmentLinkedList assignments;
+                timer.start();
+                assignments.bulkInsert(items);
+                timer.stop();
+                return n;
+            }});
+    }
+
+    // 7-day windows; ops are rows returned plus one per query, so a flat
+    // ns/op means each query costs one descent plus O(1) per row
+    list.push_back({"Calendar/dueBetween", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(13);
+        vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, DATES_UNIFORM, rng);
+        AssignmentLinkedList assignments;
+        for (Assignment& item : items)
+            assignments.createAssignment({item.title, "", item.dueDate, item.maxScore});
+        vector<int> starts(1000);
+        for (int& start : starts) start = dayNumber(dateForDay(rng() % 336));
+        size_t rows = 0;
+        timer.start();
+        for (int start : starts)
+            assignments.forEachDueBetween(start, start + 6, [&](string_view, string_view, string_view, int) { rows++; });
+        timer.stop();
+        return rows + starts.size();
+    }});
+
+    // Every page of the due-date listing rendered through one reused
+    // buffer; a flat ns/op means a page costs the same wherever it starts
+    list.push_back({"TableWriter/dueDatePages", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(16);
+        vector<Assignment> items = makeAssignments(n, TITLES_RANDOM, DATES_UNIFORM, rng);
+        AssignmentLinkedList assignments;
+        for (Assignment& item : items)
+            assignments.createAssignment({item.title, "", item.dueDate, item.maxScore});
+        TableWriter table;
+        table.setColumns({12, 25, 15, 10});
+        size_t bytes = 0;
+        timer.start();
+        DueDateCursor cursor = assignments.firstByDueDate();
+        size_t rows;
+        do {
+            table.clear();
+            rows = assignments.forEachByDueDateFrom(cursor, 20,
+                [&](string_view id, string_view title, string_view dueDate, int maxScore) {
+                    table.cell(id).cell(title).cell(dueDate).cell((long long)maxScore).endRow();
+                });
+            bytes += table.str().size();
+        } while (rows > 0);
+        timer.stop();
+        return bytes > 0 ? n : 0;
+    }});
+
+    list.push_back({"TextIndex/add", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(14);
+        vector<string> texts = makeFeedback(n, rng);
+        TextIndex index;
+        timer.start();
+        for (size_t i = 0; i < n; i++) index.add((uint32_t)i, texts[i]);
+        timer.stop();
+        return n;
+    }});
+
+    // Two-word queries, words drawn from the same skewed vocabulary
+    const pair<const char*, bool> matchModes[] = {{"all", true}, {"any", false}};
+    for (auto mode : matchModes) {
+        bool matchAll = mode.second;
+        list.push_back({string("TextIndex/search/") + mode.first, unlimited, [matchAll](size_t n, Timer& timer) {
+            mt19937_64 rng(15);
+            vector<string> texts = makeFeedback(n, rng);
+            TextIndex index;
+            for (size_t i = 0; i < n; i++) index.add((uint32_t)i, texts[i]);
+            ZipfGenerator words(5000);
+            vector<string> queries(100);
+            for (string& query : queries)
+                query = "word" + to_string(words.next(rng)) + " word" + to_string(words.next(rng));
+            size_t hits = 0;
+            timer.start();
+            for (const string& query : queries) hits += index.search(query, matchAll, 20).size();
+            timer.stop();
+            benchmarkSink = hits;
+            return queries.size();
+        }});
+    }
+
+    list.push_back({"SubmissionQueue/submit/zipf", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(6);
+        vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        SubmissionQueue queue;
+        timer.start();
+        fillSubmissions(queue, assignments, n, students, rng);
+        timer.stop();
+        return n;
+    }});
+
+    list.push_back({"SubmissionQueue/isDuplicate/zipf", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(7);
+        vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        SubmissionQueue queue;
+        fillSubmissions(queue, assignments, n, students, rng);
+        vector<pair<string, string>> probes(n);
+        for (auto& probe : probes)
+            probe = {makeStudent(students.next(rng)).studentID, assignments[rng() % assignments.size()].assignmentID};
+        size_t hits = 0;
+        timer.start();
+        for (auto& probe : probes) hits += queue.isDuplicate(probe.first, probe.second);
+        timer.stop();
+        benchmarkSink = hits;
+        return n;
+    }});
+
+    // Fixed cost every instrumented operation pays: two clock reads and a shard update
+    list.push_back({"Metrics/timer", unlimited, [](size_t n, Timer& timer) {
+        timer.start();
+        for (size_t i = 0; i < n; i++) {
+            MetricTimer sample(METRIC_REQUEST);
+        }
+        timer.stop();
+        benchmarkSink = metrics().histogram(METRIC_REQUEST).count;
+        return n;
+    }});
+
+    // Deadline burst: every producer thread submits to the same few assignments
+    list.push_back({"SubmissionQueue/concurrentIntake/burst", unlimited, [](size_t n, Timer& timer) {
+        ELearningSystem system;
+        for (int i = 0; i < 3; i++)
+            system.createAssignment({"Final " + to_string(i), "", dateForDay(300 + i), 100});
+        const int producers = 4;
+        timer.start();
+        vector<thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&system, n, p] {
+                for (size_t i = p; i < n; i += producers)
+                    system.submitConcurrent(makeStudent(i / 3), "ASSG" + to_string(1001 + i % 3), "file");
+            });
+        }
+        for (thread& t : threads) t.join();
+        system.drainSubmissions();
+        timer.stop();
+        return n;
+    }});
+
+    list.push_back({"Rankings/grade/zipf", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(8);
+        vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        SubmissionQueue queue;
+        fillSubmissions(queue, assignments, n, students, rng);
+        vector<string> ids;
+        queue.forEachPending([&](const Submission& sub) { ids.push_back(formatSubmissionID(sub.submissionID)); });
+        timer.start();
+        for (const string& id : ids) queue.grade(id, (int)(rng() % 101), "");
+        timer.stop();
+        return ids.size();
+    }});
+
+    // Every submission graded once, then regraded; ops are regrades, each
+    // moving one student in the ranking tree
+    list.push_back({"Rankings/regrade/zipf", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(13);
+        vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        SubmissionQueue queue;
+        fillSubmissions(queue, assignments, n, students, rng);
+        vector<string> ids;
+        queue.forEachPending([&](const Submission& sub) { ids.push_back(formatSubmissionID(sub.submissionID)); });
+        for (const string& id : ids) queue.grade(id, (int)(rng() % 101), "");
+        shuffle(ids.begin(), ids.end(), rng);
+        timer.start();
+        for (const string& id : ids) queue.regrade(id, (int)(rng() % 101), "");
+        timer.stop();
+        return ids.size();
+    }});
+
+    // One batch regrade of each assignment over n graded submissions; ops
+    // are submissions regraded
+    list.push_back({"SubmissionQueue/regradeAssignment", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(14);
+        vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        SubmissionQueue queue;
+        fillSubmissions(queue, assignments, n, students, rng);
+        vector<string> ids;
+        queue.forEachPending([&](const Submission& sub) { ids.push_back(formatSubmissionID(sub.submissionID)); });
+        for (const string& id : ids) queue.grade(id, (int)(rng() % 101), "");
+        size_t regraded = 0;
+        timer.start();
+        for (const Assignment& assignment : assignments) {
+            vector<RegradeEntry> entries;
+            queue.forEachGradedOf(assignment.assignmentID, [&](const Submission& sub) {
+                entries.push_back(RegradeEntry{sub.submissionID, 0, min(sub.score + 5, 100), "", sub.feedback});
+            });
+            queue.regrade(entries);
+            regraded += entries.size();
+        }
+        timer.stop();
+        return max<size_t>(regraded, 1);
+    }});
+
+    // Fingerprinting n bytes of source-like text; ops are bytes
+    list.push_back({"MinHash/addBytes", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(15);
+        const char* tokens[] = {"int ", "for (", "i++) ", "return ", "value", " = ", ";\n", "node->", "left", "right"};
+        string text;
+        while (text.size() < n) text += tokens[rng() % 10];
+        text.resize(n);
+        MinHasher hasher;
+        Fingerprint print;
+        ShingleWindow window;
+        timer.start();
+        MinHasher::begin(print, window);
+        hasher.addBytes(print, window, (const unsigned char*)text.data(), text.size());
+        timer.stop();
+        benchmarkSink = print.minimum[0];
+        return n;
+    }});
+
+    // Hashing n bytes in BLOB_CHUNK pieces; ops are bytes
+    list.push_back({"Sha256/update", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(17);
+        vector<unsigned char> data(n);
+        for (unsigned char& byte : data) byte = (unsigned char)rng();
+        Sha256 hasher;
+        timer.start();
+        for (size_t at = 0; at < n; at += BLOB_CHUNK) hasher.update(data.data() + at, min(BLOB_CHUNK, n - at));
+        string digest = hasher.hex();
+        timer.stop();
+        benchmarkSink = digest[0];
+        return n;
+    }});
+
+    // Compressing n bytes of source-like text chunk by chunk; ops are bytes
+    list.push_back({"BlobStore/compressChunk", unlimited, [](size_t n, Timer& timer) {
+        mt19937_64 rng(18);
+        const char* tokens[] = {"int ", "for (", "i++) ", "return ", "value", " = ", ";\n", "node->", "left", "right"};
+        string text;
+        while (text.size() < n) text += tokens[rng() % 10];
+        vector<unsigned char> packed(BLOB_CHUNK + BLOB_CHUNK / 255 + 16);
+        vector<uint32_t> table;
+        size_t packedTotal = 0;
+        timer.start();
+        for (size_t at = 0; at < n; at += BLOB_CHUNK)
+            packedTotal += compressChunk((const unsigned char*)text.data() + at, min(BLOB_CHUNK, n - at),
+                                         packed.data(), table);
+        timer.stop();
+        benchmarkSink = packedTotal;
+        return n;
+    }});
+
+    // Storing n 16 KB files, every fourth a copy of an earlier one (the
+    // copies are deduplicated); ops are files. Written to a scratch directory.
+    const pair<const char*, bool> blobModes[] = {{"raw", false}, {"compressed", true}};
+    for (const auto& blobMode : blobModes) {
+        bool compress = blobMode.second;
+        list.push_back({string("BlobStore/put/") + blobMode.first, 10000, [compress](size_t n, Timer& timer) {
+            mt19937_64 rng(19);
+            string directory = "elearning-bench-blobs";
+            system(("rm -rf " + directory + " && mkdir -p " + directory + "/in").c_str());
+            vector<string> paths(n);
+            for (size_t i = 0; i < n; i++) {
+                paths[i] = directory + "/in/" + to_string(i);
+                if (i % 4 == 3) {
+                    paths[i] = paths[rng() % i];
+                    continue;
+                }
+                string text;
+                while (text.size() < 16 * 1024) text += "line " + to_string(rng() % 1000) + " of " + to_string(i) + "\n";
+                FILE* out = fopen(paths[i].c_str(), "wb");
+                fwrite(text.data(), 1, text.size(), out);
+                fclose(out);
+            }
+            BlobStore store;
+            store.open(directory + "/store");
+            store.setCompression(compress);
+            string digest;
+            size_t stored = 0;
+            timer.start();
+            for (const string& path : paths) stored += store.put(path, digest) == STATUS_OK;
+            timer.stop();
+            system(("rm -rf " + directory).c_str());
+            benchmarkSink = stored;
+            return n;
+        }});
+    }
+
+    // One query per indexed file over n files of one assignment, written
+    // to a scratch directory during setup; every other file is a
+    // near-copy of the one before it
+    list.push_back({"SimilarityIndex/similarTo", 10000, [](size_t n, Timer& timer) {
+        mt19937_64 rng(16);
+        string directory = "elearning-bench-similarity";
+        system(("mkdir -p " + directory).c_str());
+        string original;
+        SimilarityIndex index;
+        index.start(max((int)thread::hardware_concurrency(), 1));
+        for (size_t i = 0; i < n; i++) {
+            string path = directory + "/" + to_string(i);
+            if (i % 2 == 0) {
+                original.clear();
+                for (int k = 0; k < 300; k++) original += to_string(rng() % 1000) + " ";
+            }
+            string text = original + (i % 2 ? to_string(rng() % 1000) : "");
+            FILE* out = fopen(path.c_str(), "wb");
+            fwrite(text.data(), 1, text.size(), out);
+            fclose(out);
+            index.add((uint32_t)i, 1, path);
+        }
+        for (SimilarityStats stats = index.stats(); stats.indexed + stats.unreadable + stats.tooShort < (long long)n;
+             stats = index.stats())
+            this_thread::yield();
+        index.stop();
+        size_t found = 0;
+        timer.start();
+        for (size_t i = 0; i < n; i++) found += index.similarTo((uint32_t)i).size();
+        timer.stop();
+        system(("rm -rf " + directory).c_str());
+        benchmarkSink = found;
+        return n;
+    }});
+
+    // Grade one submission, then report per-assignment statistics, 100
+    // times over n submissions; ops are reports. "views" reads the totals
+    // kept by the grade events, "scan" recomputes them from the columns.
+    const pair<const char*, bool> reportModes[] = {{"views", true}, {"scan", false}};
+    for (const auto& reportMode : reportModes) {
+        bool useViews = reportMode.second;
+        list.push_back({string("SubmissionQueue/gradeThenReport/") + reportMode.first, unlimited,
+                        [useViews](size_t n, Timer& timer) {
+            mt19937_64 rng(12);
+            vector<Assignment> assignments = makeAssignments(max<size_t>(n / 100, 50), TITLES_RANDOM, DATES_BURST, rng);
+            ZipfGenerator students(max<size_t>(n / 10, 10));
+            SubmissionQueue queue;
+            fillSubmissions(queue, assignments, n, students, rng);
+            vector<string> ids;
+            queue.forEachPending([&](const Submission& sub) { ids.push_back(formatSubmissionID(sub.submissionID)); });
+            size_t reports = min<size_t>(ids.size(), 100);
+            size_t total = useViews ? queue.assignmentSummaries().size() : queue.assignmentAggregates(1).size();
+            timer.start();
+            for (size_t i = 0; i < reports; i++) {
+                queue.grade(ids[i], (int)(rng() % 101), "");
+                total += useViews ? queue.assignmentSummaries().size() : queue.assignmentAggregates(1).size();
+            }
+            timer.stop();
+            benchmarkSink = total;
+            return reports;
+        }});
+    }
+
+    list.push_back({"Rankings/rankOf+top10/zipf", unlimited, [](size_t n, Timer& timer) {
+        RankingTree rankings;
+        mt19937_64 rng(9);
+        ZipfGenerator students(max<size_t>(n / 10, 10));
+        for (size_t i = 0; i < n; i++) {
+            size_t student = students.next(rng);
+            rankings.addScore(makeStudent(student).studentID, "", (int)(rng() % 101));
+        }
+        vector<string> probes(n);
+        for (string& probe : probes) probe = makeStudent(students.next(rng)).studentID;
+        size_t total = 0;
+        timer.start();
+        for (const string& probe : probes) {
+            total += rankings.rankOf(probe);
+            total += rankings.topK(10).size();
+        }
+        timer.stop();
+        benchmarkSink = total;
+        return n;
+    }});
+
+    // Claim and complete every item once; ops are claims
+    const pair<GradingPolicy, string> policies[] = {
+        {GRADE_OLDEST_FIRST, "oldest"}, {GRADE_NEAREST_DUE, "nearestDue"}, {GRADE_BY_ASSIGNMENT, "byAssignment"}};
+    for (const auto& policy : policies) {
+        GradingPolicy mode = policy.first;
+        list.push_back({"Scheduler/claim+complete/" + policy.second, unlimited, [mode](size_t n, Timer& timer) {
+            mt19937_64 rng(11);
+            GradingScheduler scheduler;
+            size_t assignmentCount = max<size_t>(n / 100, 10);
+            for (size_t i = 0; i < n; i++) {
+                size_t assignment = rng() % assignmentCount;
+                scheduler.add((uint32_t)(10001 + i), (Symbol)(assignment + 1), (uint32_t)dayNumber(dateForDay(assignment % 336)));
+            }
+            const string graders[] = {"g1", "g2", "g3", "g4"};
+            auto pending = [](uint32_t) { return true; };
+            GradingScheduler::Clock::time_point now = GradingScheduler::Clock::now();
+            size_t claims = 0;
+            uint32_t id;
+            timer.start();
+            while (scheduler.claim(graders[claims % 4], mode, now, id, pending)) {
+                scheduler.complete(graders[claims % 4], id, now);
+                claims++;
+            }
+            timer.stop();
+            return claims;
+        }});
+    }
+
+    // One pass of each aggregation over n rows; ops are rows scanned.
+    // The parallel runs use every core (skipped on a single-core machine).
+    vector<int> threadCounts = {1};
+    if (hardwareThreads() > 1) threadCounts.push_back(hardwareThreads());
+    for (int threads : threadCounts) {
+        string mode = threads == 1 ? "serial" : "parallel";
+        list.push_back({"Columns/aggregate/" + mode, unlimited, [threads](size_t n, Timer& timer) {
+            SubmissionColumns columns;
+            fillColumns(columns, n);
+            timer.start();
+            size_t total = (size_t)columns.gradedCount(threads);
+            total += columns.studentAggregates(threads).size();
+            total += columns.assignmentAggregates(threads).size();
+            timer.stop();
+            benchmarkSink = total;
+            return n;
+        }});
+
+        list.push_back({"Columns/rankStudents/" + mode, unlimited, [threads](size_t n, Timer& timer) {
+            SubmissionColumns columns;
+            fillColumns(columns, n);
+            timer.start();
+            benchmarkSink = columns.rankStudents(threads).size();
+            timer.stop();
+            return n;
+        }});
+
+        // n submissions spread over 16 in-memory courses; ops are submissions
+        // covered by one summary report and one institution leaderboard
+        list.push_back({"CourseRouter/report/" + mode, unlimited, [threads](size_t n, Timer& timer) {
+            const int courses = 16;
+            mt19937_64 rng(11);
+            CourseRouter router;
+            ZipfGenerator students(max<size_t>(n / 10, 10));
+            for (int c = 0; c < courses; c++) {
+                ELearningSystem* course = nullptr;
+                router.course("C" + to_string(c), &course, true);
+                vector<Assignment> specs = makeAssignments(max<size_t>(n / courses / 100, 5), TITLES_RANDOM, DATES_UNIFORM, rng);
+                for (const Assignment& spec : specs)
+                    course->createAssignment({spec.title, "", spec.dueDate, spec.maxScore});
+                size_t assignments = specs.size();
+                for (size_t i = 0; i < n / courses; i++) {
+                    Submission* sub = nullptr;
+                    course->submit(makeStudent(students.next(rng)), "ASSG" + to_string(1001 + i % assignments), "file", &sub);
+                    if (sub != nullptr && i % 4 != 0)
+                        course->grade(formatSubmissionID(sub->submissionID), (int)(rng() % 101), "");
+                }
+            }
+            timer.start();
+            size_t total = router.courseSummaries(threads).size();
+            total += router.rankStudents(threads).size();
+            timer.stop();
+            benchmarkSink = total;
+            return n;
+        }});
+    }
+
+    return list;
+}
+
+// ============== DRIVER ==============
+struct Sample {
+    string name;
+    size_t n;
+    double nsPerOp;
+    double allocsPerOp;
+    double growth;  // NAN for the first size
+};
+
+void printSample(const Sample& sample, bool csv) {
+    if (csv) {
+        cout << sample.name << "," << sample.n << "," << fixed << setprecision(2) << sample.nsPerOp << ","
+             << setprecision(3) << sample.allocsPerOp << ",";
+        if (!std::isnan(sample.growth)) cout << setprecision(2) << sample.growth;
+        cout << endl;
+        return;
+    }
+    cout << left << setw(44) << sample.name
+         << right << setw(10) << sample.n
+         << setw(14) << fixed << setprecision(1) << sample.nsPerOp
+         << setw(12) << setprecision(3) << sample.allocsPerOp;
+    if (std::isnan(sample.growth)) cout << setw(10) << "-";
+    else cout << setw(10) << setprecision(2) << sample.growth;
+    cout << endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxN = 1000000;
+    string filter;
+    bool csv = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--max" && i + 1 < argc) {
+            maxN = min<size_t>(strtoull(argv[++i], nullptr, 10), 10000000);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--csv") {
+            csv = true;
+        } else if (arg == "--no-metrics") {
+            metrics().setEnabled(false);
+        } else {
+            cout << "Usage: elearning-bench [--max N] [--filter TEXT] [--csv] [--no-metrics]\n";
+            return 1;
+        }
+    }
+
+    if (csv) {
+        cout << "benchmark,n,ns_per_op,allocs_per_op,growth" << endl;
+    } else {
+        cout << left << setw(44) << "Benchmark"
+             << right << setw(10) << "n"
+             << setw(14) << "ns/op"
+             << setw(12) << "allocs/op"
+             << setw(10) << "growth" << endl;
+        cout << string(90, '-') << endl;
+    }
+
+    for (const Benchmark& benchmark : makeBenchmarks()) {
+        if (!filter.empty() && benchmark.name.find(filter) == string::npos) continue;
+
+        double previousNs = NAN;
+        size_t previousN = 0;
+        for (size_t n = 1000; n <= maxN && n <= benchmark.maxN; n *= 10) {
+            // Small sizes are repeated until they have run for long enough to time
+            Timer timer;
+            size_t ops = 0;
+            do {
+                ops += benchmark.run(n, timer);
+            } while (timer.seconds < 0.2 && n < 100000);
+
+            Sample sample{benchmark.name, n, timer.seconds * 1e9 / ops,
+                          (double)timer.allocations / ops, NAN};
+            if (previousN != 0)
+                sample.growth = log(sample.nsPerOp / previousNs) / log((double)n / previousN);
+            printSample(sample, csv);
+            previousNs = sample.nsPerOp;
+            previousN = n;
+        }
+    }
+    return 0;
+}
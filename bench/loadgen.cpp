@@ -0,0 +1,315 @@
+// Load generator for the socket server (elearning-system --serve SOCKET).
+//
+//   g++ -std=c++17 -O2 -pthread bench/loadgen.cpp src/*.cpp -o elearning-loadgen
+//   ./elearning-loadgen [--socket PATH] [--clients N] [--depth D] [--seconds S] [--mix read|mixed]
+//
+// Each client is a thread with its own connection, logged in as its own
+// student. It keeps up to --depth requests in flight, sending each batch in
+// one write, and times every request from the write that carried it to the
+// read that returned its response. The run reports requests/sec and latency
+// percentiles over all clients. Before starting, a lecturer connection makes
+// sure there are at least --assignments assignments to list and submit to.
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include "../elearning.h"
+
+#ifdef __linux__
+
+typedef chrono::steady_clock Clock;
+
+// ============== CLIENT CONNECTION ==============
+// Blocking client side of the protocol in src/server.h
+class ClientConnection {
+private:
+    int fd;
+    string input;
+    RecordWriter output;
+    uint32_t nextID;
+
+public:
+    ClientConnection() : fd(-1), nextID(1) {}
+
+    bool open(const string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        return fd >= 0 && connect(fd, (sockaddr*)&address, sizeof(address)) == 0;
+    }
+
+    // Queues a request and returns its id; send() writes everything queued
+    uint32_t request(RequestOp op, const RecordWriter& payload) {
+        uint32_t id = nextID++;
+        size_t start = beginFrame(output, id, op);
+        output.bytes += payload.bytes;
+        endFrame(output, start);
+        return id;
+    }
+
+    bool send() {
+        size_t sent = 0;
+        while (sent < output.bytes.size()) {
+            ssize_t n = ::send(fd, output.bytes.data() + sent, output.bytes.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += (size_t)n;
+        }
+        output.bytes.clear();
+        return true;
+    }
+
+    // Blocks until at least one response is in, then calls
+    // visit(id, status, payload) for each complete one
+    template <typename Visit>
+    bool receive(Visit visit) {
+        char chunk[64 * 1024];
+        while (true) {
+            size_t used = 0, frame;
+            while ((frame = frameSize(input.data() + used, input.size() - used)) != 0) {
+                if (frame == SIZE_MAX) return false;
+                RecordReader payload(input.data() + used + 9, frame - 9);
+                RecordReader header(input.data() + used + 4, 5);
+                uint32_t id = header.getU32();
+                visit(id, (Status)header.getU8(), payload);
+                used += frame;
+            }
+            input.erase(0, used);
+            if (used > 0) return true;
+
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            input.append(chunk, (size_t)n);
+        }
+    }
+
+    // One request, waiting for its response
+    Status call(RequestOp op, const RecordWriter& payload, string* response = nullptr) {
+        request(op, payload);
+        Status status = STATUS_INVALID;
+        if (!send()) return status;
+        bool done = receive([&](uint32_t, Status result, RecordReader& reader) {
+            status = result;
+            if (response) *response = reader.getString();
+        });
+        return done ? status : STATUS_INVALID;
+    }
+
+    ~ClientConnection() {
+        if (fd >= 0) close(fd);
+    }
+};
+
+// ============== SETUP ==============
+// Assignment IDs to submit to, creating assignments if there are too few
+bool prepareAssignments(const string& path, size_t wanted, vector<string>& ids) {
+    ClientConnection lecturer;
+    if (!lecturer.open(path)) return false;
+    RecordWriter login;
+    login.putString("loadgen");
+    if (lecturer.call(OP_LOGIN_LECTURER, login) != STATUS_OK) return false;
+
+    uint32_t total = 0;
+    bool ok = true;
+    do {
+        RecordWriter page;
+        page.putU32((uint32_t)ids.size());
+        page.putU32(MAX_PAGE_ROWS);
+        lecturer.request(OP_LIST_ASSIGNMENTS, page);
+        ok = lecturer.send() && lecturer.receive([&](uint32_t, Status status, RecordReader& reader) {
+            if (status != STATUS_OK) return;
+            total = reader.getU32();
+            uint32_t rows = reader.getU32();
+            for (uint32_t i = 0; i < rows; i++) {
+                ids.push_back(reader.getString());
+                reader.getString();
+                reader.getString();
+                reader.getInt();
+            }
+        });
+    } while (ok && ids.size() < total);
+
+    for (size_t i = ids.size(); ok && i < wanted; i++) {
+        RecordWriter spec;
+        spec.putString("Load " + to_string(i));
+        spec.putString("generated by elearning-loadgen");
+        spec.putString("2025-0" + to_string(2 + i % 6) + "-" + to_string(10 + i % 18));
+        spec.putInt(100);
+        string id;
+        if (lecturer.call(OP_CREATE_ASSIGNMENT, spec, &id) != STATUS_OK) return false;
+        ids.push_back(id);
+    }
+    return ok && !ids.empty();
+}
+
+// ============== CLIENT THREADS ==============
+struct ClientResult {
+    vector<uint32_t> latenciesNs;
+    long long errors = 0;
+    bool failed = false;
+};
+
+void runClient(const string& path, int index, int depth, bool writes, Clock::time_point end,
+               const vector<string>& assignmentIDs, const string& file, ClientResult& result) {
+    ClientConnection connection;
+    RecordWriter login;
+    login.putString("LOAD" + to_string(index));
+    login.putString("Load Student " + to_string(index));
+    login.putString("");
+    if (!connection.open(path) || connection.call(OP_LOGIN_STUDENT, login) != STATUS_OK) {
+        result.failed = true;
+        return;
+    }
+
+    mt19937 rng(index);
+    deque<Clock::time_point> inFlight;  // responses come back in request order
+    uint32_t offset = 0;
+    size_t nextAssignment = (size_t)index % assignmentIDs.size();
+    while (true) {
+        bool running = Clock::now() < end;
+        if (!running && inFlight.empty()) break;
+
+        while (running && (int)inFlight.size() < depth) {
+            RecordWriter payload;
+            int pick = rng() % 10;
+            if (pick < 5) {
+                payload.putU32(offset);
+                payload.putU32(20);
+                connection.request(OP_LIST_ASSIGNMENTS, payload);
+                offset = (offset + 20) % (uint32_t)assignmentIDs.size();
+            } else if (pick < 7) {
+                payload.putU32(0);
+                payload.putU32(20);
+                connection.request(OP_MY_SUBMISSIONS, payload);
+            } else if (pick < 8) {
+                connection.request(OP_MY_RANK, payload);
+            } else if (pick < 9 || !writes) {
+                payload.putU32(0);
+                payload.putU32(20);
+                connection.request(OP_RANKINGS, payload);
+            } else {
+                payload.putString(assignmentIDs[nextAssignment]);
+                payload.putString(file);
+                connection.request(OP_SUBMIT, payload);
+                nextAssignment = (nextAssignment + 1) % assignmentIDs.size();
+            }
+            inFlight.push_back(Clock::time_point());
+        }
+        Clock::time_point sentAt = Clock::now();
+        for (Clock::time_point& stamp : inFlight)
+            if (stamp == Clock::time_point()) stamp = sentAt;
+        if (!connection.send()) {
+            result.failed = true;
+            return;
+        }
+
+        bool ok = connection.receive([&](uint32_t, Status status, RecordReader&) {
+            Clock::time_point now = Clock::now();
+            result.latenciesNs.push_back((uint32_t)min<long long>(
+                chrono::duration_cast<chrono::nanoseconds>(now - inFlight.front()).count(), UINT32_MAX));
+            inFlight.pop_front();
+            // A student submitting twice to one assignment is refused by design
+            if (status != STATUS_OK && status != STATUS_DUPLICATE) result.errors++;
+        });
+        if (!ok) {
+            result.failed = true;
+            return;
+        }
+    }
+}
+
+double percentileUs(vector<uint32_t>& sorted, double fraction) {
+    if (sorted.empty()) return 0;
+    size_t index = min(sorted.size() - 1, (size_t)(fraction * sorted.size()));
+    return sorted[index] / 1000.0;
+}
+
+int main(int argc, char* argv[]) {
+    string path = "elearning.sock";
+    int clients = 16, depth = 8;
+    double seconds = 5;
+    size_t assignments = 50;
+    bool writes = true;
+    string uploadDir = ".";
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            path = argv[++i];
+        } else if (arg == "--clients" && i + 1 < argc) {
+            clients = max(1, atoi(argv[++i]));
+        } else if (arg == "--depth" && i + 1 < argc) {
+            depth = max(1, atoi(argv[++i]));
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = max(0.1, atof(argv[++i]));
+        } else if (arg == "--assignments" && i + 1 < argc) {
+            assignments = (size_t)max(1, atoi(argv[++i]));
+        } else if (arg == "--mix" && i + 1 < argc) {
+            writes = string(argv[++i]) != "read";
+        } else if (arg == "--upload-dir" && i + 1 < argc) {
+            uploadDir = argv[++i];
+        } else {
+            cout << "Usage: elearning-loadgen [--socket PATH] [--clients N] [--depth D] [--seconds S] "
+                    "[--assignments N] [--mix read|mixed] [--upload-dir DIR]\n";
+            return 1;
+        }
+    }
+
+    vector<string> assignmentIDs;
+    if (!prepareAssignments(path, assignments, assignmentIDs)) {
+        cout << "Cannot set up assignments through " << path << endl;
+        return 1;
+    }
+
+    // The server reads submitted files from its upload directory, so the
+    // file goes there and is sent by name; every client submits the same
+    // one, which the store keeps once
+    string file = "elearning-load.txt";
+    FILE* out = fopen((uploadDir + "/" + file).c_str(), "wb");
+    if (out == nullptr) {
+        cout << "Cannot create " << uploadDir << "/" << file << endl;
+        return 1;
+    }
+    fputs("int main() { return 0; }\n", out);
+    fclose(out);
+
+    vector<ClientResult> results(clients);
+    vector<thread> threads;
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+    for (int i = 0; i < clients; i++)
+        threads.emplace_back(runClient, path, i, depth, writes, end, cref(assignmentIDs), cref(file), ref(results[i]));
+    for (thread& worker : threads) worker.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+
+    vector<uint32_t> latencies;
+    long long errors = 0;
+    int failed = 0;
+    for (ClientResult& result : results) {
+        latencies.insert(latencies.end(), result.latenciesNs.begin(), result.latenciesNs.end());
+        errors += result.errors;
+        failed += result.failed ? 1 : 0;
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << left << setw(9) << "Clients" << setw(7) << "Depth" << setw(12) << "Requests"
+         << setw(14) << "Requests/sec" << setw(10) << "p50 us" << setw(10) << "p99 us"
+         << setw(11) << "p99.9 us" << "Errors" << endl;
+    cout << string(80, '-') << endl;
+    cout << left << setw(9) << clients << setw(7) << depth << setw(12) << latencies.size()
+         << setw(14) << fixed << setprecision(0) << latencies.size() / elapsed
+         << setprecision(1) << setw(10) << percentileUs(latencies, 0.50)
+         << setw(10) << percentileUs(latencies, 0.99)
+         << setw(11) << percentileUs(latencies, 0.999) << errors << endl;
+    if (failed > 0) cout << failed << " client(s) lost their connection\n";
+    return failed > 0 ? 1 : 0;
+}
+
+#else
+int main() {
+    cout << "elearning-loadgen needs Linux (Unix domain sockets and epoll on the server).\n";
+    return 1;
+}
+#endif
@@ -0,0 +1,23 @@
+// Core of the E-Learning Assignment System: data structures, persistence
+// and bulk import. Nothing here reads cin or writes cout; operations return
+// a Status and the menus in main.cpp do all prompting and printing.
+// Each subsystem has its own header and, for the larger classes, its own
+// source file under src/; this header pulls in all of them.
+#ifndef ELEARNING_H
+#define ELEARNING_H
+
+#include "src/core.h"
+#include "src/index.h"
+#include "src/storage.h"
+#include "src/assignments.h"
+#include "src/submissions.h"
+#include "src/history.h"
+#include "src/scheduler.h"
+#include "src/blobs.h"
+#include "src/import.h"
+#include "src/table.h"
+#include "src/similarity.h"
+#include "src/system.h"
+#include "src/server.h"
+
+#endif
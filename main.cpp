@@ -1,604 +1,895 @@
 #include <iostream>
-#include <string>
 #include <iomanip>
-using namespace std;
+#include <csignal>
+#include "elearning.h"
 
-// ============== STRUCTURES ==============
+// ============== GLOBAL OBJECTS ==============
+CourseRouter router;
+ELearningSystem* elearning;  // the selected course's shard
+string currentCourse = DEFAULT_COURSE;
+Student currentStudent;
 
-struct Assignment {
-    string assignmentID;
-    string title;
-    string dueDate;
-    string description;
-    int maxScore;
-    Assignment* next;
-};
-
-struct Submission {
-    string submissionID;
-    string studentID;
-    string studentName;
-    string assignmentID;
-    string assignmentTitle;
-    string submittedDate;
-    string filePath;
-    string status; 
-    int score;
-    string feedback;
-    Submission* next;
-};
-
-struct Student {
-    string studentID;
-    string name;
-    string email;
-    int totalScore;
-    int submissionCount;
-};
-
-struct StackNode {
-    Assignment* assignment;
-    StackNode* next;
-};
-
-struct BSTNode {
-    string key;      
-    Assignment* value; 
-    BSTNode* left;
-    BSTNode* right;
-};
-
-// ============== BST CLASS ==============
-class BST {
-private:
-    BSTNode* root;
-
-    void insert(BSTNode*& node, string key, Assignment* value) {
-        if (!node)
-            node = new BSTNode{key, value, nullptr, nullptr};
-        else if (key < node->key)
-            insert(node->left, key, value);
-        else if (key > node->key)
-            insert(node->right, key, value);
-    }
-
-    Assignment* search(BSTNode* node, string key) {
-        if (!node) return nullptr;
-        if (key == node->key) return node->value;
-        else if (key < node->key) return search(node->left, key);
-        else return search(node->right, key);
-    }
-
-    BSTNode* deleteNode(BSTNode* node, string key) {
-        if (!node) return nullptr;
-        
-        if (key < node->key)
-            node->left = deleteNode(node->left, key);
-        else if (key > node->key)
-            node->right = deleteNode(node->right, key);
-        else {
-            if (!node->left) {
-                BSTNode* temp = node->right;
-                delete node;
-                return temp;
-            } else if (!node->right) {
-                BSTNode* temp = node->left;
-                delete node;
-                return temp;
-            } else {
-                BSTNode* succ = node->right;
-                while (succ->left) succ = succ->left;
-                node->key = succ->key;
-                node->value = succ->value;
-                node->right = deleteNode(node->right, succ->key);
-            }
-        }
-        return node;
-    }
+// ============== DISPLAY FUNCTIONS ==============
+
+void printPoolStats(string name, PoolStats stats) {
+    cout << left
+         << setw(14) << name
+         << setw(10) << stats.live
+         << setw(12) << stats.allocations
+         << setw(10) << stats.reused
+         << setw(10) << stats.releases
+         << setw(8) << stats.slabs
+         << setw(12) << stats.bytesReserved / 1024 << endl;
+}
 
-public:
-    BST() : root(nullptr) {}
-    
-    void insertItem(string key, Assignment* value) { insert(root, key, value); }
-    Assignment* searchByTitle(string key) { return search(root, key); }
-    void deleteItem(string key) { root = deleteNode(root, key); }
-};
-
-// ============== STACK CLASS (for Undo) ==============
-class AssignmentStack {
-private:
-    StackNode* top;
-    int size;
-
-public:
-    AssignmentStack() {
-        top = nullptr;
-        size = 0;
-    }
-
-    void push(Assignment* assignment) {
-        StackNode* newNode = new StackNode();
-        newNode->assignment = assignment;
-        newNode->next = top;
-        top = newNode;
-        size++;
-    }
-
-    Assignment* pop() {
-        if (isEmpty()) {
-            return nullptr;
+const size_t PAGE_SIZE = 20;
+
+// One buffer reused by every table view
+TableWriter table;
+
+void addAssignmentHeader(TableWriter& out) {
+    out.setColumns({12, 25, 15, 10});
+    out.cell("ID").cell("Title").cell("Due Date").cell("Max Score").endRow();
+    out.rule(62);
+}
+
+void addAssignmentRow(TableWriter& out, string_view id, string_view title, string_view dueDate, long long maxScore) {
+    out.cell(id).cell(title).cell(dueDate).cell(maxScore).endRow();
+}
+
+void flushTable() {
+    cout.write(table.str().data(), table.str().size());
+    cout.flush();
+    table.clear();
+}
+
+// Shows a listing a page at a time. renderPage(cursor) adds up to PAGE_SIZE
+// rows starting at the cursor and moves it to the next page. The start of
+// every page seen so far is kept, so next and previous render one page
+// instead of skipping from the top. Each page is a single write.
+template <typename Cursor, typename RenderPage>
+void browse(const string& title, void (*addHeader)(TableWriter&), size_t total,
+            Cursor first, RenderPage renderPage) {
+    size_t pages = total == 0 ? 1 : (total + PAGE_SIZE - 1) / PAGE_SIZE;
+    vector<Cursor> starts{first};
+    size_t page = 0;
+    while (true) {
+        Cursor cursor = starts[page];
+        table.text(title);
+        addHeader(table);
+        renderPage(cursor);
+        if (page + 1 == starts.size() && page + 1 < pages)
+            starts.push_back(cursor);
+
+        if (pages == 1) {
+            table.text("\n");
+            flushTable();
+            return;
         }
-        
-        StackNode* temp = top;
-        Assignment* assignment = top->assignment;
-        top = top->next;
-        delete temp;
-        size--;
-        return assignment;
+        table.text("\nPage " + to_string(page + 1) + " of " + to_string(pages) + "\n");
+        table.text(page + 1 < pages ? "n. next  " : "");
+        table.text(page > 0 ? "p. previous  " : "");
+        table.text("q. quit: ");
+        flushTable();
+
+        string command;
+        if (!(cin >> command)) return;
+        cin.ignore();
+        if (command == "n" && page + 1 < pages) page++;
+        else if (command == "p" && page > 0) page--;
+        else if (command != "n" && command != "p") return;
     }
+}
 
-    bool isEmpty() {
-        return top == nullptr;
+void displayAllAssignments() {
+    if (elearning->assignments.isEmpty()) {
+        cout << "\nNo assignments available.\n";
+        return;
     }
 
-    int getSize() {
-        return size;
-    }
+    browse("\n=== ALL ASSIGNMENTS (Linked List - Sorted by Due Date) ===\n", addAssignmentHeader,
+           elearning->assignments.visibleCount(), elearning->assignments.firstByDueDate(),
+           [](DueDateCursor& cursor) {
+        elearning->assignments.forEachByDueDateFrom(cursor, PAGE_SIZE,
+            [](string_view id, string_view title, string_view dueDate, int maxScore) {
+                addAssignmentRow(table, id, title, dueDate, maxScore);
+            });
+    });
+}
 
-    void displayStack() {
-        if (isEmpty()) {
-            cout << "\nNo assignments in history.\n";
-            return;
-        }
+// Calendar views; lecturers also get the overdue-and-ungraded list
+void displayDeadlines(bool lecturer) {
+    int today = elearning->today();
+    cout << "\nToday is " << formatDay(today) << endl;
+    cout << "1. Due in the next 7 days\n2. Due between dates\n";
+    if (lecturer) cout << "3. Overdue with ungraded submissions\n";
+    cout << "Choice: ";
+    int choice;
+    cin >> choice;
+    cin.ignore();
 
-        cout << "\n=== ASSIGNMENT CREATION HISTORY (Stack - LIFO) ===\n";
-        cout << left
-             << setw(12) << "ID"
-             << setw(25) << "Title"
-             << setw(15) << "Due Date" << endl;
-        cout << string(52, '-') << endl;
-
-        StackNode* temp = top;
-        while (temp != nullptr) {
-            cout << left
-                 << setw(12) << temp->assignment->assignmentID
-                 << setw(25) << temp->assignment->title
-                 << setw(15) << temp->assignment->dueDate << endl;
-            temp = temp->next;
+    bool found = false;
+    auto addRow = [&](string_view id, string_view title, string_view dueDate, int maxScore) {
+        if (!found) addAssignmentHeader(table);
+        addAssignmentRow(table, id, title, dueDate, maxScore);
+        found = true;
+    };
+
+    if (choice == 1) {
+        table.text("\n=== DUE IN THE NEXT 7 DAYS (Calendar Index) ===\n");
+        elearning->forEachDueWithin(7, addRow);
+    } else if (choice == 2) {
+        string from, to;
+        cout << "From (YYYY-MM-DD): ";
+        getline(cin, from);
+        cout << "To (YYYY-MM-DD): ";
+        getline(cin, to);
+        if (!isValidDate(from) || !isValidDate(to)) {
+            cout << "\nError: " << statusMessage(STATUS_INVALID) << endl;
+            return;
         }
-        cout << endl;
+        table.text("\n=== DUE FROM " + from + " TO " + to + " (Calendar Index) ===\n");
+        elearning->assignments.forEachDueBetween(dayNumber(from), dayNumber(to), addRow);
+    } else if (choice == 3 && lecturer) {
+        table.text("\n=== OVERDUE WITH UNGRADED SUBMISSIONS ===\n");
+        elearning->forEachOverdueUngraded([&](string_view id, string_view title, string_view dueDate, int pending) {
+            if (!found) {
+                table.setColumns({12, 25, 15, 10});
+                table.cell("ID").cell("Title").cell("Due Date").cell("Ungraded").endRow();
+                table.rule(62);
+            }
+            table.cell(id).cell(title).cell(dueDate).cell((long long)pending).endRow();
+            found = true;
+        });
+    } else {
+        cout << "Invalid choice.\n";
+        return;
     }
+    if (!found) table.text("No assignments found.\n");
+    table.text("\n");
+    flushTable();
+}
 
-    ~AssignmentStack() {
-        while (!isEmpty()) {
-            pop();
-        }
+void addChangeHeader(TableWriter& out) {
+    out.setColumns({8, 12, 25, 12, 8});
+    out.cell("Change").cell("ID").cell("Title").cell("Submission").cell("State").endRow();
+    out.rule(65);
+}
+
+// The submission a grade change touched, or how many a regrade did
+string changeSubmissions(const Change& change) {
+    if (change.type == CHANGE_GRADE || (change.type == CHANGE_REGRADE && change.regrades.size() == 1))
+        return formatSubmissionID(change.submissionID);
+    if (change.type == CHANGE_REGRADE) return to_string(change.regrades.size()) + " subs";
+    return "";
+}
+
+void displayChangeHistory() {
+    if (elearning->history.size() == 0) {
+        cout << "\nNo changes in history.\n";
+        return;
     }
-};
 
-// ============== ASSIGNMENT LINKED LIST ==============
-class AssignmentLinkedList {
-private:
-    Assignment* head;
-    int count;
-    BST bst; 
-    AssignmentStack stack; 
+    browse("\n=== CHANGE HISTORY (Newest First) ===\n", addChangeHeader,
+           elearning->history.size(), (size_t)0, [](size_t& first) {
+        elearning->history.forEachChangeFrom(first, PAGE_SIZE, [](const Change& change, bool undone) {
+            table.cell(changeName(change.type))
+                 .cell(change.assignmentID)
+                 .cell(change.title)
+                 .cell(changeSubmissions(change))
+                 .cell(undone ? "Undone" : "")
+                 .endRow();
+        });
+        first += PAGE_SIZE;
+    });
+}
 
-    string generateID() {
-        count++;
-        return "ASSG" + to_string(1000 + count);
+void displayDetails(Assignment* assg) {
+    if (assg == nullptr) {
+        cout << "Assignment not found.\n";
+        return;
     }
 
-public:
-    AssignmentLinkedList() {
-        head = nullptr;
-        count = 0;
+    cout << "\n=== ASSIGNMENT DETAILS ===\n";
+    cout << "ID: " << assg->assignmentID << endl;
+    cout << "Title: " << assg->title << endl;
+    cout << "Description: " << assg->description << endl;
+    cout << "Due Date: " << assg->dueDate << endl;
+    cout << "Max Score: " << assg->maxScore << endl;
+}
+
+// Shows one match in detail, several as a table
+void displayMatches(vector<Assignment*> matches) {
+    if (matches.empty()) {
+        cout << "Assignment not found.\n";
+        return;
+    }
+    if (matches.size() == 1) {
+        displayDetails(matches[0]);
+        return;
     }
 
-    // Insert assignment
-    void insertAssignment() {
-        Assignment* newAssg = new Assignment();
-        
-        cout << "\n=== CREATE NEW ASSIGNMENT ===\n";
-        newAssg->assignmentID = generateID();
-        cout << "Assignment ID: " << newAssg->assignmentID << endl;
-        
-        cin.ignore();
-        cout << "Title: ";
-        getline(cin, newAssg->title);
-        
-        cout << "Description: ";
-        getline(cin, newAssg->description);
-        
-        cout << "Due Date (YYYY-MM-DD): ";
-        getline(cin, newAssg->dueDate);
-        
-        cout << "Max Score: ";
-        cin >> newAssg->maxScore;
-        
-        newAssg->next = nullptr;
+    table.text("\n=== MATCHING ASSIGNMENTS (" + to_string(matches.size()) + ") ===\n");
+    addAssignmentHeader(table);
+    for (Assignment* temp : matches)
+        addAssignmentRow(table, temp->assignmentID, temp->title, temp->dueDate, temp->maxScore);
+    table.text("\n");
+    flushTable();
+}
 
-       
-        bst.insertItem(newAssg->title, newAssg);
+// Keywords plus all/any, for the ranked text searches
+bool readKeywords(string& query) {
+    cout << "Keywords: ";
+    getline(cin, query);
+    cout << "Match 1. all words  2. any word: ";
+    int mode;
+    cin >> mode;
+    cin.ignore();
+    return mode != 2;
+}
 
-        stack.push(newAssg);
+void displayFeedbackMatches(vector<Submission*> matches) {
+    if (matches.empty()) {
+        cout << "No feedback matches.\n";
+        return;
+    }
 
-        if (head == nullptr || newAssg->dueDate < head->dueDate) {
-            newAssg->next = head;
-            head = newAssg;
-        } 
-        else {
-            Assignment* current = head;
-            while (current->next != nullptr && current->next->dueDate < newAssg->dueDate) {
-                current = current->next;
-            }
-            newAssg->next = current->next;
-            current->next = newAssg;
-        }
-        
-        cout << "\n Assignment created successfully!\n";
-        cout << "  (Use 'Undo Last Creation' to remove this assignment)\n";
+    table.text("\n=== MATCHING FEEDBACK (Best First) ===\n");
+    table.setColumns({12, 20, 25, 8, 20});
+    table.cell("Sub ID").cell("Student").cell("Assignment").cell("Score").cell("Feedback").endRow();
+    table.rule(85);
+    for (Submission* sub : matches) {
+        table.cell(formatSubmissionID(sub->submissionID))
+             .cell(symbolText(sub->studentName))
+             .cell(symbolText(sub->assignmentTitle))
+             .cell((long long)sub->score)
+             .cell(sub->feedback)
+             .endRow();
     }
+    table.text("\n");
+    flushTable();
+}
 
-    // Stack operation
-    void undoLastCreation() {
-        if (stack.isEmpty()) {
-            cout << "\nNo assignments to undo.\n";
-            return;
-        }
+void addPendingHeader(TableWriter& out) {
+    out.setColumns({12, 20, 25, 18});
+    out.cell("Sub ID").cell("Student").cell("Assignment").cell("Submitted").endRow();
+    out.rule(75);
+}
 
-        Assignment* lastAssg = stack.pop();
-        
-        Assignment* temp = head;
-        Assignment* prev = nullptr;
+void displayPending() {
+    if (elearning->submissions.isEmpty()) {
+        cout << "\nNo pending submissions.\n";
+        return;
+    }
 
-        while (temp != nullptr && temp != lastAssg) {
-            prev = temp;
-            temp = temp->next;
-        }
+    browse("\n=== PENDING SUBMISSIONS (Queue - FIFO Order) ===\n", addPendingHeader,
+           elearning->submissions.pendingCount(), elearning->submissions.firstPending(),
+           [](QueueCursor& cursor) {
+        elearning->submissions.forEachPendingFrom(cursor, PAGE_SIZE, [](const Submission& sub) {
+            table.cell(formatSubmissionID(sub.submissionID))
+                 .cell(symbolText(sub.studentName))
+                 .cell(symbolText(sub.assignmentTitle))
+                 .cell(sub.submittedDate)
+                 .endRow();
+        });
+    });
+}
 
-        if (temp == nullptr) {
-            cout << "Error: Assignment not found in list.\n";
-            return;
-        }
+void addStudentSubmissionHeader(TableWriter& out) {
+    out.setColumns({25, 18, 12, 8, 20});
+    out.cell("Assignment").cell("Submitted").cell("Status").cell("Score").cell("Feedback").endRow();
+    out.rule(83);
+}
+
+void displayByStudent(string studentID) {
+    size_t total = elearning->submissions.studentSubmissionCount(studentID);
+    if (total == 0) {
+        table.text("\n=== MY SUBMISSIONS ===\n");
+        addStudentSubmissionHeader(table);
+        table.text("No submissions found.\n\n");
+        flushTable();
+        return;
+    }
 
-        if (prev == nullptr)
-            head = temp->next;
-        else
-            prev->next = temp->next;
+    GradeTotals transcript = elearning->transcript(studentID);
+    cout << "\nGraded " << transcript.graded << " of " << transcript.submitted
+         << ", total score " << transcript.scoreTotal << ", average "
+         << fixed << setprecision(2) << transcript.average() << endl;
+    browse("\n=== MY SUBMISSIONS ===\n", addStudentSubmissionHeader, total, (size_t)0,
+           [&](size_t& first) {
+        elearning->submissions.forEachByStudentFrom(studentID, first, PAGE_SIZE, [](const Submission& sub) {
+            table.cell(symbolText(sub.assignmentTitle))
+                 .cell(sub.submittedDate)
+                 .cell(statusName(sub.status))
+                 .cell((long long)sub.score)
+                 .cell(sub.feedback)
+                 .endRow();
+        });
+        first += PAGE_SIZE;
+    });
+}
 
-        bst.deleteItem(lastAssg->title);
+void addRankingHeader(TableWriter& out) {
+    out.setColumns({6, 12, 20, 12, 12, 10});
+    out.cell("Rank").cell("Student ID").cell("Name").cell("Total Score").cell("Assignments").cell("Average").endRow();
+    out.rule(72);
+}
 
-        cout << "\n✓ Undo successful! Assignment '" << lastAssg->title << "' removed.\n";
-        
-        delete lastAssg;  
+void displayStudentRankings() {
+    if (elearning->submissions.isEmpty()) {
+        cout << "\nNo submissions to rank.\n";
+        return;
     }
 
-    void displayCreationHistory() {
-        stack.displayStack();
+    int total = elearning->submissions.rankingSize();
+    if (total == 0) {
+        cout << "\nNo graded submissions yet.\n";
+        return;
     }
 
-    void displayAll() {
-        if (head == nullptr) {
-            cout << "\nNo assignments available.\n";
-            return;
+    // Each page is one O(log n + page) range query on the ranking tree
+    browse("\n=== STUDENT RANKINGS (Sorted by Total Score) ===\n", addRankingHeader,
+           (size_t)total, 0, [&](int& first) {
+        int last = min(total, first + (int)PAGE_SIZE);
+        vector<Student> students = elearning->submissions.rankingRange(first, last);
+        table.setColumns({6, 12, 20, 12, 12, 0});
+        for (size_t i = 0; i < students.size(); i++) {
+            double average = (float)students[i].totalScore / students[i].submissionCount;
+            table.cell((long long)(first + i + 1))
+                 .cell(students[i].studentID)
+                 .cell(students[i].name)
+                 .cell((long long)students[i].totalScore)
+                 .cell((long long)students[i].submissionCount)
+                 .cell(average, 2)
+                 .endRow();
         }
+        first = last;
+    });
+}
 
-        cout << "\n=== ALL ASSIGNMENTS (Linked List - Sorted by Due Date) ===\n";
-        cout << left
-             << setw(12) << "ID"
-             << setw(25) << "Title"
-             << setw(15) << "Due Date"
-             << setw(10) << "Max Score" << endl;
-        cout << string(62, '-') << endl;
-
-        Assignment* temp = head;
-        while (temp != nullptr) {
-            cout << left
-                 << setw(12) << temp->assignmentID
-                 << setw(25) << temp->title
-                 << setw(15) << temp->dueDate
-                 << setw(10) << temp->maxScore << endl;
-            temp = temp->next;
-        }
-        cout << endl;
+void displayStudentRank(string studentID) {
+    int rank = elearning->submissions.rankOf(studentID);
+    if (rank == 0) {
+        cout << "You have no graded submissions yet.\n";
+        return;
+    }
+    cout << "Your rank: " << rank << " of " << elearning->submissions.rankingSize() << endl;
+}
+
+void displayAssignmentStatistics() {
+    vector<AssignmentAggregate> stats = elearning->assignmentSummaries();
+    if (stats.empty()) {
+        cout << "\nNo submissions yet.\n";
+        return;
     }
 
-    // Search using BST 
-    Assignment* searchByTitle(string title) {
-        return bst.searchByTitle(title);
+    table.text("\n=== ASSIGNMENT STATISTICS ===\n");
+    table.setColumns({10, 25, 13, 8, 8, 6, 6});
+    table.cell("ID").cell("Title").cell("Submissions").cell("Graded").cell("Mean").cell("Min").cell("Max").endRow();
+    table.rule(76);
+
+    string title;
+    for (const AssignmentAggregate& entry : stats) {
+        string id = symbolText(entry.assignmentID);
+        if (!elearning->assignments.findTitle(id, title)) title = "(removed)";
+        table.cell(id)
+             .cell(title)
+             .cell((long long)entry.submissions)
+             .cell((long long)entry.graded)
+             .cell(entry.mean, 2)
+             .cell((long long)entry.minScore)
+             .cell((long long)entry.maxScore)
+             .endRow();
     }
+    GradeTotals totals = elearning->gradeTotals();
+    table.text("Graded " + to_string(totals.graded) + " of " + to_string(totals.submitted) +
+               " submissions, class average ");
+    table.setColumns({0});
+    table.cell(totals.average(), 2).endRow();
+    table.text("\n");
+    flushTable();
+}
 
-    // Search by ID
-    Assignment* searchByID(string id) {
-        Assignment* temp = head;
-        while (temp != nullptr) {
-            if (temp->assignmentID == id) {
-                return temp;
-            }
-            temp = temp->next;
-        }
-        return nullptr;
+// Every course side by side, then the leaderboard over all of them; the
+// courses are summarized in parallel
+void displayCourseReport() {
+    vector<CourseSummary> summaries = router.courseSummaries();
+    table.text("\n=== ALL COURSES ===\n");
+    table.setColumns({14, 13, 13, 8, 9, 0});
+    table.cell("Course").cell("Assignments").cell("Submissions").cell("Graded").cell("Pending").cell("Mean").endRow();
+    table.rule(66);
+    for (const CourseSummary& summary : summaries) {
+        table.cell(summary.courseID)
+             .cell((long long)summary.assignments)
+             .cell(summary.submissions)
+             .cell(summary.graded)
+             .cell(summary.pending)
+             .cell(summary.mean, 2)
+             .endRow();
+        if (!summary.stored)
+            table.text("  (" + summary.courseID + " could not be loaded from disk; changes are not saved)\n");
     }
 
-    void displayDetails(Assignment* assg) {
-        if (assg == nullptr) {
-            cout << "Assignment not found.\n";
-            return;
+    vector<StudentAggregate> ranked = router.rankStudents();
+    if (!ranked.empty()) {
+        table.text("\n=== TOP STUDENTS (All Courses) ===\n");
+        table.setColumns({6, 12, 13, 8, 0});
+        table.cell("Rank").cell("Student ID").cell("Total Score").cell("Graded").cell("Average").endRow();
+        table.rule(50);
+        for (size_t i = 0; i < ranked.size() && i < 10; i++) {
+            table.cell((long long)(i + 1))
+                 .cell(symbolText(ranked[i].studentID))
+                 .cell(ranked[i].totalScore)
+                 .cell((long long)ranked[i].graded)
+                 .cell(ranked[i].average, 2)
+                 .endRow();
         }
+    }
+    table.text("\n");
+    flushTable();
+}
+
+void displayMemoryStats() {
+    cout << "\n=== MEMORY STATISTICS (Object Pools) ===\n";
+    cout << left
+         << setw(14) << "Pool"
+         << setw(10) << "Live"
+         << setw(12) << "Allocs"
+         << setw(10) << "Reused"
+         << setw(10) << "Frees"
+         << setw(8) << "Slabs"
+         << setw(12) << "KB Reserved" << endl;
+    cout << string(76, '-') << endl;
+    for (auto& entry : elearning->memoryStats())
+        printPoolStats(entry.first, entry.second);
+
+    SimilarityStats similarity = elearning->similarityStats();
+    cout << "\nSimilarity index: " << similarity.indexed << " files fingerprinted, "
+         << similarity.queued << " queued, " << similarity.unreadable << " unreadable, "
+         << similarity.tooShort << " too short\n";
+    BlobStats files = elearning->blobs.stats();
+    cout << "File store: " << files.stored << " files stored, " << files.deduplicated
+         << " already stored (deduplicated), " << files.bytesReceived << " bytes received, "
+         << files.bytesWritten << " bytes written"
+         << (elearning->blobs.isCompressing() ? " (compressed)" : "") << "\n";
+    cout << endl;
+}
 
-        cout << "\n=== ASSIGNMENT DETAILS ===\n";
-        cout << "ID: " << assg->assignmentID << endl;
-        cout << "Title: " << assg->title << endl;
-        cout << "Description: " << assg->description << endl;
-        cout << "Due Date: " << assg->dueDate << endl;
-        cout << "Max Score: " << assg->maxScore << endl;
+// Latency percentiles of the instrumented operations, then a Prometheus dump
+void displayPerformanceStats() {
+    table.text("\n=== PERFORMANCE STATISTICS (Latency in Microseconds) ===\n");
+    table.setColumns({20, 10, 10, 10, 10, 10, 10});
+    table.cell("Operation").cell("Count").cell("Mean").cell("p50").cell("p99").cell("p99.9").cell("Max").endRow();
+    table.rule(80);
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        LatencyHistogram histogram = metrics().histogram((Metric)m);
+        if (histogram.count == 0) continue;
+        table.cell(metricName((Metric)m))
+             .cell((long long)histogram.count)
+             .cell(histogram.meanNs() / 1000, 1)
+             .cell(histogram.percentileNs(0.50) / 1000.0, 1)
+             .cell(histogram.percentileNs(0.99) / 1000.0, 1)
+             .cell(histogram.percentileNs(0.999) / 1000.0, 1)
+             .cell(histogram.maxNs() / 1000.0, 1)
+             .endRow();
     }
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        table.text(string(counterName((MetricCounter)c)) + ": " +
+                   to_string(metrics().counter((MetricCounter)c)) + "\n");
+    }
+    table.text(router.writeMetrics() ? "Metrics written to elearning.prom\n\n"
+                                     : "Warning: could not write elearning.prom\n\n");
+    flushTable();
+}
 
-    ~AssignmentLinkedList() {
-        Assignment* current = head;
-        while (current != nullptr) {
-            Assignment* temp = current;
-            current = current->next;
-            delete temp;
-        }
+void printImportReport(const ImportReport& report) {
+    double rate = report.seconds > 0 ? report.rows / report.seconds : 0;
+    cout << left
+         << setw(30) << report.file
+         << setw(10) << report.rows
+         << setw(10) << report.imported
+         << setw(10) << report.rejected
+         << setw(10) << fixed << setprecision(3) << report.seconds
+         << setprecision(0) << rate << endl;
+}
+
+// After every menu action: the log is synced there rather than left to the
+// group commit, which only looks at the clock when the next record arrives
+void saveChanges() {
+    if (!router.sync())
+        cout << "Warning: could not write the change log.\n";
+    if (!router.checkpointIfNeeded())
+        cout << "Warning: could not write snapshot.\n";
+}
+
+// ============== MENU FUNCTIONS ==============
+
+void switchCourse() {
+    cout << "\n=== SWITCH COURSE ===\nCourses:";
+    for (const string& courseID : router.courseIDs())
+        cout << " " << courseID;
+    cout << "\nEnter Course ID: ";
+    string courseID;
+    cin >> courseID;
+
+    ELearningSystem* shard = nullptr;
+    Status status = router.course(courseID, &shard);
+    if (status == STATUS_NOT_FOUND) {
+        char answer;
+        cout << "Course " << courseID << " does not exist. Create it? (y/n): ";
+        cin >> answer;
+        if (answer != 'y' && answer != 'Y') return;
+        status = router.course(courseID, &shard, true);
+    }
+    if (status != STATUS_OK) {
+        cout << "Invalid course ID: use up to " << MAX_COURSE_ID << " letters, digits, '-' or '_'.\n";
+        return;
     }
-};
 
-// ============== SUBMISSION QUEUE ==============
-class SubmissionQueue {
-private:
-    Submission* front;
-    Submission* rear;
-    int count;
+    CourseRouter::normalizeCourseID(courseID);
+    elearning = shard;
+    elearning->enableSimilarity();
+    currentCourse = courseID;
+    cout << "Now working in course " << currentCourse << ".\n";
+    if (!elearning->storage.isEnabled())
+        cout << "Warning: this course's saved data could not be loaded; changes will not be saved.\n";
+}
+
+void createAssignment() {
+    AssignmentSpec spec;
+
+    cout << "\n=== CREATE NEW ASSIGNMENT ===\n";
+    cin.ignore();
+    cout << "Title: ";
+    getline(cin, spec.title);
 
-    string generateID() {
-        count++;
-        return "SUB" + to_string(10000 + count);
+    cout << "Description: ";
+    getline(cin, spec.description);
+
+    cout << "Due Date (YYYY-MM-DD): ";
+    getline(cin, spec.dueDate);
+
+    cout << "Max Score: ";
+    cin >> spec.maxScore;
+    if (!cin) {
+        cin.clear();
+        spec.maxScore = 0;
     }
 
-    string getCurrentDate() {
-        return "2025-01-11";
+    Assignment* created = nullptr;
+    Status status = elearning->createAssignment(spec, &created);
+    if (status != STATUS_OK) {
+        cout << "\nAssignment not created: " << statusMessage(status)
+             << " (title required, date as YYYY-MM-DD, max score above 0).\n";
+        return;
     }
 
-public:
-    SubmissionQueue() {
-        front = nullptr;
-        rear = nullptr;
-        count = 0;
+    cout << "\n Assignment created successfully!\n";
+    cout << "Assignment ID: " << created->assignmentID << endl;
+    cout << "  (Use 'Undo Last Change' to remove this assignment)\n";
+}
+
+void editAssignment() {
+    string id;
+    AssignmentSpec spec;
+
+    cout << "\n=== EDIT ASSIGNMENT ===\n";
+    cout << "Assignment ID: ";
+    cin >> id;
+    Assignment* assg = elearning->assignments.searchByID(id);
+    if (assg == nullptr) {
+        cout << "Assignment not found.\n";
+        return;
     }
+    displayDetails(assg);
 
-    // Enqueue
-    void enqueue(Student student, Assignment* assignment) {
-        if (assignment == nullptr) {
-            cout << "Invalid assignment.\n";
-            return;
-        }
+    // Empty input keeps the current value
+    string maxScore;
+    cin.ignore();
+    cout << "\nNew Title [" << assg->title << "]: ";
+    getline(cin, spec.title);
+    cout << "New Description: ";
+    getline(cin, spec.description);
+    cout << "New Due Date [" << assg->dueDate << "]: ";
+    getline(cin, spec.dueDate);
+    cout << "New Max Score [" << assg->maxScore << "]: ";
+    getline(cin, maxScore);
+
+    if (spec.title.empty()) spec.title = assg->title;
+    if (spec.description.empty()) spec.description = assg->description;
+    if (spec.dueDate.empty()) spec.dueDate = assg->dueDate;
+    spec.maxScore = maxScore.empty() ? assg->maxScore : atoi(maxScore.c_str());
+
+    Status status = elearning->editAssignment(id, spec);
+    if (status != STATUS_OK) {
+        cout << "\nAssignment not changed: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Assignment updated.\n";
+}
 
-        Submission* newSub = new Submission();
-        
-        newSub->submissionID = generateID();
-        newSub->studentID = student.studentID;
-        newSub->studentName = student.name;
-        newSub->assignmentID = assignment->assignmentID;
-        newSub->assignmentTitle = assignment->title;
-        newSub->submittedDate = getCurrentDate();
-        
-        cout << "Enter file path/description: ";
-        cin.ignore();
-        getline(cin, newSub->filePath);
-        
-        newSub->status = "Pending";
-        newSub->score = 0;
-        newSub->feedback = "Not graded yet";
-        newSub->next = nullptr;
-
-        // Queue operation (FIFO)
-        if (rear == nullptr) {
-            front = rear = newSub;
-        } else {
-            rear->next = newSub;
-            rear = newSub;
-        }
+void deleteAssignment() {
+    string id;
+    cout << "\n=== DELETE ASSIGNMENT ===\n";
+    cout << "Assignment ID: ";
+    cin >> id;
+
+    Status status = elearning->deleteAssignment(id);
+    if (status != STATUS_OK) {
+        cout << "Assignment not deleted: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Assignment " << id << " deleted. (Use 'Undo Last Change' to restore it)\n";
+}
+
+void describeChange(const char* action, const Change& change) {
+    cout << "\n✓ " << action << ": " << changeName(change.type) << " ";
+    if (change.type == CHANGE_GRADE || change.type == CHANGE_REGRADE)
+        cout << changeSubmissions(change) << " (" << change.title << ")\n";
+    else
+        cout << "'" << change.title << "' (" << change.assignmentID << ")\n";
+}
 
-        cout << "\n✓ Assignment submitted successfully!\n";
-        cout << "Submission ID: " << newSub->submissionID << endl;
+void undoLastChange() {
+    Change undone;
+    if (elearning->undo(&undone) != STATUS_OK) {
+        cout << "\nNothing to undo.\n";
+        return;
     }
+    describeChange("Undone", undone);
+}
 
-    bool isDuplicate(string studentID, string assignmentID) {
-        Submission* temp = front;
-        while (temp != nullptr) {
-            if (temp->studentID == studentID && temp->assignmentID == assignmentID) {
-                return true;
-            }
-            temp = temp->next;
-        }
-        return false;
+void redoLastChange() {
+    Change redone;
+    if (elearning->redo(&redone) != STATUS_OK) {
+        cout << "\nNothing to redo.\n";
+        return;
     }
+    describeChange("Redone", redone);
+}
 
-    void displayPending() {
-        if (front == nullptr) {
-            cout << "\nNo pending submissions.\n";
-            return;
-        }
+void submitAssignment() {
+    string id, filePath;
 
-        cout << "\n=== PENDING SUBMISSIONS (Queue - FIFO Order) ===\n";
-        cout << left
-             << setw(12) << "Sub ID"
-             << setw(20) << "Student"
-             << setw(25) << "Assignment"
-             << setw(15) << "Date" << endl;
-        cout << string(72, '-') << endl;
-
-        Submission* temp = front;
-        while (temp != nullptr) {
-            if (temp->status == "Pending") {
-                cout << left
-                     << setw(12) << temp->submissionID
-                     << setw(20) << temp->studentName
-                     << setw(25) << temp->assignmentTitle
-                     << setw(15) << temp->submittedDate << endl;
-            }
-            temp = temp->next;
-        }
-        cout << endl;
+    displayAllAssignments();
+    cout << "Enter Assignment ID to submit: ";
+    cin >> id;
+
+    Assignment* assg = elearning->assignments.searchByID(id);
+    if (assg == nullptr) {
+        cout << "Assignment not found.\n";
+        return;
+    }
+    if (elearning->submissions.isDuplicate(currentStudent.studentID, id)) {
+        cout << "You already submitted this assignment.\n";
+        return;
     }
 
-    void displayByStudent(string studentID) {
-        Submission* temp = front;
-        bool found = false;
-
-        cout << "\n=== MY SUBMISSIONS ===\n";
-        cout << left
-             << setw(25) << "Assignment"
-             << setw(15) << "Date"
-             << setw(12) << "Status"
-             << setw(8) << "Score"
-             << setw(20) << "Feedback" << endl;
-        cout << string(80, '-') << endl;
-
-        while (temp != nullptr) {
-            if (temp->studentID == studentID) {
-                cout << left
-                     << setw(25) << temp->assignmentTitle
-                     << setw(15) << temp->submittedDate
-                     << setw(12) << temp->status
-                     << setw(8) << temp->score
-                     << setw(20) << temp->feedback << endl;
-                found = true;
-            }
-            temp = temp->next;
-        }
+    cout << "Enter file path: ";
+    cin.ignore();
+    getline(cin, filePath);
 
-        if (!found) {
-            cout << "No submissions found.\n";
+    Submission* created = nullptr;
+    Status status = elearning->submit(currentStudent, id, filePath, &created);
+    if (status != STATUS_OK) {
+        cout << "Submission failed: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Assignment submitted successfully!\n";
+    cout << "Submission ID: " << formatSubmissionID(created->submissionID) << endl;
+}
+
+// Shows the submission and reads the lecturer's score and feedback
+void readGrade(Submission* sub, int& score, string& feedback) {
+    cout << "\n=== GRADING SUBMISSION ===\n";
+    cout << "Student: " << symbolText(sub->studentName) << " (" << symbolText(sub->studentID) << ")\n";
+    cout << "Assignment: " << symbolText(sub->assignmentTitle) << endl;
+    if (!isBlobDigest(sub->file)) {
+        cout << "File: " << sub->file << " (from before files were stored)\n";
+    } else {
+        long long size = elearning->blobs.sizeOf(sub->file);
+        cout << "File: " << sub->file.substr(0, 12) << "... ";
+        if (size < 0) cout << "(missing from the file store)\n";
+        else cout << "(" << size << " bytes; Save a Submitted File writes a copy)\n";
+    }
+
+    // Files are fingerprinted in the background, so recent ones may not
+    // have hints yet
+    vector<SimilarMatch> similar = elearning->similarSubmissions(formatSubmissionID(sub->submissionID));
+    if (!similar.empty()) {
+        cout << "Similar submissions:";
+        for (const SimilarMatch& match : similar) {
+            string id = formatSubmissionID(match.submissionID);
+            Submission* other = elearning->submissions.searchByID(id);
+            cout << " " << id << " (" << (other ? symbolText(other->studentName) : "?") << ", "
+                 << (int)lround(match.similarity * 100) << "%)";
         }
         cout << endl;
     }
 
-    void gradeSubmission(string submissionID) {
-        Submission* temp = front;
-        
-        while (temp != nullptr) {
-            if (temp->submissionID == submissionID) {
-                if (temp->status == "Graded") {
-                    cout << "This submission is already graded.\n";
-                    return;
-                }
+    cout << "\nEnter Score: ";
+    cin >> score;
+    if (!cin) {
+        cin.clear();
+        score = -1;
+    }
+    cin.ignore();
 
-                cout << "\n=== GRADING SUBMISSION ===\n";
-                cout << "Student: " << temp->studentName << " (" << temp->studentID << ")\n";
-                cout << "Assignment: " << temp->assignmentTitle << endl;
-                cout << "File: " << temp->filePath << endl;
-                
-                cout << "\nEnter Score: ";
-                cin >> temp->score;
-                cin.ignore();
-                
-                cout << "Enter Feedback: ";
-                getline(cin, temp->feedback);
-                
-                temp->status = "Graded";
-                
-                cout << "\n✓ Submission graded successfully!\n";
-                return;
-            }
-            temp = temp->next;
-        }
-        
+    cout << "Enter Feedback: ";
+    getline(cin, feedback);
+}
+
+void gradeSubmission() {
+    string id, feedback;
+    int score;
+
+    displayPending();
+    cout << "Enter Submission ID to grade: ";
+    cin >> id;
+
+    Submission* sub = elearning->submissions.searchByID(id);
+    if (sub == nullptr) {
         cout << "Submission not found.\n";
+        return;
+    }
+    bool regrade = sub->status == SUBMISSION_GRADED;
+    if (regrade) {
+        char answer;
+        cout << "Already graded: " << sub->score << " (" << sub->feedback << ")\n";
+        cout << "Regrade it? (y/n): ";
+        cin >> answer;
+        if (answer != 'y' && answer != 'Y') return;
     }
 
-    //Sorting algorithm
-    void displayStudentRankings() {
-        if (front == nullptr) {
-            cout << "\nNo submissions to rank.\n";
-            return;
-        }
+    readGrade(sub, score, feedback);
 
-        Student students[100];  
-        int studentCount = 0;
-
-        Submission* temp = front;
-        while (temp != nullptr) {
-            if (temp->status == "Graded") {
-                int index = -1;
-                for (int i = 0; i < studentCount; i++) {
-                    if (students[i].studentID == temp->studentID) {
-                        index = i;
-                        break;
-                    }
-                }
+    Status status = regrade ? elearning->regrade(id, score, feedback) : elearning->grade(id, score, feedback);
+    if (status != STATUS_OK) {
+        cout << "Submission not graded: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Submission " << (regrade ? "regraded" : "graded") << " successfully!\n";
+    sub = elearning->submissions.searchByID(id);
+    if (sub != nullptr && sub->score != score)
+        cout << "Recorded score after late penalty: " << sub->score << endl;
+}
 
-                if (index == -1) {
-                    students[studentCount].studentID = temp->studentID;
-                    students[studentCount].name = temp->studentName;
-                    students[studentCount].totalScore = temp->score;
-                    students[studentCount].submissionCount = 1;
-                    studentCount++;
-                } else {
-                    students[index].totalScore += temp->score;
-                    students[index].submissionCount++;
-                }
-            }
-            temp = temp->next;
-        }
+// Rubric fix: adds (or takes off) points on every graded submission of
+// an assignment, capped to 0..max score, as one undoable change
+void regradeAssignment() {
+    string id;
+    int points;
+
+    displayAllAssignments();
+    cout << "Enter Assignment ID to regrade: ";
+    cin >> id;
+    Assignment* assg = elearning->assignments.searchByID(id);
+    if (assg == nullptr) {
+        cout << "Assignment not found.\n";
+        return;
+    }
+    int maxScore = assg->maxScore;
+
+    cout << "Points to add to every graded submission (negative to deduct): ";
+    cin >> points;
+    if (!cin) {
+        cin.clear();
+        cout << "Invalid number.\n";
+        return;
+    }
 
-        if (studentCount == 0) {
-            cout << "\nNo graded submissions yet.\n";
-            return;
-        }
+    size_t regraded = 0;
+    Status status = elearning->regradeAssignment(id, [&](const Submission& sub) {
+        return min(max(sub.score + points, 0), max(maxScore, sub.score));
+    }, &regraded);
+    if (status == STATUS_EMPTY) {
+        cout << "\nNo graded submission changes.\n";
+        return;
+    }
+    if (status != STATUS_OK) {
+        cout << "Not regraded: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Regraded " << regraded << " submissions (undo reverts all of them).\n";
+}
 
-        // Bubble Sort 
-        for (int i = 0; i < studentCount - 1; i++) {
-            for (int j = 0; j < studentCount - i - 1; j++) {
-                if (students[j].totalScore < students[j + 1].totalScore) {
-                    Student tempStudent = students[j];
-                    students[j] = students[j + 1];
-                    students[j + 1] = tempStudent;
-                }
-            }
-        }
+// Writes a copy of a submitted file, e.g. to open it while grading
+void saveSubmittedFile() {
+    string id, destination;
 
-        cout << "\n=== STUDENT RANKINGS (Sorted by Total Score) ===\n";
-        cout << left
-             << setw(6) << "Rank"
-             << setw(12) << "Student ID"
-             << setw(20) << "Name"
-             << setw(12) << "Total Score"
-             << setw(12) << "Assignments"
-             << setw(10) << "Average" << endl;
-        cout << string(72, '-') << endl;
-
-        for (int i = 0; i < studentCount; i++) {
-            float average = (float)students[i].totalScore / students[i].submissionCount;
-            cout << left
-                 << setw(6) << (i + 1)
-                 << setw(12) << students[i].studentID
-                 << setw(20) << students[i].name
-                 << setw(12) << students[i].totalScore
-                 << setw(12) << students[i].submissionCount
-                 << fixed << setprecision(2) << average << endl;
-        }
-        cout << endl;
+    cout << "Enter Submission ID: ";
+    cin >> id;
+    cout << "Save to (file path): ";
+    cin.ignore();
+    getline(cin, destination);
+
+    Status status = elearning->copySubmittedFile(id, destination);
+    if (status != STATUS_OK) {
+        cout << "Not saved: " << statusMessage(status) << endl;
+        return;
     }
+    cout << "\n✓ Saved the file of " << id << " to " << destination << endl;
+}
+
+void configureLatePolicy() {
+    LatePolicy policy = elearning->getLatePolicy();
+    const char* modes[] = {"none", "per day", "flat"};
+    cout << "\n=== LATE PENALTY POLICY ===\n";
+    cout << "Current: " << modes[policy.mode];
+    if (policy.mode != LATE_NONE)
+        cout << ", " << policy.percent << "%" << (policy.mode == LATE_PER_DAY ? " per day" : "")
+             << " after " << policy.graceDays << " grace days"
+             << (policy.mode == LATE_PER_DAY ? ", at most " + to_string(policy.maxPercent) + "%" : "");
+    cout << "\n\n0. No penalty\n1. Percent per day late\n2. Flat percent once late\nChoice: ";
 
-    ~SubmissionQueue() {
-        Submission* current = front;
-        while (current != nullptr) {
-            Submission* temp = current;
-            current = current->next;
-            delete temp;
+    int choice;
+    cin >> choice;
+    if (!cin || choice < 0 || choice > 2) {
+        cin.clear();
+        cout << "Invalid choice.\n";
+        return;
+    }
+    policy.mode = (LatePenaltyMode)choice;
+    if (policy.mode != LATE_NONE) {
+        cout << "Percent: ";
+        cin >> policy.percent;
+        cout << "Grace days: ";
+        cin >> policy.graceDays;
+        if (policy.mode == LATE_PER_DAY) {
+            cout << "Maximum percent: ";
+            cin >> policy.maxPercent;
+        }
+        if (!cin || policy.percent < 0 || policy.graceDays < 0 || policy.maxPercent < 0) {
+            cin.clear();
+            cout << "Invalid value; policy unchanged.\n";
+            return;
         }
     }
-};
+    elearning->setLatePolicy(policy);
+    cout << "\n✓ Late penalty policy updated (applies to grades entered from now on).\n";
+}
 
-// ============== GLOBAL OBJECTS ==============
-AssignmentLinkedList assignmentList;
-SubmissionQueue submissionQueue;
-Student currentStudent;
+// Lets the scheduler pick the submission instead of typing its ID
+void gradeNextSubmission() {
+    const string grader = "lecturer";
+    int choice;
 
-// ============== MENU FUNCTIONS ==============
+    cout << "\n=== GRADE NEXT SUBMISSION ===\n";
+    cout << "1. Oldest first\n";
+    cout << "2. Nearest due date first\n";
+    cout << "3. Same assignment as last time\n";
+    cout << "Order: ";
+    cin >> choice;
+    if (!cin || choice < 1 || choice > 3) {
+        cin.clear();
+        cout << "Invalid choice.\n";
+        return;
+    }
+    GradingPolicy policy = choice == 2 ? GRADE_NEAREST_DUE
+                         : choice == 3 ? GRADE_BY_ASSIGNMENT : GRADE_OLDEST_FIRST;
+
+    string id, feedback;
+    int score;
+    if (elearning->claimNextSubmission(grader, policy, &id) != STATUS_OK) {
+        cout << "\nNo pending submissions.\n";
+        return;
+    }
+    cout << "\nNext: " << id << endl;
+    readGrade(elearning->submissions.searchByID(id), score, feedback);
+
+    Status status = elearning->completeGrading(grader, id, score, feedback);
+    if (status != STATUS_OK) {
+        elearning->releaseSubmission(grader, id);
+        cout << "Submission not graded: " << statusMessage(status) << endl;
+        return;
+    }
+    cout << "\n✓ Submission graded successfully!\n";
+    for (const GraderStats& stats : elearning->graderStats()) {
+        if (stats.grader == grader)
+            cout << "Graded " << stats.completed << " this session ("
+                 << fixed << setprecision(1) << stats.perHour() << " per hour)\n";
+    }
+}
 
 void studentLogin() {
     cout << "\n=== STUDENT LOGIN ===\n";
@@ -625,11 +916,12 @@ void studentMenu() {
         cout << "|            STUDENT MENU            | \n";
         cout << "|____________________________________|\n";
         cout << "| 1. View All Assignments            |\n";
-        cout << "| 2. Search Assignment (BST)         |\n";
+        cout << "| 2. Search Assignment (B+ Tree)     |\n";
         cout << "| 3. Submit Assignment (Queue)       |\n";
         cout << "| 4. View My Submissions             |\n";
         cout << "| 5. View Rankings (Sorting)         |\n";
-        cout << "| 6. Logout                          |\n";
+        cout << "| 6. Upcoming Deadlines              |\n";
+        cout << "| 7. Logout                          |\n";
         cout << "|____________________________________|\n";
         cout << "Choice: ";
         cin >> choice;
@@ -637,11 +929,11 @@ void studentMenu() {
 
         switch (choice) {
             case 1:
-                assignmentList.displayAll();
+                displayAllAssignments();
                 break;
                 
             case 2:
-                cout << "\nSearch by:\n1. Title\n2. ID\nChoice: ";
+                cout << "\nSearch by:\n1. Title\n2. ID\n3. Title Prefix\n4. Title Range\n5. Keywords\nChoice: ";
                 {
                     int searchChoice;
                     cin >> searchChoice;
@@ -650,51 +942,55 @@ void studentMenu() {
                     if (searchChoice == 1) {
                         cout << "Enter Assignment Title: ";
                         getline(cin, title);
-                        assignmentList.displayDetails(assignmentList.searchByTitle(title));
+                        displayMatches(elearning->assignments.searchAllByTitle(title));
+                    } else if (searchChoice == 3) {
+                        cout << "Enter Title Prefix: ";
+                        getline(cin, title);
+                        displayMatches(elearning->assignments.searchByPrefix(title));
+                    } else if (searchChoice == 4) {
+                        string high;
+                        cout << "From Title: ";
+                        getline(cin, title);
+                        cout << "To Title: ";
+                        getline(cin, high);
+                        displayMatches(elearning->assignments.searchByTitleRange(title, high));
+                    } else if (searchChoice == 5) {
+                        bool matchAll = readKeywords(title);
+                        displayMatches(elearning->searchAssignments(title, matchAll));
                     } else {
                         cout << "Enter Assignment ID: ";
                         getline(cin, id);
-                        assignmentList.displayDetails(assignmentList.searchByID(id));
+                        displayDetails(elearning->assignments.searchByID(id));
                     }
                 }
                 break;
                 
-            case 3: {
-                assignmentList.displayAll();
-                cout << "Enter Assignment ID to submit: ";
-                cin >> id;
-                
-                Assignment* assg = assignmentList.searchByID(id);
-                if (assg == nullptr) {
-                    cout << "Assignment not found.\n";
-                    break;
-                }
-                
-                if (submissionQueue.isDuplicate(currentStudent.studentID, id)) {
-                    cout << "You already submitted this assignment.\n";
-                    break;
-                }
-                
-                submissionQueue.enqueue(currentStudent, assg);
+            case 3:
+                submitAssignment();
                 break;
-            }
                 
             case 4:
-                submissionQueue.displayByStudent(currentStudent.studentID);
+                displayByStudent(currentStudent.studentID);
                 break;
                 
             case 5:
-                submissionQueue.displayStudentRankings();
+                displayStudentRankings();
+                displayStudentRank(currentStudent.studentID);
                 break;
                 
             case 6:
+                displayDeadlines(false);
+                break;
+                
+            case 7:
                 cout << "Logging out...\n";
                 break;
                 
             default:
                 cout << "Invalid choice.\n";
         }
-    } while (choice != 6);
+        saveChanges();
+    } while (choice != 7);
 }
 
 void lecturerMenu() {
@@ -707,14 +1003,25 @@ void lecturerMenu() {
         cout << "|     -------LECTURER MENU------      |\n";
         cout << "|_____________________________________|\n";
         cout << "| 1. Create Assignment                |\n";
-        cout << "| 2. Undo Last Creation               |\n";
-        cout << "| 3. View Creation History            |\n";
+        cout << "| 2. Undo Last Change                 |\n";
+        cout << "| 3. View Change History              |\n";
         cout << "| 4. View All Assignments             |\n";
         cout << "| 5. Search Assignment                |\n";
         cout << "| 6. View Pending Submissions         |\n";
         cout << "| 7. Grade Submission                 |\n";
         cout << "| 8. View Student Rankings            |\n";
-        cout << "| 9. Logout                           |\n";
+        cout << "| 9. Memory Statistics                |\n";
+        cout << "| 10. Assignment Statistics           |\n";
+        cout << "| 11. Grade Next Submission           |\n";
+        cout << "| 12. Edit Assignment                 |\n";
+        cout << "| 13. Delete Assignment               |\n";
+        cout << "| 14. Redo Last Undo                  |\n";
+        cout << "| 15. Deadlines                       |\n";
+        cout << "| 16. Performance Statistics          |\n";
+        cout << "| 17. Regrade Whole Assignment        |\n";
+        cout << "| 18. Late Penalty Policy             |\n";
+        cout << "| 19. Save a Submitted File           |\n";
+        cout << "| 20. Logout                          |\n";
         cout << "|_____________________________________|\n";
         cout << "Choice: ";
         cin >> choice;
@@ -722,64 +1029,262 @@ void lecturerMenu() {
 
         switch (choice) {
             case 1:
-                assignmentList.insertAssignment();
+                createAssignment();
                 break;
                 
             case 2:
-                assignmentList.undoLastCreation();
+                undoLastChange();
                 break;
                 
             case 3:
-                assignmentList.displayCreationHistory();
+                displayChangeHistory();
                 break;
                 
             case 4:
-                assignmentList.displayAll();
+                displayAllAssignments();
                 break;
                 
             case 5: {
-                string title;
-                cout << "Enter Assignment Title: ";
+                string text;
+                int searchChoice;
+                cout << "\nSearch by:\n1. Title\n2. Keywords in assignments\n3. Keywords in feedback\nChoice: ";
+                cin >> searchChoice;
                 cin.ignore();
-                getline(cin, title);
-                assignmentList.displayDetails(assignmentList.searchByTitle(title));
+                if (searchChoice == 2) {
+                    bool matchAll = readKeywords(text);
+                    displayMatches(elearning->searchAssignments(text, matchAll));
+                } else if (searchChoice == 3) {
+                    bool matchAll = readKeywords(text);
+                    displayFeedbackMatches(elearning->searchFeedback(text, matchAll));
+                } else {
+                    cout << "Enter Assignment Title: ";
+                    getline(cin, text);
+                    displayMatches(elearning->assignments.searchAllByTitle(text));
+                }
                 break;
             }
                 
             case 6:
-                submissionQueue.displayPending();
+                displayPending();
                 break;
                 
             case 7:
-                submissionQueue.displayPending();
-                cout << "Enter Submission ID to grade: ";
-                cin >> id;
-                submissionQueue.gradeSubmission(id);
+                gradeSubmission();
                 break;
                 
             case 8:
-                submissionQueue.displayStudentRankings();
+                displayStudentRankings();
                 break;
                 
             case 9:
+                displayMemoryStats();
+                break;
+                
+            case 10:
+                displayAssignmentStatistics();
+                break;
+                
+            case 11:
+                gradeNextSubmission();
+                break;
+                
+            case 12:
+                editAssignment();
+                break;
+                
+            case 13:
+                deleteAssignment();
+                break;
+                
+            case 14:
+                redoLastChange();
+                break;
+                
+            case 15:
+                displayDeadlines(true);
+                break;
+                
+            case 16:
+                displayPerformanceStats();
+                break;
+                
+            case 17:
+                regradeAssignment();
+                break;
+                
+            case 18:
+                configureLatePolicy();
+                break;
+                
+            case 19:
+                saveSubmittedFile();
+                break;
+                
+            case 20:
                 cout << "Logging out...\n";
                 break;
                 
             default:
                 cout << "Invalid choice.\n";
         }
-    } while (choice != 9);
+        saveChanges();
+    } while (choice != 20);
+}
+
+// Non-interactive mode: elearning-system [--course ID] --import-assignments FILE ...
+// Files after --course ID go into that course, which is created if needed.
+int runBulkImport(int argc, char* argv[]) {
+    vector<ELearningSystem*> imported;
+    vector<ImportReport> reports;
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+        string flag = argv[i];
+        if (i + 1 >= argc) {
+            cout << "Missing " << (flag == "--course" ? "course ID" : "file") << " after " << flag << endl;
+            ok = false;
+            break;
+        }
+        string path = argv[++i];
+        if (flag == "--course") {
+            if (router.course(path, &elearning, true) != STATUS_OK) {
+                cout << "Invalid course ID " << path << endl;
+                ok = false;
+                break;
+            }
+            continue;
+        }
+        if (!elearning->storage.isEnabled()) {
+            cout << "Error: storage is unavailable, " << path << " was not imported.\n";
+            ok = false;
+            break;
+        }
+        if (find(imported.begin(), imported.end(), elearning) == imported.end())
+            imported.push_back(elearning);
+
+        BulkImporter importer(elearning->assignments, elearning->submissions, &elearning->blobs);
+        ImportReport report;
+        bool loaded;
+        if (flag == "--import-assignments")
+            loaded = importer.importAssignments(path, report);
+        else if (flag == "--import-submissions")
+            loaded = importer.importSubmissions(path, report);
+        else if (flag == "--import-grades")
+            loaded = importer.importGrades(path, report);
+        else {
+            cout << "Unknown option " << flag << endl;
+            cout << "Usage: elearning-system [--course ID] [--import-assignments FILE] "
+                    "[--import-submissions FILE] [--import-grades FILE] ...\n"
+                    "       elearning-system --serve SOCKET [UPLOAD_DIR]\n";
+            ok = false;
+            break;
+        }
+        if (!loaded) {
+            cout << "Cannot open " << path << endl;
+            ok = false;
+            break;
+        }
+        for (const string& sample : report.rejectSamples)
+            cout << "  " << report.file << " " << sample << endl;
+        reports.push_back(report);
+    }
+
+    // One snapshot per course covers the whole import instead of a log record per row
+    for (ELearningSystem* course : imported) {
+        if (!course->storage.checkpoint())
+            cout << "Warning: could not write snapshot.\n";
+    }
+
+    cout << "\n=== IMPORT SUMMARY ===\n";
+    cout << left
+         << setw(30) << "File"
+         << setw(10) << "Rows"
+         << setw(10) << "Imported"
+         << setw(10) << "Rejected"
+         << setw(10) << "Seconds"
+         << "Rows/sec" << endl;
+    cout << string(80, '-') << endl;
+    for (const ImportReport& report : reports)
+        printImportReport(report);
+    return ok ? 0 : 1;
+}
+
+// ============== SERVER MODE ==============
+atomic<bool> stopServer{false};
+
+void requestStop(int) {
+    stopServer = true;
+}
+
+// Hosts the shared state for socket clients until SIGINT or SIGTERM.
+// Submitted files are read only from uploadRoot; none are taken without it.
+int runServer(const string& socketPath, const string& uploadRoot) {
+#ifdef __linux__
+    SocketServer server(router);
+    if (!uploadRoot.empty() && !server.setUploadRoot(uploadRoot)) {
+        cout << "Cannot open upload directory " << uploadRoot << endl;
+        return 1;
+    }
+    if (!server.listen(socketPath)) {
+        cout << "Cannot listen on " << socketPath << endl;
+        return 1;
+    }
+    signal(SIGINT, requestStop);
+    signal(SIGTERM, requestStop);
+    cout << "Serving on " << socketPath << " (Ctrl+C to stop)" << endl;
+    if (uploadRoot.empty()) cout << "No upload directory given; submissions will be refused." << endl;
+    server.run(stopServer);
+
+    ServerStats stats = server.getStats();
+    cout << "\n=== SERVER SUMMARY ===\n";
+    cout << "Clients accepted: " << stats.accepted << endl;
+    cout << "Requests: " << stats.requests << " in " << stats.reads << " batches\n";
+    cout << "Bytes in/out: " << stats.bytesIn << " / " << stats.bytesOut << endl;
+    server.close();
+    return 0;
+#else
+    (void)uploadRoot;
+    cout << "Server mode is only available on Linux (" << socketPath << ").\n";
+    return 1;
+#endif
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     int choice;
+
+    if (!router.open("elearning"))
+        cout << "Warning: the course list could not be read; only " << DEFAULT_COURSE << " is available.\n";
+    elearning = &router.defaultCourse();
+    if (!elearning->storage.isEnabled()) {
+        cout << "Warning: saved data could not be loaded; changes will not be saved.\n";
+    } else if (elearning->storage.getSkippedRecords() > 0) {
+        cout << "Warning: skipped " << elearning->storage.getSkippedRecords()
+             << " log record(s) that did not apply.\n";
+    }
+
+    if ((argc == 3 || argc == 4) && string(argv[1]) == "--serve") {
+        int status = runServer(argv[2], argc == 4 ? argv[3] : "");
+        router.close();
+        return status;
+    }
+
+    if (argc > 1) {
+        int status = runBulkImport(argc, argv);
+        router.close();
+        return status;
+    }
+
+    // Fingerprint submitted files in the background for grading hints
+    elearning->enableSimilarity();
     
     do {
         cout << "________________________________________\n";
         cout << "|     E-LEARNING ASSIGNMENT SYSTEM     |\n";
+        cout << "| Course: " << left << setw(29) << currentCourse << "|\n";
         cout << "|______________________________________|\n";
         cout << "| 1. Student Login                     |\n";
         cout << "| 2. Lecturer Login                    |\n";
+        cout << "| 3. Switch Course                     |\n";
+        cout << "| 4. All Courses Report                |\n";
         cout << "| 0. Exit System                       |\n";
         cout << "|______________________________________|\n";
         cout << "Choice: ";
@@ -794,6 +1299,14 @@ int main() {
             case 2:
                 lecturerMenu();
                 break;
+
+            case 3:
+                switchCourse();
+                break;
+
+            case 4:
+                displayCourseReport();
+                break;
                 
             case 0:
                 cout << "\n=== Thank you for using the system! ===\n";
@@ -804,5 +1317,6 @@ int main() {
         }
     } while (choice != 0);
     
+    router.close();
     return 0;
 }
\ No newline at end of file
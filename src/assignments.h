@@ -0,0 +1,627 @@
+// The assignment list and the indexes it keeps in step.
+#ifndef ELEARNING_ASSIGNMENTS_H
+#define ELEARNING_ASSIGNMENTS_H
+
+#include "index.h"
+#include "storage.h"
+
+// ============== ASSIGNMENT LINKED LIST ==============
+// One version of an assignment: a list node, a snapshot record, or neither.
+// Edits and deletes swap versions in and out instead of changing them in
+// place, so ChangeHistory can undo either way in O(log n).
+struct AssignmentVersion {
+    Assignment* node;
+    long baseIndex;       // -1 unless a snapshot record
+
+    bool isEmpty() const { return node == nullptr && baseIndex < 0; }
+};
+
+inline AssignmentVersion noVersion() {
+    return AssignmentVersion{nullptr, -1};
+}
+
+// Where a due-date listing stopped, so the next page resumes there in
+// O(page) instead of skipping from the start. Valid until the list changes.
+struct DueDateCursor {
+    uint32_t basePos;         // next position in the snapshot's due-date index
+    const Assignment* node;   // next list node
+};
+
+class AssignmentLinkedList {
+private:
+    Assignment* head;
+    int count;
+    BPlusTree titleIndex;
+    CalendarIndex calendar;  // list members by (dueDay, listOrder)
+    uint32_t linkCount;
+    uint64_t changeCount;    // bumped whenever the visible set changes
+    TextIndex textIndex;     // title and description words; built on first search
+    bool textSeeded;
+    unordered_map<string, uint32_t> documentByID;  // text index document of each ID
+    vector<string> idByDocument;
+    ObjectPool<Assignment> assignmentPool;
+    WriteAheadLog* log;
+    unordered_map<string, Assignment*> byID;  // list members only
+
+    // Assignments from the mapped snapshot; only the ones a caller asks for
+    // are copied into Assignment objects. Records edited or deleted since
+    // the snapshot are hidden.
+    const MappedSnapshot* base;
+    unordered_map<uint32_t, Assignment*> baseCache;
+    unordered_set<uint32_t> hiddenBase;
+
+    bool baseVisible(uint32_t index) {
+        return hiddenBase.empty() || hiddenBase.count(index) == 0;
+    }
+
+    // Snapshot record for the ID, or -1 if there is none or it is hidden
+    long findBase(const string& id) {
+        if (base == nullptr) return -1;
+        long index = base->findAssignment(id);
+        return index >= 0 && baseVisible((uint32_t)index) ? index : -1;
+    }
+
+    string generateID() {
+        count++;
+        return "ASSG" + to_string(1000 + count);
+    }
+
+    Assignment* baseAssignment(uint32_t index) {
+        auto it = baseCache.find(index);
+        if (it != baseCache.end()) return it->second;
+
+        const SnapAssignment& record = base->assignment(index);
+        Assignment* assg = assignmentPool.allocate();
+        assg->assignmentID = string(base->text(record.assignmentID));
+        assg->title = string(base->text(record.title));
+        assg->description = string(base->text(record.description));
+        assg->dueDate = string(base->text(record.dueDate));
+        assg->maxScore = record.maxScore;
+        assg->dueDay = dayNumber(assg->dueDate);
+        assg->listOrder = 0;
+        assg->next = nullptr;
+        assg->prev = nullptr;
+        baseCache[index] = assg;
+        return assg;
+    }
+
+    // Snapshot assignments in title order from the first title >= from, while keep(title)
+    template <typename Keep>
+    vector<Assignment*> scanBaseTitles(string_view from, Keep keep) {
+        vector<Assignment*> out;
+        if (base == nullptr) return out;
+        for (uint32_t pos = base->titleLowerBound(from); pos < base->assignmentCount(); pos++) {
+            uint32_t index = base->byTitle(pos);
+            if (!keep(base->text(base->assignment(index).title))) break;
+            if (baseVisible(index)) out.push_back(baseAssignment(index));
+        }
+        return out;
+    }
+
+    // Merges two (title, ID) ordered result lists
+    vector<Assignment*> mergeByTitle(vector<Assignment*> first, vector<Assignment*> second) {
+        vector<Assignment*> out(first.size() + second.size());
+        merge(first.begin(), first.end(), second.begin(), second.end(), out.begin(),
+              [](Assignment* a, Assignment* b) {
+                  if (a->title != b->title) return a->title < b->title;
+                  return a->assignmentID < b->assignmentID;
+              });
+        return out;
+    }
+
+    // Puts the node after `after` (nullptr: at the head) and indexes it
+    void spliceAfter(Assignment* assg, Assignment* after) {
+        assg->prev = after;
+        assg->next = after ? after->next : head;
+        if (assg->next) assg->next->prev = assg;
+        if (after) after->next = assg;
+        else head = assg;
+
+        titleIndex.insertItem(assg->title, assg);
+        byID[assg->assignmentID] = assg;
+    }
+
+    bool isLinked(Assignment* assg) {
+        auto it = byID.find(assg->assignmentID);
+        return it != byID.end() && it->second == assg;
+    }
+
+    // Adds to the calendar, the title index and the due-date ordered list.
+    // A new node sorts after any equal due dates, so older assignments stay
+    // first; a relinked one keeps its order and goes back where it was.
+    void linkAssignment(Assignment* assg) {
+        if (assg->listOrder == 0) assg->listOrder = ++linkCount;
+        spliceAfter(assg, calendar.insert(assg));
+        changeCount++;
+        if (textSeeded) indexText(*assg);
+    }
+
+    // Dense document number for the text index; imported IDs need not be
+    // ASSG<digits>, so numbers are handed out in first-use order and kept
+    uint32_t documentOf(string_view id) {
+        auto it = documentByID.find(string(id));
+        if (it != documentByID.end()) return it->second;
+        uint32_t doc = (uint32_t)idByDocument.size();
+        idByDocument.emplace_back(id);
+        documentByID.emplace(idByDocument.back(), doc);
+        return doc;
+    }
+
+    void indexText(const Assignment& assg) {
+        textIndex.add(documentOf(assg.assignmentID), assg.title + " " + assg.description);
+    }
+
+    void indexBaseText(uint32_t index) {
+        const SnapAssignment& record = base->assignment(index);
+        string text = string(base->text(record.title)) + " " + string(base->text(record.description));
+        textIndex.add(documentOf(base->text(record.assignmentID)), text);
+    }
+
+    // Indexes every visible assignment the first time a keyword search runs
+    void ensureText() {
+        if (textSeeded) return;
+        textSeeded = true;
+        if (base != nullptr) {
+            for (uint32_t i = 0; i < base->assignmentCount(); i++)
+                if (baseVisible(i)) indexBaseText(i);
+        }
+        for (Assignment* temp = head; temp != nullptr; temp = temp->next)
+            indexText(*temp);
+    }
+
+    // O(1) in the list, O(log n) in the calendar and title index
+    void unlinkAssignment(Assignment* assg) {
+        if (assg->prev) assg->prev->next = assg->next;
+        else head = assg->next;
+        if (assg->next) assg->next->prev = assg->prev;
+        assg->next = nullptr;
+        assg->prev = nullptr;
+
+        calendar.erase(assg);
+        titleIndex.deleteItem(assg->title, assg);
+        changeCount++;
+        byID.erase(assg->assignmentID);
+        if (textSeeded) textIndex.remove(documentOf(assg->assignmentID));
+    }
+
+    Assignment* newNode(const string& id, const AssignmentSpec& spec) {
+        Assignment* assg = assignmentPool.allocate();
+        assg->assignmentID = id;
+        assg->title = spec.title;
+        assg->description = spec.description;
+        assg->dueDate = spec.dueDate;
+        assg->maxScore = spec.maxScore;
+        assg->dueDay = dayNumber(spec.dueDate);
+        assg->listOrder = 0;
+        assg->next = nullptr;
+        assg->prev = nullptr;
+        return assg;
+    }
+
+public:
+    // nullptr if the spec can be used, otherwise what is wrong with it
+    static const char* specProblem(const AssignmentSpec& spec) {
+        if (spec.title.empty()) return "missing title";
+        if (!isValidDate(spec.dueDate)) return "due date is not YYYY-MM-DD";
+        if (spec.maxScore <= 0) return "invalid max score";
+        return nullptr;
+    }
+
+    static bool isValidSpec(const AssignmentSpec& spec) {
+        return specProblem(spec) == nullptr;
+    }
+
+    AssignmentLinkedList() {
+        head = nullptr;
+        count = 0;
+        linkCount = 0;
+        changeCount = 0;
+        textSeeded = false;
+        log = nullptr;
+        base = nullptr;
+    }
+
+    void attachLog(WriteAheadLog* wal) {
+        log = wal;
+    }
+
+    // Serves snapshot assignments from the mapping; new ones go in the list
+    void attachBase(const MappedSnapshot* snapshot) {
+        base = snapshot;
+        setCounter(snapshot->header().assignmentCounter);
+        changeCount++;
+    }
+
+    // Validates and adds a new assignment; *created points at it on success
+    Status createAssignment(const AssignmentSpec& spec, Assignment** created = nullptr) {
+        MetricTimer timer(METRIC_CREATE_ASSIGNMENT);
+        if (!isValidSpec(spec)) return STATUS_INVALID;
+
+        Assignment* newAssg = newNode(generateID(), spec);
+        linkAssignment(newAssg);
+        if (log) log->logCreateAssignment(newAssg);
+
+        if (created) *created = newAssg;
+        return STATUS_OK;
+    }
+
+    // Replaces the assignment with a new version holding the spec; the ID
+    // stays the same. *before / *after receive both versions.
+    Status editAssignment(const string& id, const AssignmentSpec& spec,
+                          AssignmentVersion* before = nullptr, AssignmentVersion* after = nullptr) {
+        if (!isValidSpec(spec)) return STATUS_INVALID;
+        AssignmentVersion current = findVersion(id);
+        if (current.isEmpty()) return STATUS_NOT_FOUND;
+
+        retire(current);
+        Assignment* edited = newNode(id, spec);
+        linkAssignment(edited);
+        if (log) log->logEditAssignment(edited);
+
+        if (before) *before = current;
+        if (after) *after = AssignmentVersion{edited, -1};
+        return STATUS_OK;
+    }
+
+    // Takes the assignment out of the list and indexes; *removed receives
+    // the version, which stays allocated until the caller releases it
+    Status deleteAssignment(const string& id, AssignmentVersion* removed = nullptr) {
+        AssignmentVersion current = findVersion(id);
+        if (current.isEmpty()) return STATUS_NOT_FOUND;
+
+        retire(current);
+        if (log) log->logDeleteAssignment(id);
+        if (removed) *removed = current;
+        else if (current.node) assignmentPool.release(current.node);
+        return STATUS_OK;
+    }
+
+    // The visible version of an assignment; empty if there is none
+    AssignmentVersion findVersion(const string& id) {
+        auto it = byID.find(id);
+        if (it != byID.end()) return AssignmentVersion{it->second, -1};
+        return AssignmentVersion{nullptr, findBase(id)};
+    }
+
+    // Makes a version invisible (unlink the node or hide the record)
+    void retire(AssignmentVersion& version) {
+        if (version.node) {
+            unlinkAssignment(version.node);
+        } else if (version.baseIndex >= 0) {
+            hiddenBase.insert((uint32_t)version.baseIndex);
+            changeCount++;
+            if (textSeeded) textIndex.remove(documentOf(base->text(base->assignment((uint32_t)version.baseIndex).assignmentID)));
+        }
+    }
+
+    // Makes a retired version visible again
+    void restore(AssignmentVersion& version) {
+        if (version.node) {
+            linkAssignment(version.node);
+        } else if (version.baseIndex >= 0) {
+            hiddenBase.erase((uint32_t)version.baseIndex);
+            changeCount++;
+            if (textSeeded) indexBaseText((uint32_t)version.baseIndex);
+        }
+    }
+
+    // Frees a retired version's node; records need nothing
+    void releaseVersion(AssignmentVersion& version) {
+        if (version.node) assignmentPool.release(version.node);
+        version = noVersion();
+    }
+
+    // Visible versions are the current one for their ID
+    bool isVisible(const AssignmentVersion& version) {
+        if (version.node) return isLinked(version.node);
+        return version.baseIndex >= 0 && baseVisible((uint32_t)version.baseIndex);
+    }
+
+    // The version's fields, node or record
+    Assignment versionFields(const AssignmentVersion& version) {
+        if (version.node) return *version.node;
+        Assignment fields = *baseAssignment((uint32_t)version.baseIndex);
+        return fields;
+    }
+
+    // A version that is not linked, e.g. one reloaded from saved history
+    AssignmentVersion detachedVersion(const Assignment& fields) {
+        AssignmentSpec spec{fields.title, fields.description, fields.dueDate, fields.maxScore};
+        return AssignmentVersion{newNode(fields.assignmentID, spec), -1};
+    }
+
+    // Re-applies a logged creation without prompting or logging
+    Assignment* restoreAssignment(string id, string title, string description, string dueDate, int maxScore) {
+        Assignment* newAssg = newNode(id, AssignmentSpec{title, description, dueDate, maxScore});
+        linkAssignment(newAssg);
+
+        int number = assignmentNumber(id) - 1000;
+        if (number > count) count = number;
+        return newAssg;
+    }
+
+    // Adds a batch of assignments (oldest first) without prompting or logging.
+    // The batch is sorted once and merged into the due-date list in a single
+    // pass, and the title index is rebuilt bottom-up.
+    void bulkInsert(const vector<Assignment>& specs) {
+        vector<Assignment*> batch;
+        batch.reserve(specs.size());
+        for (const Assignment& spec : specs) {
+            Assignment* newAssg = assignmentPool.allocate();
+            *newAssg = spec;
+            newAssg->dueDay = dayNumber(spec.dueDate);
+            newAssg->next = nullptr;
+            batch.push_back(newAssg);
+            byID[newAssg->assignmentID] = newAssg;
+
+            int number = assignmentNumber(newAssg->assignmentID) - 1000;
+            if (number > count) count = number;
+        }
+        titleIndex.bulkInsert(batch);
+        changeCount++;
+
+        // Older assignments stay first among equal due dates, as in linkAssignment
+        vector<Assignment*> byDue(batch.begin(), batch.end());
+        stable_sort(byDue.begin(), byDue.end(), [](Assignment* a, Assignment* b) {
+            return a->dueDay < b->dueDay;
+        });
+        for (Assignment* assg : byDue) {
+            assg->listOrder = ++linkCount;
+            calendar.insert(assg);
+            if (textSeeded) indexText(*assg);
+        }
+
+        Assignment dummy;
+        Assignment* tail = &dummy;
+        Assignment* current = head;
+        size_t i = 0;
+        while (current != nullptr || i < byDue.size()) {
+            if (i < byDue.size() && (current == nullptr || byDue[i]->dueDay < current->dueDay)) {
+                tail->next = byDue[i++];
+            } else {
+                tail->next = current;
+                current = current->next;
+            }
+            tail = tail->next;
+        }
+        tail->next = nullptr;
+        head = dummy.next;
+
+        Assignment* prev = nullptr;
+        for (Assignment* temp = head; temp != nullptr; temp = temp->next) {
+            temp->prev = prev;
+            prev = temp;
+        }
+    }
+
+    // Every visible assignment: the snapshot, then the list in due-date order
+    template <typename Visit>
+    void forEachAssignment(Visit visit) {
+        if (base != nullptr) {
+            Assignment scratch;
+            for (uint32_t i = 0; i < base->assignmentCount(); i++) {
+                if (!baseVisible(i)) continue;
+                auto it = baseCache.find(i);
+                if (it != baseCache.end()) {
+                    visit(*it->second);
+                    continue;
+                }
+                const SnapAssignment& record = base->assignment(i);
+                scratch.assignmentID = string(base->text(record.assignmentID));
+                scratch.title = string(base->text(record.title));
+                scratch.description = string(base->text(record.description));
+                scratch.dueDate = string(base->text(record.dueDate));
+                scratch.maxScore = record.maxScore;
+                visit(scratch);
+            }
+        }
+        for (Assignment* temp = head; temp != nullptr; temp = temp->next)
+            visit(*temp);
+    }
+
+    int getCounter() { return count; }
+    void setCounter(int value) { if (value > count) count = value; }
+
+    bool isEmpty() {
+        return head == nullptr && (base == nullptr || base->assignmentCount() == hiddenBase.size());
+    }
+
+    // visit(id, title, dueDate, maxScore) in due-date order. The snapshot's
+    // due-date index is merged with the list; on equal dates the snapshot
+    // (older) comes first, matching linkAssignment.
+    template <typename Visit>
+    void forEachByDueDate(Visit visit) {
+        DueDateCursor cursor = firstByDueDate();
+        forEachByDueDateFrom(cursor, SIZE_MAX, visit);
+    }
+
+    DueDateCursor firstByDueDate() {
+        return DueDateCursor{0, head};
+    }
+
+    // Up to `limit` rows of forEachByDueDate starting at the cursor, which
+    // is moved past them; returns the number visited
+    template <typename Visit>
+    size_t forEachByDueDateFrom(DueDateCursor& cursor, size_t limit, Visit visit) {
+        uint32_t baseTotal = base ? base->assignmentCount() : 0;
+        const Assignment* temp = cursor.node;
+        uint32_t pos = cursor.basePos;
+        size_t visited = 0;
+        while ((temp != nullptr || pos < baseTotal) && visited < limit) {
+            if (pos < baseTotal) {
+                uint32_t index = base->byDue(pos);
+                if (!baseVisible(index)) {
+                    pos++;
+                    continue;
+                }
+                const SnapAssignment& record = base->assignment(index);
+                string_view dueDate = base->text(record.dueDate);
+                if (temp == nullptr || dueDate <= temp->dueDate) {
+                    visit(base->text(record.assignmentID), base->text(record.title),
+                          dueDate, record.maxScore);
+                    pos++;
+                    visited++;
+                    continue;
+                }
+            }
+            visit(string_view(temp->assignmentID), string_view(temp->title),
+                  string_view(temp->dueDate), temp->maxScore);
+            temp = temp->next;
+            visited++;
+        }
+        cursor = DueDateCursor{pos, temp};
+        return visited;
+    }
+
+    // A DueDateCursor is only valid while this is unchanged
+    uint64_t getChangeCount() {
+        return changeCount;
+    }
+
+    // Assignments forEachByDueDate would visit, in O(1)
+    size_t visibleCount() {
+        size_t snapshot = base ? base->assignmentCount() - hiddenBase.size() : 0;
+        return snapshot + (size_t)calendar.getSize();
+    }
+
+    // Like forEachByDueDate, for due days fromDay..toDay inclusive: one
+    // calendar descent and one binary search, then O(k) for k matches
+    template <typename Visit>
+    void forEachDueBetween(int fromDay, int toDay, Visit visit) {
+        uint32_t baseTotal = base ? base->assignmentCount() : 0;
+        string from = fromDay > dayNumber("0001-01-01") ? formatDay(fromDay) : "";
+        uint32_t pos = base ? base->dueLowerBound(from) : 0;
+        const CalendarNode* node = calendar.lowerBound(fromDay);
+        if (node != nullptr && node->day > toDay) node = nullptr;
+        while (node != nullptr || pos < baseTotal) {
+            if (pos < baseTotal) {
+                uint32_t index = base->byDue(pos);
+                const SnapAssignment& record = base->assignment(index);
+                string_view dueDate = base->text(record.dueDate);
+                int day = dayNumber(dueDate);
+                if (day > toDay) {
+                    pos = baseTotal;
+                    continue;
+                }
+                if (node == nullptr || day <= node->day) {
+                    if (baseVisible(index))
+                        visit(base->text(record.assignmentID), base->text(record.title), dueDate, record.maxScore);
+                    pos++;
+                    continue;
+                }
+            }
+            const Assignment* assg = node->value;
+            visit(string_view(assg->assignmentID), string_view(assg->title), string_view(assg->dueDate), assg->maxScore);
+            node = node->next[0];
+            if (node != nullptr && node->day > toDay) node = nullptr;
+        }
+    }
+
+    // Search using B+ tree, then the snapshot's sorted title index
+    Assignment* searchByTitle(string title) {
+        MetricTimer timer(METRIC_TITLE_SEARCH);
+        Assignment* found = titleIndex.searchByTitle(title);
+        if (found != nullptr) return found;
+        vector<Assignment*> snapshotMatches = scanBaseTitles(title, [&](string_view t) { return t == title; });
+        return snapshotMatches.empty() ? nullptr : snapshotMatches[0];
+    }
+
+    vector<Assignment*> searchAllByTitle(string title) {
+        MetricTimer timer(METRIC_TITLE_SEARCH);
+        return mergeByTitle(titleIndex.searchAll(title),
+                            scanBaseTitles(title, [&](string_view t) { return t == title; }));
+    }
+
+    vector<Assignment*> searchByPrefix(string prefix) {
+        MetricTimer timer(METRIC_TITLE_SEARCH);
+        return mergeByTitle(titleIndex.searchPrefix(prefix),
+                            scanBaseTitles(prefix, [&](string_view t) {
+                                return t.substr(0, prefix.size()) == prefix;
+                            }));
+    }
+
+    vector<Assignment*> searchByTitleRange(string low, string high) {
+        MetricTimer timer(METRIC_TITLE_SEARCH);
+        return mergeByTitle(titleIndex.searchRange(low, high),
+                            scanBaseTitles(low, [&](string_view t) { return t <= high; }));
+    }
+
+    // Keyword search over titles and descriptions, best match first.
+    // matchAll: every word must appear; otherwise any of them.
+    vector<Assignment*> searchText(string query, bool matchAll, size_t limit = 20) {
+        MetricTimer timer(METRIC_TEXT_SEARCH);
+        ensureText();
+        vector<Assignment*> out;
+        for (const TextHit& hit : textIndex.search(query, matchAll, limit)) {
+            Assignment* assg = searchByID(idByDocument[hit.doc]);
+            if (assg != nullptr) out.push_back(assg);
+        }
+        return out;
+    }
+
+    // Read-only lookup that never fills the cache, so it is safe for
+    // concurrent readers as long as nothing modifies the list meanwhile
+    bool findTitle(const string& id, string& title) {
+        auto it = byID.find(id);
+        if (it != byID.end()) {
+            title = it->second->title;
+            return true;
+        }
+        long index = findBase(id);
+        if (index >= 0) {
+            title = string(base->text(base->assignment((uint32_t)index).title));
+            return true;
+        }
+        return false;
+    }
+
+    // Same as findTitle, for the due date
+    bool findDueDate(const string& id, string& dueDate) {
+        auto it = byID.find(id);
+        if (it != byID.end()) {
+            dueDate = it->second->dueDate;
+            return true;
+        }
+        long index = findBase(id);
+        if (index >= 0) {
+            dueDate = string(base->text(base->assignment((uint32_t)index).dueDate));
+            return true;
+        }
+        return false;
+    }
+
+    // Same as findTitle, for the max score
+    bool findMaxScore(const string& id, int& maxScore) {
+        auto it = byID.find(id);
+        if (it != byID.end()) {
+            maxScore = it->second->maxScore;
+            return true;
+        }
+        long index = findBase(id);
+        if (index >= 0) {
+            maxScore = base->assignment((uint32_t)index).maxScore;
+            return true;
+        }
+        return false;
+    }
+
+    // Search by ID (hash lookup, then the snapshot's sorted ID index)
+    Assignment* searchByID(string id) {
+        auto it = byID.find(id);
+        if (it != byID.end()) return it->second;
+        long index = findBase(id);
+        return index >= 0 ? baseAssignment((uint32_t)index) : nullptr;
+    }
+
+    vector<pair<string, PoolStats>> memoryStats() {
+        vector<pair<string, PoolStats>> stats = {
+            {"Assignment", assignmentPool.getStats()},
+            {"BPlusNode", titleIndex.memoryStats()},
+            {"CalendarNode", calendar.memoryStats()}
+        };
+        if (textSeeded) stats.push_back({"AssgText", textIndex.memoryStats()});
+        return stats;
+    }
+};
+
+#endif
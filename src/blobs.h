@@ -0,0 +1,567 @@
+// Content-addressed storage for submitted files.
+#ifndef ELEARNING_BLOBS_H
+#define ELEARNING_BLOBS_H
+
+#include "storage.h"
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+// ============== BLOB STORE (Content-Addressed Files) ==============
+// Submitted files are kept in a directory of their own, named by the
+// SHA-256 of their contents: baseName.blobs/ab/cdef... A submission refers
+// to its file by that digest, so the file it names cannot change or vanish,
+// and identical files (a resubmission, shared starter code) are stored once.
+// A file is read in BLOB_CHUNK pieces and hashed as it streams; a new file
+// is then copied in the kernel (copy_file_range, else sendfile), or with
+// compression on, compressed chunk by chunk on the same pass.
+const size_t BLOB_CHUNK = 64 * 1024;
+const uint32_t BLOB_MAGIC = 0x425A4C45;   // "ELZB", compressed blob header
+const int BLOB_HASH_BITS = 12;            // match finder table of the compressor
+
+// SHA-256 (FIPS 180-4), fed incrementally
+class Sha256 {
+private:
+    uint32_t state[8];
+    unsigned char block[64];
+    size_t blockSize;
+    uint64_t length;
+
+    static uint32_t rotate(uint32_t x, int bits) {
+        return (x >> bits) | (x << (32 - bits));
+    }
+
+    void compress(const unsigned char* data) {
+        static const uint32_t rounds[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++)
+            w[i] = (uint32_t)data[4 * i] << 24 | (uint32_t)data[4 * i + 1] << 16 |
+                   (uint32_t)data[4 * i + 2] << 8 | (uint32_t)data[4 * i + 3];
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) + rounds[i] + w[i];
+            uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+public:
+    Sha256() {
+        reset();
+    }
+
+    void reset() {
+        static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+        memcpy(state, initial, sizeof(state));
+        blockSize = 0;
+        length = 0;
+    }
+
+    void update(const unsigned char* data, size_t size) {
+        length += size;
+        if (blockSize > 0) {
+            size_t take = min(sizeof(block) - blockSize, size);
+            memcpy(block + blockSize, data, take);
+            blockSize += take;
+            data += take;
+            size -= take;
+            if (blockSize < sizeof(block)) return;
+            compress(block);
+            blockSize = 0;
+        }
+        for (; size >= sizeof(block); data += sizeof(block), size -= sizeof(block)) compress(data);
+        memcpy(block, data, size);
+        blockSize = size;
+    }
+
+    // The digest as 64 lower-case hex digits; reset() before reusing
+    string hex() {
+        uint64_t bits = length * 8;
+        unsigned char padding[72] = {0x80};
+        size_t padded = (blockSize < 56 ? 56 : 120) - blockSize;
+        for (int i = 0; i < 8; i++) padding[padded + i] = (unsigned char)(bits >> (56 - 8 * i));
+        update(padding, padded + 8);
+        char text[65];
+        for (int i = 0; i < 8; i++) snprintf(text + 8 * i, 9, "%08x", state[i]);
+        return string(text, 64);
+    }
+};
+
+// What a Submission's file holds once the store has it
+inline bool isBlobDigest(const string& text) {
+    if (text.size() != 64) return false;
+    for (char c : text) {
+        if (!isdigit((unsigned char)c) && (c < 'a' || c > 'f')) return false;
+    }
+    return true;
+}
+
+// LZ77 in the LZ4 style over one chunk: each sequence is a token (literal
+// count in the high nibble, match length - 4 in the low one, 15 meaning
+// more length bytes follow), the literals, then a 2-byte distance back to
+// the match. The last sequence has literals only. out needs room for
+// size + size / 255 + 16 bytes; returns the compressed size.
+inline size_t compressChunk(const unsigned char* in, size_t size, unsigned char* out, vector<uint32_t>& table) {
+    table.assign((size_t)1 << BLOB_HASH_BITS, 0);   // position + 1 of the last 4 bytes with that hash
+    size_t written = 0, anchor = 0, at = 0;
+    auto putLength = [&](size_t extra) {
+        for (; extra >= 255; extra -= 255) out[written++] = 255;
+        out[written++] = (unsigned char)extra;
+    };
+    auto emit = [&](size_t distance, size_t matchLength) {
+        size_t literals = at - anchor;
+        unsigned char& token = out[written++];
+        token = (unsigned char)(min<size_t>(literals, 15) << 4);
+        if (literals >= 15) putLength(literals - 15);
+        memcpy(out + written, in + anchor, literals);
+        written += literals;
+        if (matchLength == 0) return;
+        out[written++] = (unsigned char)(distance & 0xFF);
+        out[written++] = (unsigned char)(distance >> 8);
+        token |= (unsigned char)min<size_t>(matchLength - 4, 15);
+        if (matchLength - 4 >= 15) putLength(matchLength - 4 - 15);
+    };
+    while (at + 4 <= size) {
+        uint32_t sequence, previous;
+        memcpy(&sequence, in + at, 4);
+        uint32_t& slot = table[(sequence * 2654435761u) >> (32 - BLOB_HASH_BITS)];
+        size_t candidate = slot;
+        slot = (uint32_t)(at + 1);
+        if (candidate == 0 || at + 1 - candidate > 65535 ||
+            (memcpy(&previous, in + candidate - 1, 4), previous != sequence)) {
+            at++;
+            continue;
+        }
+        size_t from = candidate - 1, matchLength = 4;
+        while (at + matchLength < size && in[from + matchLength] == in[at + matchLength]) matchLength++;
+        emit(at - from, matchLength);
+        at += matchLength;
+        anchor = at;
+    }
+    at = size;
+    emit(0, 0);
+    return written;
+}
+
+// False if the input is corrupt or does not expand to exactly rawSize bytes
+inline bool decompressChunk(const unsigned char* in, size_t size, unsigned char* out, size_t rawSize) {
+    size_t read = 0, written = 0;
+    auto getLength = [&](size_t& length) {
+        unsigned char next;
+        do {
+            if (read >= size) return false;
+            next = in[read++];
+            length += next;
+        } while (next == 255);
+        return true;
+    };
+    while (read < size) {
+        unsigned char token = in[read++];
+        size_t literals = token >> 4;
+        if (literals == 15 && !getLength(literals)) return false;
+        if (literals > size - read || literals > rawSize - written) return false;
+        memcpy(out + written, in + read, literals);
+        read += literals;
+        written += literals;
+        if (read == size) break;
+        if (size - read < 2) return false;
+        size_t distance = in[read] | (size_t)in[read + 1] << 8;
+        read += 2;
+        size_t matchLength = (token & 15) + 4;
+        if ((token & 15) == 15 && !getLength(matchLength)) return false;
+        if (distance == 0 || distance > written || matchLength > rawSize - written) return false;
+        for (size_t i = 0; i < matchLength; i++, written++) out[written] = out[written - distance];
+    }
+    return written == rawSize;
+}
+
+struct BlobStats {
+    long long stored;         // new files written this session
+    long long deduplicated;   // files that were already in the store
+    long long bytesReceived;
+    long long bytesWritten;   // after compression
+};
+
+inline bool fileExists(const string& path) {
+#ifdef _WIN32
+    return _access(path.c_str(), 0) == 0;
+#else
+    struct stat info;
+    return stat(path.c_str(), &info) == 0;
+#endif
+}
+
+inline bool makeDirectory(const string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// Absolute path with ".." and (outside Windows) symlinks resolved; false if
+// the file does not exist
+inline bool resolvePath(const string& path, string& resolved) {
+#ifdef _WIN32
+    char* full = fileExists(path) ? _fullpath(nullptr, path.c_str(), 0) : nullptr;
+#else
+    char* full = realpath(path.c_str(), nullptr);
+#endif
+    if (full == nullptr) return false;
+    resolved = full;
+    free(full);
+    return true;
+}
+
+class BlobStore {
+private:
+    string directory;   // empty until open
+    atomic<bool> compressing;
+    atomic<uint64_t> nextTemp;
+    atomic<long long> stored;
+    atomic<long long> deduplicated;
+    atomic<long long> bytesReceived;
+    atomic<long long> bytesWritten;
+
+    string rawPath(const string& digest) const {
+        return directory + "/" + digest.substr(0, 2) + "/" + digest.substr(2);
+    }
+
+    string compressedPath(const string& digest) const {
+        return rawPath(digest) + ".lz";
+    }
+
+    string tempPath() {
+#ifdef _WIN32
+        long process = _getpid();
+#else
+        long process = getpid();
+#endif
+        return directory + "/incoming-" + to_string(process) + "-" + to_string(nextTemp++);
+    }
+
+    // Streams a file through SHA-256; false if it cannot be read
+    static bool hashFile(const string& path, string& digest, uint64_t& size) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (in == nullptr) return false;
+        Sha256 hasher;
+        vector<unsigned char> buffer(BLOB_CHUNK);
+        size = 0;
+        size_t got;
+        while ((got = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            hasher.update(buffer.data(), got);
+            size += got;
+        }
+        bool ok = !ferror(in);
+        fclose(in);
+        digest = hasher.hex();
+        return ok;
+    }
+
+    static long long modifiedTime(const string& path) {
+#ifdef _WIN32
+        (void)path;
+        return 0;
+#else
+        struct stat info;
+        return stat(path.c_str(), &info) == 0 ? (long long)info.st_mtime : -1;
+#endif
+    }
+
+    // Moves a finished temp file to its digest's name, unless that blob
+    // already exists
+    Status publish(const string& temp, const string& digest, const string& target, uint64_t size) {
+        if (contains(digest)) {
+            remove(temp.c_str());
+            deduplicated++;
+            metrics().count(COUNTER_FILES_DEDUPLICATED);
+            return STATUS_OK;
+        }
+        if (!makeDirectory(directory + "/" + digest.substr(0, 2)) || rename(temp.c_str(), target.c_str()) != 0) {
+            remove(temp.c_str());
+            return STATUS_FILE_ERROR;
+        }
+        stored++;
+        bytesWritten += (long long)size;
+        return STATUS_OK;
+    }
+
+    // Reads the file twice: once to hash it, so a file already stored is not
+    // copied at all, then again in the kernel copy, which cannot hash. A
+    // file that changed in between is hashed a third time from the copy.
+    Status putRaw(const string& path, string& digest) {
+        long long modified = modifiedTime(path);
+        uint64_t size;
+        if (!hashFile(path, digest, size)) return STATUS_FILE_ERROR;
+        bytesReceived += (long long)size;
+        if (contains(digest)) {
+            deduplicated++;
+            metrics().count(COUNTER_FILES_DEDUPLICATED);
+            return STATUS_OK;
+        }
+        string temp = tempPath();
+        uint64_t copied;
+        if (!copyFile(path, temp, copied, true)) {
+            remove(temp.c_str());
+            return STATUS_FILE_ERROR;
+        }
+        // Changed between the hash and the copy: name what was stored
+        if ((copied != size || modifiedTime(path) != modified) && !hashFile(temp, digest, copied)) {
+            remove(temp.c_str());
+            return STATUS_FILE_ERROR;
+        }
+        return publish(temp, digest, rawPath(digest), copied);
+    }
+
+    // Header (magic, raw size), then per chunk its raw and stored sizes and
+    // bytes; a chunk that does not shrink is stored as is
+    Status putCompressed(const string& path, string& digest) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (in == nullptr) return STATUS_FILE_ERROR;
+        string temp = tempPath();
+        FILE* out = fopen(temp.c_str(), "wb");
+        if (out == nullptr) {
+            fclose(in);
+            return STATUS_FILE_ERROR;
+        }
+        Sha256 hasher;
+        vector<unsigned char> buffer(BLOB_CHUNK);
+        vector<unsigned char> packed(BLOB_CHUNK + BLOB_CHUNK / 255 + 16);
+        vector<uint32_t> table;
+        RecordWriter header;
+        header.putU32(BLOB_MAGIC);
+        header.putU64(0);
+        bool ok = fwrite(header.bytes.data(), 1, header.bytes.size(), out) == header.bytes.size();
+        uint64_t size = 0, written = header.bytes.size();
+        size_t got;
+        while (ok && (got = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            hasher.update(buffer.data(), got);
+            size += got;
+            size_t packedSize = compressChunk(buffer.data(), got, packed.data(), table);
+            const unsigned char* chunk = packedSize < got ? packed.data() : buffer.data();
+            RecordWriter sizes;
+            sizes.putU32((uint32_t)got);
+            sizes.putU32((uint32_t)min(packedSize, got));
+            ok = fwrite(sizes.bytes.data(), 1, 8, out) == 8 &&
+                 fwrite(chunk, 1, min(packedSize, got), out) == min(packedSize, got);
+            written += 8 + min(packedSize, got);
+        }
+        ok = ok && !ferror(in);
+        fclose(in);
+        header.bytes.clear();
+        header.putU64(size);
+        ok = ok && fseek(out, 4, SEEK_SET) == 0 && fwrite(header.bytes.data(), 1, 8, out) == 8;
+        if (ok) syncFile(out);
+        ok = fclose(out) == 0 && ok;
+        bytesReceived += (long long)size;
+        if (!ok) {
+            remove(temp.c_str());
+            return STATUS_FILE_ERROR;
+        }
+        digest = hasher.hex();
+        return publish(temp, digest, compressedPath(digest), written);
+    }
+
+public:
+    BlobStore()
+        : compressing(false), nextTemp(0), stored(0), deduplicated(0), bytesReceived(0), bytesWritten(0) {}
+
+    // Creates the directory if needed; false means files cannot be stored
+    bool open(string path) {
+        if (!makeDirectory(path)) return false;
+        directory = move(path);
+        return true;
+    }
+
+    bool isOpen() const {
+        return !directory.empty();
+    }
+
+    // New files are stored compressed (files already stored are read
+    // either way). Off by default, so new files take the kernel copy.
+    void setCompression(bool enabled) {
+        compressing = enabled;
+    }
+
+    bool isCompressing() const {
+        return compressing;
+    }
+
+    // Stores the file at path and sets digest to its name in the store;
+    // STATUS_FILE_ERROR if it cannot be read or written. Thread-safe.
+    Status put(const string& path, string& digest) {
+        return compressing ? putCompressed(path, digest) : putRaw(path, digest);
+    }
+
+    bool contains(const string& digest) const {
+        return isBlobDigest(digest) && (fileExists(rawPath(digest)) || fileExists(compressedPath(digest)));
+    }
+
+    // Size of the original file, or -1 if it is not stored
+    long long sizeOf(const string& digest) const {
+        if (!isBlobDigest(digest)) return -1;
+        long long size = -1;
+        if (FILE* in = fopen(rawPath(digest).c_str(), "rb")) {
+            if (fseek(in, 0, SEEK_END) == 0) size = ftell(in);
+            fclose(in);
+        } else if (FILE* in = fopen(compressedPath(digest).c_str(), "rb")) {
+            char header[12];
+            if (fread(header, 1, sizeof(header), in) == sizeof(header)) {
+                RecordReader reader(header, sizeof(header));
+                if (reader.getU32() == BLOB_MAGIC) size = (long long)reader.getU64();
+            }
+            fclose(in);
+        }
+        return size;
+    }
+
+    // Calls visit(data, size) over the stored file's contents in order;
+    // false if it is not stored or is corrupt
+    template <typename Visit>
+    bool read(const string& digest, Visit visit) const {
+        if (!isBlobDigest(digest)) return false;
+        vector<unsigned char> buffer(BLOB_CHUNK);
+        size_t got;
+        if (FILE* in = fopen(rawPath(digest).c_str(), "rb")) {
+            while ((got = fread(buffer.data(), 1, buffer.size(), in)) > 0) visit(buffer.data(), got);
+            bool ok = !ferror(in);
+            fclose(in);
+            return ok;
+        }
+        FILE* in = fopen(compressedPath(digest).c_str(), "rb");
+        if (in == nullptr) return false;
+        vector<unsigned char> packed;
+        char header[12];
+        bool ok = fread(header, 1, sizeof(header), in) == sizeof(header);
+        RecordReader start(header, sizeof(header));
+        ok = ok && start.getU32() == BLOB_MAGIC;
+        uint64_t remaining = ok ? start.getU64() : 0;
+        while (ok && remaining > 0) {
+            char sizes[8];
+            ok = fread(sizes, 1, sizeof(sizes), in) == sizeof(sizes);
+            RecordReader reader(sizes, sizeof(sizes));
+            uint32_t rawSize = reader.getU32(), storedSize = reader.getU32();
+            ok = ok && rawSize > 0 && rawSize <= BLOB_CHUNK && rawSize <= remaining && storedSize <= rawSize;
+            if (!ok) break;
+            packed.resize(storedSize);
+            ok = fread(packed.data(), 1, storedSize, in) == storedSize;
+            if (ok && storedSize == rawSize) memcpy(buffer.data(), packed.data(), rawSize);
+            else ok = ok && decompressChunk(packed.data(), storedSize, buffer.data(), rawSize);
+            if (ok) visit(buffer.data(), (size_t)rawSize);
+            remaining -= rawSize;
+        }
+        fclose(in);
+        return ok;
+    }
+
+    // Writes the stored file to destination. An uncompressed blob is copied
+    // in the kernel; STATUS_NOT_FOUND if the digest is not stored.
+    Status checkout(const string& digest, const string& destination) const {
+        if (!contains(digest)) return STATUS_NOT_FOUND;
+        uint64_t copied;
+        if (fileExists(rawPath(digest)))
+            return copyFile(rawPath(digest), destination, copied, false) ? STATUS_OK : STATUS_FILE_ERROR;
+        FILE* out = fopen(destination.c_str(), "wb");
+        if (out == nullptr) return STATUS_FILE_ERROR;
+        bool written = true;
+        bool ok = read(digest, [&](const unsigned char* data, size_t size) {
+            written = written && fwrite(data, 1, size, out) == size;
+        });
+        ok = fclose(out) == 0 && ok && written;
+        return ok ? STATUS_OK : STATUS_FILE_ERROR;
+    }
+
+    // Copies one file to another, without passing the bytes through user
+    // space where the platform allows: copy_file_range (which may share
+    // the extents on filesystems with reflinks), then sendfile, then plain
+    // reads and writes for whatever is left. durable fsyncs the copy.
+    static bool copyFile(const string& from, const string& to, uint64_t& copied, bool durable) {
+        copied = 0;
+#ifdef _WIN32
+        FILE* in = fopen(from.c_str(), "rb");
+        if (in == nullptr) return false;
+        FILE* out = fopen(to.c_str(), "wb");
+        if (out == nullptr) {
+            fclose(in);
+            return false;
+        }
+        vector<char> buffer(BLOB_CHUNK);
+        size_t got;
+        bool ok = true;
+        while (ok && (got = fread(buffer.data(), 1, buffer.size(), in)) > 0) {
+            ok = fwrite(buffer.data(), 1, got, out) == got;
+            copied += got;
+        }
+        ok = ok && !ferror(in);
+        if (ok && durable) syncFile(out);
+        fclose(in);
+        return fclose(out) == 0 && ok;
+#else
+        int in = ::open(from.c_str(), O_RDONLY);
+        if (in < 0) return false;
+        int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            ::close(in);
+            return false;
+        }
+        bool done = false, ok = true;
+#ifdef __linux__
+        // Both calls advance the file offsets, so each fallback resumes
+        // where the previous one stopped
+        for (bool kernel = true; kernel && !done;) {
+            ssize_t moved = copy_file_range(in, nullptr, out, nullptr, BLOB_CHUNK * 16, 0);
+            if (moved > 0) copied += moved;
+            else if (moved == 0) done = true;
+            else if (errno != EINTR) kernel = false;   // EXDEV, ENOSYS, EINVAL...
+        }
+        for (bool kernel = true; kernel && !done;) {
+            ssize_t moved = sendfile(out, in, nullptr, BLOB_CHUNK * 16);
+            if (moved > 0) copied += moved;
+            else if (moved == 0) done = true;
+            else if (errno != EINTR) kernel = false;
+        }
+#endif
+        vector<char> buffer(done ? 0 : BLOB_CHUNK);
+        while (!done && ok) {
+            ssize_t got = ::read(in, buffer.data(), buffer.size());
+            if (got == 0) done = true;
+            else if (got < 0) ok = errno == EINTR;
+            else {
+                for (ssize_t sent = 0; ok && sent < got;) {
+                    ssize_t put = ::write(out, buffer.data() + sent, got - sent);
+                    if (put > 0) sent += put;
+                    else ok = put < 0 && errno == EINTR;
+                }
+                copied += got;
+            }
+        }
+        if (ok && durable) ok = fsync(out) == 0;
+        ::close(in);
+        return ::close(out) == 0 && ok;
+#endif
+    }
+
+    BlobStats stats() const {
+        return BlobStats{stored.load(), deduplicated.load(), bytesReceived.load(), bytesWritten.load()};
+    }
+};
+
+#endif
@@ -0,0 +1,729 @@
+// Shared records, status codes, the slab allocator, latency metrics and
+// the symbol table that every other subsystem builds on.
+#ifndef ELEARNING_CORE_H
+#define ELEARNING_CORE_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <new>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <algorithm>
+#include <climits>
+#include <cctype>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
+#include <queue>
+#include <deque>
+#include <map>
+#include <functional>
+#include <cmath>
+#include <memory>
+#include <cerrno>
+#include <ctime>
+#ifdef _WIN32
+#include <io.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+using namespace std;
+
+// ============== STRUCTURES ==============
+
+enum Status {
+    STATUS_OK,
+    STATUS_NOT_FOUND,
+    STATUS_DUPLICATE,
+    STATUS_ALREADY_GRADED,
+    STATUS_INVALID,
+    STATUS_EMPTY,
+    STATUS_DENIED,
+    STATUS_NOT_GRADED,
+    STATUS_FILE_ERROR,
+    STATUS_FULL
+};
+
+inline string statusMessage(Status status) {
+    switch (status) {
+        case STATUS_OK: return "OK";
+        case STATUS_NOT_FOUND: return "Not found";
+        case STATUS_DUPLICATE: return "Already exists";
+        case STATUS_ALREADY_GRADED: return "Already graded";
+        case STATUS_INVALID: return "Invalid input";
+        case STATUS_EMPTY: return "Nothing to do";
+        case STATUS_DENIED: return "Not allowed for this user";
+        case STATUS_NOT_GRADED: return "Not graded yet";
+        case STATUS_FILE_ERROR: return "File could not be read or stored";
+        case STATUS_FULL: return "Too many distinct names and IDs";
+    }
+    return "Unknown status";
+}
+
+// Fields a lecturer supplies; the ID is generated
+struct AssignmentSpec {
+    string title;
+    string description;
+    string dueDate;   // YYYY-MM-DD
+    int maxScore;
+};
+
+inline bool isValidDate(const string& text) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    for (int i = 0; i < 10; i++) {
+        if (i != 4 && i != 7 && !isdigit((unsigned char)text[i])) return false;
+    }
+    int year = stoi(text.substr(0, 4));
+    int month = (text[5] - '0') * 10 + (text[6] - '0');
+    int day = (text[8] - '0') * 10 + (text[9] - '0');
+    if (month < 1 || month > 12 || day < 1) return false;
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return day <= monthDays[month - 1] + (month == 2 && leap);
+}
+
+// "2025-01-20" -> days since 1970-01-01, so due dates compare and add as
+// plain integers (proleptic Gregorian calendar)
+inline int dayNumber(string_view date) {
+    auto digits = [&](int from, int count) {
+        int value = 0;
+        for (int i = from; i < from + count && i < (int)date.size(); i++) value = value * 10 + (date[i] - '0');
+        return value;
+    };
+    int year = digits(0, 4), month = digits(5, 2), day = digits(8, 2);
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Inverse of dayNumber
+inline string formatDay(int days) {
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shifted = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * shifted + 2) / 5 + 1;
+    int month = shifted < 10 ? shifted + 3 : shifted - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+    char text[32];
+    snprintf(text, sizeof(text), "%04d-%02d-%02d", year, month, day);
+    return text;
+}
+
+// Local time as "YYYY-MM-DD HH:MM", stamped on new submissions. The text
+// is cached per thread for the current minute, since localtime takes a lock.
+inline string currentTimestamp() {
+    thread_local time_t cachedMinute = -1;
+    thread_local string cached;
+    time_t now = time(nullptr);
+    if (now / 60 != cachedMinute) {
+        tm local;
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        char text[32];
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M", &local);
+        cached = text;
+        cachedMinute = now / 60;
+    }
+    return cached;
+}
+
+// "Today" for the due-date views and lateness
+inline string currentDate() {
+    return currentTimestamp().substr(0, 10);
+}
+
+struct Assignment {
+    string assignmentID;
+    string title;
+    string dueDate;
+    string description;
+    int maxScore;
+    int dueDay;         // dayNumber(dueDate), parsed once
+    uint32_t listOrder; // link order; breaks ties between equal due dates
+    Assignment* next;   // due-date list neighbours
+    Assignment* prev;
+};
+
+// 1001 for "ASSG1001"; 0 if the ID is not ASSG followed by digits, as
+// imported IDs may be anything
+inline int assignmentNumber(const string& id) {
+    if (id.size() < 5 || id.size() > 13 || id.compare(0, 4, "ASSG") != 0) return 0;
+    for (size_t i = 4; i < id.size(); i++) {
+        if (!isdigit((unsigned char)id[i])) return 0;
+    }
+    long number = strtol(id.c_str() + 4, nullptr, 10);
+    return number > INT_MAX ? 0 : (int)number;
+}
+
+// Interned string handle; see SymbolTable
+typedef uint32_t Symbol;
+
+// What intern() returns once the symbol table is full; reads as ""
+const Symbol NO_SYMBOL = UINT32_MAX;
+
+enum SubmissionStatus : uint8_t {
+    SUBMISSION_PENDING,
+    SUBMISSION_GRADED
+};
+
+inline const char* statusName(SubmissionStatus status) {
+    return status == SUBMISSION_GRADED ? "Graded" : "Pending";
+}
+
+// "SUB10001" is stored as 10001
+inline string formatSubmissionID(uint32_t number) {
+    return "SUB" + to_string(number);
+}
+
+// 0 if the text is not SUB followed by digits
+inline uint32_t parseSubmissionID(string_view text) {
+    if (text.size() < 4 || text.size() > 13 || text.substr(0, 3) != "SUB") return 0;
+    uint64_t number = 0;
+    for (char c : text.substr(3)) {
+        if (!isdigit((unsigned char)c)) return 0;
+        number = number * 10 + (c - '0');
+    }
+    return number > UINT32_MAX ? 0 : (uint32_t)number;
+}
+
+struct Submission {
+    uint32_t submissionID;
+    Symbol studentID;
+    Symbol studentName;
+    Symbol assignmentID;
+    Symbol assignmentTitle;
+    string submittedDate;  // owned: dates and feedback rarely repeat, so they are not interned
+    string feedback;
+    uint32_t row;        // position in SubmissionColumns: snapshot index, then queue order
+    SubmissionStatus status;
+    int score;
+    string file;         // blob digest (see BlobStore), or a path logged before files were stored
+    Submission* next;
+};
+
+// One submission's grade change in a regrade: the new score and feedback,
+// and the ones they replaced once applied, so the change can be undone
+struct RegradeEntry {
+    uint32_t submissionID;
+    int previousScore;
+    int score;
+    string previousFeedback;
+    string feedback;
+};
+
+struct Student {
+    string studentID;
+    string name;
+    string email;
+    int totalScore;
+    int submissionCount;
+};
+
+// ============== OBJECT POOL (Slab Allocator) ==============
+struct PoolStats {
+    long long allocations;  // total allocate() calls
+    long long reused;       // allocations served from the free list
+    long long releases;
+    long long live;
+    long long slabs;
+    long long bytesReserved;
+};
+
+// Hands out objects from contiguous slabs. Released objects go on a free
+// list for O(1) reuse; every slab is returned at once when the pool dies.
+template <typename T, int SLAB_SIZE = 256>
+class ObjectPool {
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];  // must stay first
+        Slot* nextFree;
+        bool live;
+    };
+
+    vector<Slot*> slabs;
+    int usedInSlab;
+    Slot* freeList;
+    PoolStats stats;
+
+public:
+    ObjectPool() : usedInSlab(SLAB_SIZE), freeList(nullptr), stats{0, 0, 0, 0, 0, 0} {}
+
+    T* allocate() {
+        Slot* slot;
+        if (freeList != nullptr) {
+            slot = freeList;
+            freeList = slot->nextFree;
+            stats.reused++;
+        } else {
+            if (usedInSlab == SLAB_SIZE) {
+                slabs.push_back(new Slot[SLAB_SIZE]);
+                usedInSlab = 0;
+                stats.slabs++;
+                stats.bytesReserved += sizeof(Slot) * SLAB_SIZE;
+            }
+            slot = &slabs.back()[usedInSlab++];
+        }
+
+        T* object = new (slot->storage) T();
+        slot->live = true;
+        stats.allocations++;
+        stats.live++;
+        return object;
+    }
+
+    void release(T* object) {
+        if (object == nullptr) return;
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        object->~T();
+        slot->live = false;
+        slot->nextFree = freeList;
+        freeList = slot;
+        stats.releases++;
+        stats.live--;
+    }
+
+    // Destroys every live object with one sequential pass per slab
+    void clear() {
+        for (size_t i = 0; i < slabs.size(); i++) {
+            int used = (i + 1 == slabs.size()) ? usedInSlab : SLAB_SIZE;
+            for (int j = 0; j < used; j++) {
+                if (slabs[i][j].live)
+                    reinterpret_cast<T*>(slabs[i][j].storage)->~T();
+            }
+            delete[] slabs[i];
+        }
+        slabs.clear();
+        usedInSlab = SLAB_SIZE;
+        freeList = nullptr;
+        stats.live = 0;
+        stats.slabs = 0;
+        stats.bytesReserved = 0;
+    }
+
+    PoolStats getStats() {
+        return stats;
+    }
+
+    ~ObjectPool() {
+        clear();
+    }
+};
+
+// ============== METRICS (Latency Histograms) ==============
+// Hot paths record how long they took into log-linear histograms (the HDR
+// layout: 8 linear buckets per power of two, so a bucket's bounds are within
+// 12.5% of any value in it). Each thread writes only its own shard, with
+// relaxed loads and stores and no shared cache lines, and readers merge the
+// shards. A timed operation costs two clock reads and two adds, so this can
+// stay on in production; setEnabled(false) skips even the clock reads.
+enum Metric : uint8_t {
+    METRIC_SUBMIT,             // queue a submission
+    METRIC_INTAKE,             // concurrent submission intake
+    METRIC_STORE_FILE,         // hash and store a submitted file
+    METRIC_DUPLICATE_CHECK,
+    METRIC_GRADE,
+    METRIC_REGRADE,            // one regrade, or a whole batch
+    METRIC_TITLE_SEARCH,       // B+ tree and snapshot title lookups
+    METRIC_TEXT_SEARCH,        // ranked keyword searches
+    METRIC_CREATE_ASSIGNMENT,
+    METRIC_UNDO,
+    METRIC_REDO,
+    METRIC_RANKING_PAGE,       // a range of the leaderboard
+    METRIC_LOG_SYNC,           // fsync of the write-ahead log
+    METRIC_CHECKPOINT,
+    METRIC_REQUEST,            // one socket server request
+    METRIC_COUNT
+};
+
+inline const char* metricName(Metric metric) {
+    switch (metric) {
+        case METRIC_SUBMIT: return "submit";
+        case METRIC_INTAKE: return "submit_concurrent";
+        case METRIC_STORE_FILE: return "store_file";
+        case METRIC_DUPLICATE_CHECK: return "duplicate_check";
+        case METRIC_GRADE: return "grade";
+        case METRIC_REGRADE: return "regrade";
+        case METRIC_TITLE_SEARCH: return "title_search";
+        case METRIC_TEXT_SEARCH: return "text_search";
+        case METRIC_CREATE_ASSIGNMENT: return "create_assignment";
+        case METRIC_UNDO: return "undo";
+        case METRIC_REDO: return "redo";
+        case METRIC_RANKING_PAGE: return "ranking_page";
+        case METRIC_LOG_SYNC: return "log_sync";
+        case METRIC_CHECKPOINT: return "checkpoint";
+        case METRIC_REQUEST: return "server_request";
+        default: return "unknown";
+    }
+}
+
+enum MetricCounter : uint8_t {
+    COUNTER_LOG_RECORDS,
+    COUNTER_DUPLICATES_REJECTED,
+    COUNTER_FILES_DEDUPLICATED,
+    COUNTER_COUNT
+};
+
+inline const char* counterName(MetricCounter counter) {
+    switch (counter) {
+        case COUNTER_LOG_RECORDS: return "log_records";
+        case COUNTER_DUPLICATES_REJECTED: return "duplicates_rejected";
+        case COUNTER_FILES_DEDUPLICATED: return "files_deduplicated";
+        default: return "unknown";
+    }
+}
+
+const int HISTOGRAM_SUB_BITS = 3;
+const int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BITS;
+const int HISTOGRAM_MAX_EXPONENT = 40;  // 2^41 ns is about 36 minutes; longer is clamped
+const int HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BITS + 2) * HISTOGRAM_SUB_BUCKETS;
+
+inline int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+#endif
+}
+
+// A merged histogram of nanosecond latencies
+struct LatencyHistogram {
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t buckets[HISTOGRAM_BUCKETS] = {};
+
+    // Values below 8 get a bucket each; above, 8 buckets per power of two
+    static int bucketOf(uint64_t ns) {
+        if (ns < (uint64_t)HISTOGRAM_SUB_BUCKETS) return (int)ns;
+        int exponent = highestBit(ns);
+        if (exponent > HISTOGRAM_MAX_EXPONENT) return HISTOGRAM_BUCKETS - 1;
+        int sub = (int)(ns >> (exponent - HISTOGRAM_SUB_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+        return (exponent - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS + sub;
+    }
+
+    // Smallest value in the bucket
+    static uint64_t bucketFloor(int bucket) {
+        if (bucket < HISTOGRAM_SUB_BUCKETS) return (uint64_t)bucket;
+        int exponent = bucket / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BITS - 1;
+        uint64_t sub = (uint64_t)(bucket % HISTOGRAM_SUB_BUCKETS);
+        return (HISTOGRAM_SUB_BUCKETS + sub) << (exponent - HISTOGRAM_SUB_BITS);
+    }
+
+    // Largest value in the bucket
+    static uint64_t bucketCeiling(int bucket) {
+        return bucket + 1 < HISTOGRAM_BUCKETS ? bucketFloor(bucket + 1) - 1 : UINT64_MAX;
+    }
+
+    double meanNs() const {
+        return count ? (double)totalNs / count : 0;
+    }
+
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1); 0 if empty
+    uint64_t percentileNs(double q) const {
+        uint64_t rank = (uint64_t)ceil(q * count);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) return bucketCeiling(i);
+        }
+        return 0;
+    }
+
+    uint64_t maxNs() const {
+        for (int i = HISTOGRAM_BUCKETS; i-- > 0;)
+            if (buckets[i]) return bucketCeiling(i);
+        return 0;
+    }
+
+    // Values below ns; exact when ns is a bucket boundary, e.g. a power of two
+    uint64_t countBelow(uint64_t ns) const {
+        uint64_t below = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS && bucketFloor(i) < ns; i++)
+            below += buckets[i];
+        return below;
+    }
+};
+
+// One thread's histograms and counters; written by that thread only
+struct alignas(64) MetricShard {
+    atomic<uint64_t> buckets[METRIC_COUNT][HISTOGRAM_BUCKETS];
+    atomic<uint64_t> totalNs[METRIC_COUNT];
+    atomic<uint64_t> counters[COUNTER_COUNT];
+
+    MetricShard() {
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            for (int i = 0; i < HISTOGRAM_BUCKETS; i++) buckets[m][i].store(0, memory_order_relaxed);
+            totalNs[m].store(0, memory_order_relaxed);
+        }
+        for (int c = 0; c < COUNTER_COUNT; c++) counters[c].store(0, memory_order_relaxed);
+    }
+};
+
+class MetricsRegistry {
+private:
+    mutex shardLock;
+    vector<unique_ptr<MetricShard>> shards;  // kept after their thread exits
+    atomic<bool> enabled;
+
+    // The calling thread's shard, registered on first use
+    MetricShard& local() {
+        thread_local MetricShard* shard = nullptr;
+        if (shard == nullptr) {
+            lock_guard<mutex> guard(shardLock);
+            shards.push_back(unique_ptr<MetricShard>(new MetricShard()));
+            shard = shards.back().get();
+        }
+        return *shard;
+    }
+
+    // Only the owning thread writes a cell, so no read-modify-write is needed
+    static void add(atomic<uint64_t>& cell, uint64_t amount) {
+        cell.store(cell.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+
+public:
+    MetricsRegistry() : enabled(true) {}
+
+    bool isEnabled() const {
+        return enabled.load(memory_order_relaxed);
+    }
+
+    void setEnabled(bool on) {
+        enabled.store(on, memory_order_relaxed);
+    }
+
+    void record(Metric metric, uint64_t ns) {
+        MetricShard& shard = local();
+        add(shard.buckets[metric][LatencyHistogram::bucketOf(ns)], 1);
+        add(shard.totalNs[metric], ns);
+    }
+
+    void count(MetricCounter counter, uint64_t amount = 1) {
+        if (isEnabled()) add(local().counters[counter], amount);
+    }
+
+    // Every thread's samples so far, merged
+    LatencyHistogram histogram(Metric metric) {
+        LatencyHistogram merged;
+        lock_guard<mutex> guard(shardLock);
+        for (const unique_ptr<MetricShard>& shard : shards) {
+            for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+                uint64_t n = shard->buckets[metric][i].load(memory_order_relaxed);
+                merged.buckets[i] += n;
+                merged.count += n;
+            }
+            merged.totalNs += shard->totalNs[metric].load(memory_order_relaxed);
+        }
+        return merged;
+    }
+
+    uint64_t counter(MetricCounter counter) {
+        uint64_t total = 0;
+        lock_guard<mutex> guard(shardLock);
+        for (const unique_ptr<MetricShard>& shard : shards)
+            total += shard->counters[counter].load(memory_order_relaxed);
+        return total;
+    }
+};
+
+inline MetricsRegistry& metrics() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+// Times its scope into a histogram
+class MetricTimer {
+private:
+    Metric metric;
+    bool active;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit MetricTimer(Metric metric) : metric(metric), active(metrics().isEnabled()) {
+        if (active) start = chrono::steady_clock::now();
+    }
+
+    ~MetricTimer() {
+        if (!active) return;
+        auto elapsed = chrono::steady_clock::now() - start;
+        metrics().record(metric, (uint64_t)chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+// Prometheus text format for every histogram and counter. Histogram
+// buckets are cumulative at powers of two from 256 ns, which fall on
+// bucket boundaries, so the counts are exact.
+inline void appendPrometheusMetrics(string& out) {
+    char line[256];
+    out += "# HELP elearning_operation_duration_seconds Latency of instrumented operations.\n";
+    out += "# TYPE elearning_operation_duration_seconds histogram\n";
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        const char* name = metricName((Metric)m);
+        LatencyHistogram histogram = metrics().histogram((Metric)m);
+        for (int exponent = 8; exponent <= HISTOGRAM_MAX_EXPONENT; exponent++) {
+            uint64_t bound = (uint64_t)1 << exponent;
+            snprintf(line, sizeof(line), "elearning_operation_duration_seconds_bucket{op=\"%s\",le=\"%.9g\"} %llu\n",
+                     name, bound / 1e9, (unsigned long long)histogram.countBelow(bound));
+            out += line;
+        }
+        snprintf(line, sizeof(line), "elearning_operation_duration_seconds_bucket{op=\"%s\",le=\"+Inf\"} %llu\n"
+                 "elearning_operation_duration_seconds_sum{op=\"%s\"} %.9g\n"
+                 "elearning_operation_duration_seconds_count{op=\"%s\"} %llu\n",
+                 name, (unsigned long long)histogram.count, name, histogram.totalNs / 1e9,
+                 name, (unsigned long long)histogram.count);
+        out += line;
+    }
+    out += "# HELP elearning_events_total Counted events.\n";
+    out += "# TYPE elearning_events_total counter\n";
+    for (int c = 0; c < COUNTER_COUNT; c++) {
+        snprintf(line, sizeof(line), "elearning_events_total{event=\"%s\"} %llu\n",
+                 counterName((MetricCounter)c), (unsigned long long)metrics().counter((MetricCounter)c));
+        out += line;
+    }
+}
+
+// Pool gauges in Prometheus text, one group of pools per course; a group
+// with an empty course name is written without a course label
+inline void appendPoolMetrics(string& out, const vector<pair<string, vector<pair<string, PoolStats>>>>& groups) {
+    struct PoolMetric { const char* name; const char* type; const char* help; };
+    const PoolMetric poolMetrics[] = {
+        {"elearning_pool_live_objects", "gauge", "Objects currently allocated from the pool."},
+        {"elearning_pool_reserved_bytes", "gauge", "Bytes reserved by the pool's slabs."},
+        {"elearning_pool_allocations_total", "counter", "Allocations since startup."}
+    };
+    char line[192];
+    for (int m = 0; m < 3; m++) {
+        out += string("# HELP ") + poolMetrics[m].name + " " + poolMetrics[m].help + "\n";
+        out += string("# TYPE ") + poolMetrics[m].name + " " + poolMetrics[m].type + "\n";
+        for (auto& group : groups) {
+            string course = group.first.empty() ? "" : "course=\"" + group.first + "\",";
+            for (auto& entry : group.second) {
+                const PoolStats& pool = entry.second;
+                long long value = m == 0 ? pool.live : m == 1 ? pool.bytesReserved : pool.allocations;
+                snprintf(line, sizeof(line), "%s{%spool=\"%s\"} %lld\n", poolMetrics[m].name,
+                         course.c_str(), entry.first.c_str(), value);
+                out += line;
+            }
+        }
+    }
+}
+
+// ============== SYMBOL TABLE (String Interning) ==============
+// Names, titles and IDs repeat across many submissions, so each distinct
+// string is stored once and records hold its 32-bit Symbol. Strings are
+// never released, so only such low-cardinality keys are interned; feedback
+// and dates stay owned strings. Symbol 0 is the empty string. Reading a
+// symbol's text is lock-free; strings never move once interned.
+class SymbolTable {
+private:
+    static const uint32_t CHUNK_BITS = 12;
+    static const uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+    static const uint32_t MAX_CHUNKS = 1u << 14;
+    static const uint32_t MAX_SYMBOLS = MAX_CHUNKS << CHUNK_BITS;  // 64M distinct strings
+
+    atomic<string*> chunks[MAX_CHUNKS];
+    shared_mutex lock;                        // guards index and count
+    unordered_map<string_view, Symbol> index; // views into the chunks
+    uint32_t count;
+
+public:
+    SymbolTable() : count(0) {
+        for (uint32_t i = 0; i < MAX_CHUNKS; i++)
+            chunks[i].store(nullptr, memory_order_relaxed);
+        intern("");
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // NO_SYMBOL if the text is new and the table is full
+    Symbol intern(string_view text) {
+        {
+            shared_lock<shared_mutex> reading(lock);
+            auto it = index.find(text);
+            if (it != index.end()) return it->second;
+        }
+        unique_lock<shared_mutex> writing(lock);
+        auto it = index.find(text);
+        if (it != index.end()) return it->second;
+        if (count == MAX_SYMBOLS) return NO_SYMBOL;
+
+        Symbol symbol = count++;
+        string* chunk = chunks[symbol >> CHUNK_BITS].load(memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new string[CHUNK_SIZE];
+            chunks[symbol >> CHUNK_BITS].store(chunk, memory_order_release);
+        }
+        string& slot = chunk[symbol & (CHUNK_SIZE - 1)];
+        slot = string(text);
+        index.emplace(string_view(slot), symbol);
+        return symbol;
+    }
+
+    // Looks a string up without adding it; false if it was never interned
+    bool find(string_view text, Symbol& symbol) {
+        shared_lock<shared_mutex> reading(lock);
+        auto it = index.find(text);
+        if (it == index.end()) return false;
+        symbol = it->second;
+        return true;
+    }
+
+    const string& text(Symbol symbol) const {
+        if (symbol == NO_SYMBOL) symbol = 0;
+        return chunks[symbol >> CHUNK_BITS].load(memory_order_acquire)[symbol & (CHUNK_SIZE - 1)];
+    }
+
+    // One "allocation" per interned string; chunks are the slabs
+    PoolStats memoryStats() {
+        shared_lock<shared_mutex> reading(lock);
+        long long chunkCount = (count + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        return PoolStats{count, 0, 0, count, chunkCount,
+                         chunkCount * CHUNK_SIZE * (long long)sizeof(string)};
+    }
+
+    ~SymbolTable() {
+        for (uint32_t i = 0; i < MAX_CHUNKS; i++)
+            delete[] chunks[i].load(memory_order_relaxed);
+    }
+};
+
+// Shared by every container in the process, so one symbol means the same
+// string everywhere
+inline SymbolTable& symbols() {
+    static SymbolTable table;
+    return table;
+}
+
+inline Symbol intern(string_view text) {
+    return symbols().intern(text);
+}
+
+inline const string& symbolText(Symbol symbol) {
+    return symbols().text(symbol);
+}
+
+#endif
@@ -0,0 +1,342 @@
+// Undo/redo over assignment and grading changes.
+#ifndef ELEARNING_HISTORY_H
+#define ELEARNING_HISTORY_H
+
+#include "submissions.h"
+
+// ============== CHANGE HISTORY (Undo/Redo) ==============
+const size_t HISTORY_LIMIT = 100;   // oldest changes are forgotten beyond this
+
+enum ChangeType : uint8_t {
+    CHANGE_CREATE,
+    CHANGE_EDIT,
+    CHANGE_DELETE,
+    CHANGE_GRADE,
+    CHANGE_REGRADE
+};
+
+inline const char* changeName(ChangeType type) {
+    switch (type) {
+        case CHANGE_CREATE: return "Create";
+        case CHANGE_EDIT: return "Edit";
+        case CHANGE_DELETE: return "Delete";
+        case CHANGE_GRADE: return "Grade";
+        case CHANGE_REGRADE: return "Regrade";
+    }
+    return "Unknown";
+}
+
+// An assignment change swaps `removed` out of the list and `added` in;
+// undo swaps them back. A grade change records what redo re-applies; a
+// regrade keeps the old and new grade of every submission it changed.
+struct Change {
+    ChangeType type;
+    string assignmentID;
+    string title;               // for display
+    AssignmentVersion removed;
+    AssignmentVersion added;
+    uint32_t submissionID;      // grades only; a regrade's first submission
+    int score;
+    string feedback;
+    vector<RegradeEntry> regrades;
+};
+
+// Bounded undo/redo over assignment changes and grades. changes[0, applied)
+// are in effect, the rest can be redone. Versions hold direct handles, so
+// undo and redo are O(1) apart from the title index. An applied change
+// owns the version it removed and a reverted one the version it added;
+// that version is freed when the change is dropped.
+class ChangeHistory {
+private:
+    AssignmentLinkedList& assignments;
+    SubmissionQueue& submissions;
+    WriteAheadLog* log;
+    deque<Change> changes;
+    size_t applied;
+
+    void record(Change change) {
+        while (changes.size() > applied) {
+            assignments.releaseVersion(changes.back().added);
+            changes.pop_back();
+        }
+        changes.push_back(move(change));
+        applied++;
+        if (changes.size() > HISTORY_LIMIT) {
+            assignments.releaseVersion(changes.front().removed);
+            changes.pop_front();
+            applied--;
+        }
+    }
+
+    void revert(Change& change) {
+        if (change.type == CHANGE_GRADE) {
+            submissions.ungrade(formatSubmissionID(change.submissionID));
+            return;
+        }
+        if (change.type == CHANGE_REGRADE) {
+            submissions.restoreRegrades(change.regrades, true);
+            return;
+        }
+        assignments.retire(change.added);
+        assignments.restore(change.removed);
+        publishVisibility(change, true);
+    }
+
+    void reapply(Change& change) {
+        if (change.type == CHANGE_GRADE) {
+            submissions.restoreGrade(formatSubmissionID(change.submissionID), change.score, change.feedback);
+            return;
+        }
+        if (change.type == CHANGE_REGRADE) {
+            submissions.restoreRegrades(change.regrades, false);
+            return;
+        }
+        assignments.retire(change.removed);
+        assignments.restore(change.added);
+        publishVisibility(change, false);
+    }
+
+    // Deleting and creating change which assignments exist; edits do not
+    void publishVisibility(const Change& change, bool reverted) {
+        if (change.type == CHANGE_DELETE || change.type == CHANGE_CREATE) {
+            bool removed = (change.type == CHANGE_DELETE) != reverted;
+            if (removed) submissions.assignmentRemoved(change.assignmentID);
+            else submissions.assignmentRestored(change.assignmentID);
+        }
+    }
+
+    // Saved versions: 0 none, 1 the visible version of the ID (it is in the
+    // snapshot saved alongside), 2 a retired one, written out in full
+    void saveVersion(RecordWriter& out, const AssignmentVersion& version,
+                     map<pair<const Assignment*, long>, uint32_t>& retired) {
+        if (version.isEmpty()) {
+            out.putU8(0);
+        } else if (assignments.isVisible(version)) {
+            out.putU8(1);
+        } else {
+            out.putU8(2);
+            // Edit chains share versions; write each one once
+            pair<const Assignment*, long> key(version.node, version.baseIndex);
+            auto it = retired.find(key);
+            if (it != retired.end()) {
+                out.putU32(it->second);
+                return;
+            }
+            uint32_t slot = (uint32_t)retired.size();
+            retired.emplace(key, slot);
+            out.putU32(slot);
+            Assignment fields = assignments.versionFields(version);
+            out.putString(fields.title);
+            out.putString(fields.description);
+            out.putString(fields.dueDate);
+            out.putInt(fields.maxScore);
+        }
+    }
+
+    AssignmentVersion loadVersion(RecordReader& in, const string& assignmentID,
+                                  vector<AssignmentVersion>& retired) {
+        uint8_t kind = in.getU8();
+        if (kind == 1) return assignments.findVersion(assignmentID);
+        if (kind != 2) return noVersion();
+        uint32_t slot = in.getU32();
+        if (slot < retired.size()) return retired[slot];
+        Assignment fields;
+        fields.assignmentID = assignmentID;
+        fields.title = in.getString();
+        fields.description = in.getString();
+        fields.dueDate = in.getString();
+        fields.maxScore = in.getInt();
+        retired.push_back(assignments.detachedVersion(fields));
+        return retired.back();
+    }
+
+public:
+    ChangeHistory(AssignmentLinkedList& assignments, SubmissionQueue& submissions)
+        : assignments(assignments), submissions(submissions), log(nullptr), applied(0) {}
+
+    void attachLog(WriteAheadLog* wal) {
+        log = wal;
+    }
+
+    Status createAssignment(const AssignmentSpec& spec, Assignment** created = nullptr) {
+        Assignment* newAssg = nullptr;
+        Status status = assignments.createAssignment(spec, &newAssg);
+        if (status != STATUS_OK) return status;
+        recordCreation(newAssg);
+        if (created) *created = newAssg;
+        return STATUS_OK;
+    }
+
+    Status editAssignment(const string& id, const AssignmentSpec& spec) {
+        Change change{CHANGE_EDIT, id, spec.title, noVersion(), noVersion(), 0, 0, "", {}};
+        Status status = assignments.editAssignment(id, spec, &change.removed, &change.added);
+        if (status == STATUS_OK) record(move(change));
+        return status;
+    }
+
+    Status deleteAssignment(const string& id) {
+        string title;
+        if (!assignments.findTitle(id, title)) return STATUS_NOT_FOUND;
+        Change change{CHANGE_DELETE, id, title, noVersion(), noVersion(), 0, 0, "", {}};
+        Status status = assignments.deleteAssignment(id, &change.removed);
+        if (status == STATUS_OK) {
+            publishVisibility(change, false);
+            record(move(change));
+        }
+        return status;
+    }
+
+    Status grade(string submissionID, int score, string feedback) {
+        Status status = submissions.grade(submissionID, score, feedback);
+        if (status == STATUS_OK) recordGrade(submissionID);
+        return status;
+    }
+
+    Status regrade(string submissionID, int score, string feedback) {
+        RegradeEntry entry;
+        Status status = submissions.regrade(submissionID, score, feedback, &entry);
+        if (status == STATUS_OK) recordRegrade({entry});
+        return status;
+    }
+
+    // A batch (e.g. every submission of an assignment) is one change
+    Status regrade(vector<RegradeEntry>& entries) {
+        Status status = submissions.regrade(entries);
+        if (status == STATUS_OK) recordRegrade(entries);
+        return status;
+    }
+
+    // Records changes made without going through the history (log replay)
+    void recordCreation(Assignment* created) {
+        record(Change{CHANGE_CREATE, created->assignmentID, created->title, noVersion(),
+                      AssignmentVersion{created, -1}, 0, 0, "", {}});
+    }
+
+    void recordGrade(string submissionID) {
+        Submission* sub = submissions.searchByID(submissionID);
+        if (sub == nullptr) return;
+        record(Change{CHANGE_GRADE, symbolText(sub->assignmentID), symbolText(sub->assignmentTitle),
+                      noVersion(), noVersion(), sub->submissionID, sub->score, sub->feedback, {}});
+    }
+
+    void recordRegrade(const vector<RegradeEntry>& entries) {
+        Submission* sub = entries.empty() ? nullptr : submissions.searchByID(formatSubmissionID(entries[0].submissionID));
+        if (sub == nullptr) return;
+        record(Change{CHANGE_REGRADE, symbolText(sub->assignmentID), symbolText(sub->assignmentTitle),
+                      noVersion(), noVersion(), sub->submissionID, sub->score, sub->feedback, entries});
+    }
+
+    // *undone receives a copy of the change
+    Status undo(Change* undone = nullptr) {
+        MetricTimer timer(METRIC_UNDO);
+        if (applied == 0) return STATUS_EMPTY;
+        Change& change = changes[--applied];
+        revert(change);
+        if (log) log->logUndo();
+        if (undone) *undone = change;
+        return STATUS_OK;
+    }
+
+    Status redo(Change* redone = nullptr) {
+        MetricTimer timer(METRIC_REDO);
+        if (applied == changes.size()) return STATUS_EMPTY;
+        Change& change = changes[applied++];
+        reapply(change);
+        if (log) log->logRedo();
+        if (redone) *redone = change;
+        return STATUS_OK;
+    }
+
+    // visit(change, undone) newest first; undone changes can be redone
+    template <typename Visit>
+    void forEachChange(Visit visit) {
+        forEachChangeFrom(0, changes.size(), visit);
+    }
+
+    // Changes [first, first + limit) of forEachChange
+    template <typename Visit>
+    void forEachChangeFrom(size_t first, size_t limit, Visit visit) {
+        size_t end = changes.size() - min(first, changes.size());
+        size_t begin = end - min(limit, end);
+        for (size_t i = end; i-- > begin;)
+            visit(changes[i], i >= applied);
+    }
+
+    size_t size() const {
+        return changes.size();
+    }
+
+    // Compact form stored next to a snapshot: retired versions in full,
+    // visible ones by ID only, since the snapshot holds them
+    void save(RecordWriter& out) {
+        map<pair<const Assignment*, long>, uint32_t> retired;
+        out.putU32((uint32_t)applied);
+        out.putU32((uint32_t)changes.size());
+        for (const Change& change : changes) {
+            out.putU8(change.type);
+            out.putString(change.assignmentID);
+            out.putString(change.title);
+            saveVersion(out, change.removed, retired);
+            saveVersion(out, change.added, retired);
+            out.putU32(change.submissionID);
+            out.putInt(change.score);
+            out.putString(change.feedback);
+            out.putU32((uint32_t)change.regrades.size());
+            for (const RegradeEntry& entry : change.regrades) {
+                out.putU32(entry.submissionID);
+                out.putInt(entry.previousScore);
+                out.putInt(entry.score);
+                out.putString(entry.previousFeedback);
+                out.putString(entry.feedback);
+            }
+        }
+    }
+
+    // Replaces the history with a saved one; call right after the snapshot
+    // it was saved with is attached. False (history left empty) if corrupt.
+    // Version 1 files predate regrades.
+    bool load(RecordReader& in, uint32_t version) {
+        clear();
+        vector<AssignmentVersion> retired;
+        uint32_t savedApplied = in.getU32();
+        uint32_t total = in.getU32();
+        for (uint32_t i = 0; i < total && in.ok(); i++) {
+            Change change;
+            change.type = (ChangeType)in.getU8();
+            change.assignmentID = in.getString();
+            change.title = in.getString();
+            change.removed = loadVersion(in, change.assignmentID, retired);
+            change.added = loadVersion(in, change.assignmentID, retired);
+            change.submissionID = in.getU32();
+            change.score = in.getInt();
+            change.feedback = in.getString();
+            uint32_t regrades = version >= 2 ? in.getU32() : 0;
+            for (uint32_t r = 0; r < regrades && in.ok(); r++) {
+                RegradeEntry entry;
+                entry.submissionID = in.getU32();
+                entry.previousScore = in.getInt();
+                entry.score = in.getInt();
+                entry.previousFeedback = in.getString();
+                entry.feedback = in.getString();
+                change.regrades.push_back(entry);
+            }
+            changes.push_back(move(change));
+        }
+        applied = savedApplied;
+        if (!in.ok() || !in.atEnd() || applied > changes.size()) {
+            changes.clear();    // retired nodes stay in the pool until shutdown
+            applied = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < changes.size(); i++)
+            assignments.releaseVersion(i < applied ? changes[i].removed : changes[i].added);
+        changes.clear();
+        applied = 0;
+    }
+};
+
+#endif
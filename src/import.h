@@ -0,0 +1,246 @@
+// CSV bulk import of assignments and grades.
+#ifndef ELEARNING_IMPORT_H
+#define ELEARNING_IMPORT_H
+
+#include "history.h"
+#include "blobs.h"
+
+// ============== BULK IMPORT (CSV) ==============
+// Streams a CSV file through a fixed buffer, reusing the field strings
+// between rows. Handles quoted fields, doubled quotes and CRLF line endings.
+class CsvReader {
+private:
+    FILE* file;
+    char buffer[1 << 16];
+    size_t length;
+    size_t pos;
+    long lineNumber;
+    long rowLine;
+
+    int nextChar() {
+        if (pos == length) {
+            length = fread(buffer, 1, sizeof(buffer), file);
+            pos = 0;
+            if (length == 0) return EOF;
+        }
+        return (unsigned char)buffer[pos++];
+    }
+
+    int peekChar() {
+        int c = nextChar();
+        if (c != EOF) pos--;
+        return c;
+    }
+
+public:
+    CsvReader() : file(nullptr), length(0), pos(0), lineNumber(0), rowLine(0) {}
+
+    bool open(string path) {
+        file = fopen(path.c_str(), "rb");
+        return file != nullptr;
+    }
+
+    // Reads one record into fields[0..fieldCount); false at end of file
+    bool readRow(vector<string>& fields, int& fieldCount) {
+        int c = nextChar();
+        if (c == EOF) return false;
+
+        rowLine = ++lineNumber;
+        fieldCount = 0;
+        auto beginField = [&]() {
+            if (fieldCount == (int)fields.size()) fields.emplace_back();
+            fields[fieldCount++].clear();
+        };
+        beginField();
+
+        bool quoted = false;
+        while (c != EOF) {
+            string& field = fields[fieldCount - 1];
+            if (quoted) {
+                if (c == '"') {
+                    if (peekChar() == '"') {
+                        field += '"';
+                        nextChar();
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    if (c == '\n') lineNumber++;
+                    field += (char)c;
+                }
+            } else if (c == '"' && field.empty()) {
+                quoted = true;
+            } else if (c == ',') {
+                beginField();
+            } else if (c == '\n') {
+                break;
+            } else if (c != '\r') {
+                field += (char)c;
+            }
+            c = nextChar();
+        }
+        return true;
+    }
+
+    long getLine() { return rowLine; }
+
+    ~CsvReader() {
+        if (file) fclose(file);
+    }
+};
+
+struct ImportReport {
+    string file;
+    long rows;
+    long imported;
+    long rejected;
+    double seconds;
+    vector<string> rejectSamples;  // "line N: reason" for the first few rejects
+};
+
+// Non-interactive loader for assignments, submissions and grades. Every file
+// starts with a header row. Rows that fail validation are counted and the
+// first few are kept in the report with their line numbers.
+//   assignments: assignmentID,title,description,dueDate,maxScore
+//   submissions: studentID,studentName,assignmentID,filePath[,submittedDate]
+//   grades:      studentID,assignmentID,score[,feedback]
+class BulkImporter {
+private:
+    AssignmentLinkedList& assignments;
+    SubmissionQueue& submissions;
+    BlobStore* files;
+    vector<string> fields;
+    int fieldCount;
+
+    static const int MAX_REJECT_SAMPLES = 10;
+
+    void reject(ImportReport& report, CsvReader& reader, string reason) {
+        report.rejected++;
+        if ((int)report.rejectSamples.size() < MAX_REJECT_SAMPLES)
+            report.rejectSamples.push_back("line " + to_string(reader.getLine()) + ": " + reason);
+    }
+
+    static bool parseInt(const string& text, int& value) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        long parsed = strtol(text.c_str(), &end, 10);
+        if (*end != '\0' || parsed < INT_MIN || parsed > INT_MAX) return false;
+        value = (int)parsed;
+        return true;
+    }
+
+    // Opens the file and skips the header row; false if it cannot be read
+    bool begin(string path, CsvReader& reader, ImportReport& report) {
+        report = ImportReport{path, 0, 0, 0, 0.0, {}};
+        if (!reader.open(path)) return false;
+        reader.readRow(fields, fieldCount);
+        return true;
+    }
+
+    // Reads the next data row, skipping blank lines
+    bool nextRow(CsvReader& reader, ImportReport& report) {
+        while (reader.readRow(fields, fieldCount)) {
+            if (fieldCount == 1 && fields[0].empty()) continue;
+            report.rows++;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    // With files, submitted files that can still be read are stored and
+    // referenced by digest; the others keep the path from the CSV
+    BulkImporter(AssignmentLinkedList& assignments, SubmissionQueue& submissions, BlobStore* files = nullptr)
+        : assignments(assignments), submissions(submissions), files(files), fieldCount(0) {}
+
+    // Valid rows are collected and inserted as one batch
+    bool importAssignments(string path, ImportReport& report) {
+        CsvReader reader;
+        if (!begin(path, reader, report)) return false;
+        auto start = chrono::steady_clock::now();
+
+        vector<Assignment> batch;
+        unordered_set<string> seen;
+        while (nextRow(reader, report)) {
+            if (fieldCount != 5) { reject(report, reader, "expected 5 columns"); continue; }
+            if (fields[0].empty()) { reject(report, reader, "missing assignment ID"); continue; }
+            // Same checks as creating one from the menu
+            AssignmentSpec spec{fields[1], fields[2], fields[3], 0};
+            if (!parseInt(fields[4], spec.maxScore)) { reject(report, reader, "invalid max score"); continue; }
+            if (const char* problem = AssignmentLinkedList::specProblem(spec)) {
+                reject(report, reader, problem);
+                continue;
+            }
+            if (seen.count(fields[0]) || assignments.searchByID(fields[0]) != nullptr) {
+                reject(report, reader, "duplicate assignment ID " + fields[0]);
+                continue;
+            }
+            seen.insert(fields[0]);
+            Assignment assg;
+            assg.assignmentID = fields[0];
+            assg.title = spec.title;
+            assg.description = spec.description;
+            assg.dueDate = spec.dueDate;
+            assg.maxScore = spec.maxScore;
+            assg.next = nullptr;
+            batch.push_back(assg);
+        }
+
+        assignments.bulkInsert(batch);
+        report.imported = (long)batch.size();
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool importSubmissions(string path, ImportReport& report) {
+        CsvReader reader;
+        if (!begin(path, reader, report)) return false;
+        auto start = chrono::steady_clock::now();
+
+        while (nextRow(reader, report)) {
+            if (fieldCount != 4 && fieldCount != 5) { reject(report, reader, "expected 4 or 5 columns"); continue; }
+            if (fields[0].empty()) { reject(report, reader, "missing student ID"); continue; }
+            Assignment* assignment = assignments.searchByID(fields[2]);
+            if (assignment == nullptr) { reject(report, reader, "unknown assignment " + fields[2]); continue; }
+            if (submissions.isDuplicate(fields[0], fields[2])) { reject(report, reader, "duplicate submission"); continue; }
+            string submittedDate = fieldCount == 5 ? fields[4] : "";
+            if (!submittedDate.empty() && !isValidDate(submittedDate)) {
+                reject(report, reader, "submitted date is not YYYY-MM-DD");
+                continue;
+            }
+            string file;
+            if (files == nullptr || !files->isOpen() || files->put(fields[3], file) != STATUS_OK) file = fields[3];
+            if (submissions.importSubmission(fields[0], fields[1], assignment, submittedDate, file) == nullptr) {
+                reject(report, reader, statusMessage(STATUS_FULL));
+                continue;
+            }
+            report.imported++;
+        }
+
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+
+    bool importGrades(string path, ImportReport& report) {
+        CsvReader reader;
+        if (!begin(path, reader, report)) return false;
+        auto start = chrono::steady_clock::now();
+
+        while (nextRow(reader, report)) {
+            if (fieldCount != 3 && fieldCount != 4) { reject(report, reader, "expected 3 or 4 columns"); continue; }
+            int score;
+            if (!parseInt(fields[2], score)) { reject(report, reader, "invalid score"); continue; }
+            Submission* sub = submissions.searchByStudentAssignment(fields[0], fields[1]);
+            if (sub == nullptr) { reject(report, reader, "no such submission"); continue; }
+            if (sub->status == SUBMISSION_GRADED) { reject(report, reader, "already graded"); continue; }
+            if (!submissions.isValidScore(sub, score)) { reject(report, reader, "score out of range"); continue; }
+            submissions.importGrade(sub, score, fieldCount == 4 ? fields[3] : "");
+            report.imported++;
+        }
+
+        report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,627 @@
+#include "index.h"
+
+// ============== B+ TREE CLASS (Title Index) ==============
+BPlusNode* BPlusTree::newNode(bool isLeaf) {
+    BPlusNode* node = nodePool.allocate();
+    node->isLeaf = isLeaf;
+    node->keyCount = 0;
+    node->next = nullptr;
+    return node;
+}
+
+int BPlusTree::lowerBound(BPlusNode* node, const string& title, const string& id) {
+    int low = 0, high = node->keyCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (compareKey(node->titles[mid], node->ids[mid], title, id) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+BPlusNode* BPlusTree::findLeaf(const string& title, const string& id) {
+    BPlusNode* node = root;
+    while (node != nullptr && !node->isLeaf) {
+        int i = lowerBound(node, title, id);
+        if (i < node->keyCount && compareKey(node->titles[i], node->ids[i], title, id) == 0)
+            i++;
+        node = node->children[i];
+    }
+    return node;
+}
+
+void BPlusTree::insertAt(BPlusNode* node, int pos, const string& title, const string& id) {
+    for (int j = node->keyCount; j > pos; j--) {
+        node->titles[j] = move(node->titles[j - 1]);
+        node->ids[j] = move(node->ids[j - 1]);
+        if (node->isLeaf)
+            node->values[j] = node->values[j - 1];
+    }
+    node->titles[pos] = title;
+    node->ids[pos] = id;
+    node->keyCount++;
+}
+
+void BPlusTree::removeAt(BPlusNode* node, int pos) {
+    for (int j = pos; j < node->keyCount - 1; j++) {
+        node->titles[j] = move(node->titles[j + 1]);
+        node->ids[j] = move(node->ids[j + 1]);
+        if (node->isLeaf)
+            node->values[j] = node->values[j + 1];
+    }
+    node->keyCount--;
+}
+
+void BPlusTree::borrowFromLeft(BPlusNode* parent, int i) {
+    BPlusNode* node = parent->children[i];
+    BPlusNode* left = parent->children[i - 1];
+    int last = left->keyCount - 1;
+    if (node->isLeaf) {
+        insertAt(node, 0, left->titles[last], left->ids[last]);
+        node->values[0] = left->values[last];
+        parent->titles[i - 1] = node->titles[0];
+        parent->ids[i - 1] = node->ids[0];
+    } else {
+        for (int j = node->keyCount + 1; j > 0; j--)
+            node->children[j] = node->children[j - 1];
+        insertAt(node, 0, parent->titles[i - 1], parent->ids[i - 1]);
+        node->children[0] = left->children[last + 1];
+        parent->titles[i - 1] = move(left->titles[last]);
+        parent->ids[i - 1] = move(left->ids[last]);
+    }
+    left->keyCount--;
+}
+
+void BPlusTree::borrowFromRight(BPlusNode* parent, int i) {
+    BPlusNode* node = parent->children[i];
+    BPlusNode* right = parent->children[i + 1];
+    if (node->isLeaf) {
+        insertAt(node, node->keyCount, right->titles[0], right->ids[0]);
+        node->values[node->keyCount - 1] = right->values[0];
+        removeAt(right, 0);
+        parent->titles[i] = right->titles[0];
+        parent->ids[i] = right->ids[0];
+    } else {
+        insertAt(node, node->keyCount, parent->titles[i], parent->ids[i]);
+        node->children[node->keyCount] = right->children[0];
+        parent->titles[i] = move(right->titles[0]);
+        parent->ids[i] = move(right->ids[0]);
+        removeAt(right, 0);
+        for (int j = 0; j <= right->keyCount; j++)
+            right->children[j] = right->children[j + 1];
+    }
+}
+
+void BPlusTree::mergeChildren(BPlusNode* parent, int i) {
+    BPlusNode* left = parent->children[i];
+    BPlusNode* right = parent->children[i + 1];
+    if (!left->isLeaf)
+        insertAt(left, left->keyCount, parent->titles[i], parent->ids[i]);
+    int base = left->keyCount;
+    for (int j = 0; j < right->keyCount; j++) {
+        left->titles[base + j] = move(right->titles[j]);
+        left->ids[base + j] = move(right->ids[j]);
+        if (left->isLeaf)
+            left->values[base + j] = right->values[j];
+        else
+            left->children[base + j] = right->children[j];
+    }
+    if (left->isLeaf)
+        left->next = right->next;
+    else
+        left->children[base + right->keyCount] = right->children[right->keyCount];
+    left->keyCount += right->keyCount;
+
+    removeAt(parent, i);
+    for (int j = i + 1; j <= parent->keyCount; j++)
+        parent->children[j] = parent->children[j + 1];
+    nodePool.release(right);
+}
+
+void BPlusTree::moveTail(BPlusNode* node, int from, BPlusNode* right) {
+    for (int j = from; j < node->keyCount; j++) {
+        right->titles[j - from] = move(node->titles[j]);
+        right->ids[j - from] = move(node->ids[j]);
+        if (node->isLeaf)
+            right->values[j - from] = node->values[j];
+    }
+    right->keyCount = node->keyCount - from;
+    node->keyCount = from;
+}
+
+void BPlusTree::insertItem(string key, Assignment* value) {
+    const string& id = value->assignmentID;
+    if (root == nullptr)
+        root = newNode(true);
+
+    vector<pair<BPlusNode*, int>> path;
+    BPlusNode* node = root;
+    while (!node->isLeaf) {
+        int i = lowerBound(node, key, id);
+        if (i < node->keyCount && compareKey(node->titles[i], node->ids[i], key, id) == 0)
+            i++;
+        path.push_back({node, i});
+        node = node->children[i];
+    }
+
+    int pos = lowerBound(node, key, id);
+    insertAt(node, pos, key, id);
+    node->values[pos] = value;
+    count++;
+
+    if (node->keyCount <= BPLUS_MAX_KEYS) return;
+
+    // Split the leaf; the first key of the right half is copied up
+    BPlusNode* right = newNode(true);
+    moveTail(node, node->keyCount / 2, right);
+    right->next = node->next;
+    node->next = right;
+    string sepTitle = right->titles[0];
+    string sepID = right->ids[0];
+
+    while (true) {
+        if (path.empty()) {
+            BPlusNode* newRoot = newNode(false);
+            newRoot->titles[0] = sepTitle;
+            newRoot->ids[0] = sepID;
+            newRoot->keyCount = 1;
+            newRoot->children[0] = node;
+            newRoot->children[1] = right;
+            root = newRoot;
+            return;
+        }
+
+        BPlusNode* parent = path.back().first;
+        int i = path.back().second;
+        path.pop_back();
+
+        insertAt(parent, i, sepTitle, sepID);
+        for (int j = parent->keyCount; j > i + 1; j--)
+            parent->children[j] = parent->children[j - 1];
+        parent->children[i + 1] = right;
+
+        if (parent->keyCount <= BPLUS_MAX_KEYS) return;
+
+        // Split the internal node; the middle key moves up
+        int mid = parent->keyCount / 2;
+        BPlusNode* newRight = newNode(false);
+        sepTitle = parent->titles[mid];
+        sepID = parent->ids[mid];
+        for (int j = mid + 1; j <= parent->keyCount; j++)
+            newRight->children[j - mid - 1] = parent->children[j];
+        moveTail(parent, mid + 1, newRight);
+        parent->keyCount = mid;
+
+        node = parent;
+        right = newRight;
+    }
+}
+
+Assignment* BPlusTree::searchByTitle(string key) {
+    Assignment* found = nullptr;
+    scanFrom(key, "", [&](const string& title, Assignment* value) {
+        if (title == key) found = value;
+        return false;
+    });
+    return found;
+}
+
+vector<Assignment*> BPlusTree::searchAll(string key) {
+    vector<Assignment*> out;
+    scanFrom(key, "", [&](const string& title, Assignment* value) {
+        if (title != key) return false;
+        out.push_back(value);
+        return true;
+    });
+    return out;
+}
+
+vector<Assignment*> BPlusTree::searchPrefix(string prefix) {
+    vector<Assignment*> out;
+    scanFrom(prefix, "", [&](const string& title, Assignment* value) {
+        if (title.compare(0, prefix.size(), prefix) != 0) return false;
+        out.push_back(value);
+        return true;
+    });
+    return out;
+}
+
+vector<Assignment*> BPlusTree::searchRange(string low, string high) {
+    vector<Assignment*> out;
+    scanFrom(low, "", [&](const string& title, Assignment* value) {
+        if (title > high) return false;
+        out.push_back(value);
+        return true;
+    });
+    return out;
+}
+
+void BPlusTree::deleteItem(string key, Assignment* value) {
+    const string& id = value->assignmentID;
+    vector<pair<BPlusNode*, int>> path;
+    BPlusNode* node = root;
+    while (node != nullptr && !node->isLeaf) {
+        int i = lowerBound(node, key, id);
+        if (i < node->keyCount && compareKey(node->titles[i], node->ids[i], key, id) == 0)
+            i++;
+        path.push_back({node, i});
+        node = node->children[i];
+    }
+    if (node == nullptr) return;
+
+    int pos = lowerBound(node, key, id);
+    if (pos >= node->keyCount || node->values[pos] != value) return;
+    removeAt(node, pos);
+    count--;
+
+    while (!path.empty() && node->keyCount < BPLUS_MIN_KEYS) {
+        BPlusNode* parent = path.back().first;
+        int i = path.back().second;
+        path.pop_back();
+
+        if (i > 0 && parent->children[i - 1]->keyCount > BPLUS_MIN_KEYS) {
+            borrowFromLeft(parent, i);
+            return;
+        }
+        if (i < parent->keyCount && parent->children[i + 1]->keyCount > BPLUS_MIN_KEYS) {
+            borrowFromRight(parent, i);
+            return;
+        }
+        mergeChildren(parent, i > 0 ? i - 1 : i);
+        node = parent;
+    }
+
+    if (root->keyCount == 0) {
+        BPlusNode* emptied = root;
+        root = root->isLeaf ? nullptr : root->children[0];
+        nodePool.release(emptied);
+    }
+}
+
+void BPlusTree::bulkInsert(vector<Assignment*> items) {
+    auto keyLess = [](Assignment* a, Assignment* b) {
+        if (a->title != b->title) return a->title < b->title;
+        return a->assignmentID < b->assignmentID;
+    };
+    sort(items.begin(), items.end(), keyLess);
+
+    vector<Assignment*> existing;
+    existing.reserve(count);
+    scanFrom("", "", [&](const string&, Assignment* value) {
+        existing.push_back(value);
+        return true;
+    });
+
+    vector<Assignment*> all(existing.size() + items.size());
+    merge(existing.begin(), existing.end(), items.begin(), items.end(), all.begin(), keyLess);
+
+    nodePool.clear();
+    root = nullptr;
+    count = (int)all.size();
+    if (all.empty()) return;
+
+    // Leaves are filled to 3/4 so later inserts do not split straight away
+    const int fill = BPLUS_MAX_KEYS * 3 / 4;
+    vector<BPlusNode*> level;
+    vector<size_t> firstKey;  // index in all of each node's smallest key
+    size_t leafCount = (all.size() + fill - 1) / fill;
+    size_t pos = 0;
+    for (size_t i = 0; i < leafCount; i++) {
+        size_t take = all.size() / leafCount + (i < all.size() % leafCount ? 1 : 0);
+        BPlusNode* leaf = newNode(true);
+        firstKey.push_back(pos);
+        for (size_t j = 0; j < take; j++, pos++) {
+            leaf->titles[j] = all[pos]->title;
+            leaf->ids[j] = all[pos]->assignmentID;
+            leaf->values[j] = all[pos];
+        }
+        leaf->keyCount = (int)take;
+        if (!level.empty()) level.back()->next = leaf;
+        level.push_back(leaf);
+    }
+
+    // Each parent's separators are the smallest keys of children 1..k
+    while (level.size() > 1) {
+        vector<BPlusNode*> parents;
+        vector<size_t> parentFirstKey;
+        size_t parentCount = (level.size() + fill) / (fill + 1);
+        size_t child = 0;
+        for (size_t i = 0; i < parentCount; i++) {
+            size_t take = level.size() / parentCount + (i < level.size() % parentCount ? 1 : 0);
+            BPlusNode* parent = newNode(false);
+            parentFirstKey.push_back(firstKey[child]);
+            for (size_t j = 0; j < take; j++, child++) {
+                parent->children[j] = level[child];
+                if (j > 0) {
+                    parent->titles[j - 1] = all[firstKey[child]]->title;
+                    parent->ids[j - 1] = all[firstKey[child]]->assignmentID;
+                }
+            }
+            parent->keyCount = (int)take - 1;
+            parents.push_back(parent);
+        }
+        level = parents;
+        firstKey = parentFirstKey;
+    }
+    root = level[0];
+}
+
+// ============== CALENDAR INDEX (Skip List) ==============
+int CalendarIndex::randomLevel() {
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    int height = 1;
+    for (uint64_t bits = random; height < CALENDAR_MAX_LEVEL && (bits & 3) == 0; bits >>= 2)
+        height++;
+    return height;
+}
+
+void CalendarIndex::findPath(int day, uint32_t order, CalendarNode* path[]) {
+    CalendarNode* node = &head;
+    for (int i = level - 1; i >= 0; i--) {
+        while (node->next[i] != nullptr && before(node->next[i], day, order))
+            node = node->next[i];
+        path[i] = node;
+    }
+}
+
+CalendarIndex::CalendarIndex() : level(1), count(0), random(0x9E3779B97F4A7C15ULL) {
+    head.day = INT_MIN;
+    head.order = 0;
+    head.value = nullptr;
+    head.level = CALENDAR_MAX_LEVEL;
+    for (int i = 0; i < CALENDAR_MAX_LEVEL; i++) head.next[i] = nullptr;
+}
+
+Assignment* CalendarIndex::insert(Assignment* assg) {
+    CalendarNode* path[CALENDAR_MAX_LEVEL];
+    findPath(assg->dueDay, assg->listOrder, path);
+
+    CalendarNode* node = nodePool.allocate();
+    node->day = assg->dueDay;
+    node->order = assg->listOrder;
+    node->value = assg;
+    node->level = randomLevel();
+    for (int i = level; i < node->level; i++) path[i] = &head;
+    if (node->level > level) level = node->level;
+    for (int i = 0; i < node->level; i++) {
+        node->next[i] = path[i]->next[i];
+        path[i]->next[i] = node;
+    }
+    count++;
+    return path[0]->value;
+}
+
+void CalendarIndex::erase(Assignment* assg) {
+    CalendarNode* path[CALENDAR_MAX_LEVEL];
+    findPath(assg->dueDay, assg->listOrder, path);
+    CalendarNode* node = path[0]->next[0];
+    if (node == nullptr || node->value != assg) return;
+
+    for (int i = 0; i < node->level; i++) path[i]->next[i] = node->next[i];
+    while (level > 1 && head.next[level - 1] == nullptr) level--;
+    nodePool.release(node);
+    count--;
+}
+
+// ============== FULL-TEXT INDEX (Inverted Index) ==============
+void TextIndex::putVarint(vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+void TextIndex::encode(Term& term, const Posting& posting) {
+    if (term.encoded % POSTING_BLOCK == 0)
+        term.skips.push_back(Skip{term.lastDoc, (uint32_t)term.data.size()});
+    putVarint(term.data, posting.doc - term.lastDoc);
+    putVarint(term.data, posting.stamp);
+    putVarint(term.data, posting.frequency);
+    term.lastDoc = posting.doc;
+    term.encoded++;
+}
+
+void TextIndex::settle(Term& term) {
+    vector<Posting> all;
+    all.reserve(term.live);
+    Cursor cursor{&term, &stamps};
+    while (cursor.next()) all.push_back(cursor.current);
+    size_t sorted = all.size();
+    for (const Posting& posting : term.recent)
+        if (isLive(posting)) all.push_back(posting);
+    sort(all.begin() + sorted, all.end(), [](const Posting& a, const Posting& b) { return a.doc < b.doc; });
+    inplace_merge(all.begin(), all.begin() + sorted, all.end(),
+                  [](const Posting& a, const Posting& b) { return a.doc < b.doc; });
+
+    size_t before = term.encoded + term.recent.size();
+    stalePostings -= min(stalePostings, before - all.size());
+    term.data.clear();
+    term.skips.clear();
+    term.recent.clear();
+    term.encoded = 0;
+    term.lastDoc = 0;
+    for (const Posting& posting : all) encode(term, posting);
+    term.data.shrink_to_fit();
+}
+
+void TextIndex::addPosting(Term& term, const Posting& posting) {
+    if (term.encoded == 0 || posting.doc >= term.lastDoc) {
+        encode(term, posting);
+        return;
+    }
+    term.recent.push_back(posting);
+    if (term.recent.size() > max(MIN_RECENT, (size_t)term.encoded / 8)) settle(term);
+}
+
+uint32_t TextIndex::termID(const string& word) {
+    auto it = termIDs.find(word);
+    if (it != termIDs.end()) return it->second;
+    uint32_t id = (uint32_t)terms.size();
+    terms.emplace_back();
+    termIDs.emplace(word, id);
+    return id;
+}
+
+void TextIndex::add(uint32_t doc, string_view text) {
+    remove(doc);
+    unordered_map<string, uint32_t> frequency;
+    uint32_t length = 0;
+    forEachToken(text, [&](const string& word) {
+        frequency[word]++;
+        length++;
+    });
+    if (length == 0) return;
+
+    if (doc >= stamps.size()) {
+        stamps.resize((size_t)doc + 1);
+        lengths.resize((size_t)doc + 1);
+        docTerms.resize((size_t)doc + 1);
+    }
+    uint32_t stamp = nextStamp++;
+    stamps[doc] = stamp;
+    lengths[doc] = length;
+    for (auto& word : frequency) {
+        uint32_t id = termID(word.first);
+        docTerms[doc].push_back(id);
+        terms[id].live++;
+        addPosting(terms[id], Posting{doc, stamp, word.second});
+    }
+    documents++;
+    totalLength += length;
+    livePostings += docTerms[doc].size();
+}
+
+void TextIndex::remove(uint32_t doc) {
+    if (doc >= stamps.size() || stamps[doc] == 0) return;
+    for (uint32_t id : docTerms[doc]) terms[id].live--;
+    documents--;
+    totalLength -= lengths[doc];
+    livePostings -= docTerms[doc].size();
+    stalePostings += docTerms[doc].size();
+    stamps[doc] = 0;
+    lengths[doc] = 0;
+    vector<uint32_t>().swap(docTerms[doc]);
+
+    if (stalePostings > 1024 && stalePostings > livePostings) {
+        for (Term& term : terms) settle(term);
+        stalePostings = 0;
+    }
+}
+
+vector<TextHit> TextIndex::search(string_view query, bool matchAll, size_t limit) {
+    vector<Cursor> cursors;
+    unordered_set<uint32_t> seen;
+    bool missing = false;
+    forEachToken(query, [&](const string& word) {
+        auto it = termIDs.find(word);
+        if (it == termIDs.end() || terms[it->second].live == 0) {
+            missing = true;
+            return;
+        }
+        if (!seen.insert(it->second).second) return;
+        Term& term = terms[it->second];
+        if (!term.recent.empty()) settle(term);
+        Cursor cursor{&term, &stamps};
+        cursor.idf = log(1 + (documents - term.live + 0.5) / (term.live + 0.5));
+        cursors.push_back(cursor);
+    });
+    vector<TextHit> hits;
+    if (cursors.empty() || limit == 0 || (matchAll && missing)) return hits;
+    double lengthScale = BM25_B * documents / (double)totalLength;
+
+    // Min-heap of the best hits so far
+    auto worse = [](const TextHit& a, const TextHit& b) {
+        return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+    };
+    auto offer = [&](uint32_t doc, double score) {
+        if (hits.size() == limit && !worse(TextHit{doc, score}, hits.front())) return;
+        hits.push_back(TextHit{doc, score});
+        push_heap(hits.begin(), hits.end(), worse);
+        if (hits.size() > limit) {
+            pop_heap(hits.begin(), hits.end(), worse);
+            hits.pop_back();
+        }
+    };
+
+    if (matchAll) {
+        // Lead with the rarest word; the others seek to its documents
+        sort(cursors.begin(), cursors.end(), [](const Cursor& a, const Cursor& b) {
+            return a.term->live < b.term->live;
+        });
+        Cursor& lead = cursors[0];
+        bool more = lead.next();
+        while (more) {
+            uint32_t doc = lead.current.doc;
+            bool all = true;
+            for (size_t i = 1; i < cursors.size() && all; i++) {
+                if (!cursors[i].seek(doc)) {
+                    more = false;
+                    all = false;
+                } else if (cursors[i].current.doc != doc) {
+                    all = false;
+                    more = lead.seek(cursors[i].current.doc);
+                }
+            }
+            if (!all) continue;
+            double score = 0;
+            for (const Cursor& cursor : cursors) score += weight(cursor, lengthScale);
+            offer(doc, score);
+            more = lead.next();
+        }
+    } else {
+        // Merge every word's postings in document order
+        auto later = [](const Cursor* a, const Cursor* b) { return a->current.doc > b->current.doc; };
+        priority_queue<Cursor*, vector<Cursor*>, decltype(later)> heads(later);
+        for (Cursor& cursor : cursors)
+            if (cursor.next()) heads.push(&cursor);
+        // Summed in query order, not heap order, so documents that match
+        // alike score exactly alike and ties fall back to the document
+        vector<double> weights(cursors.size(), 0.0);
+        while (!heads.empty()) {
+            uint32_t doc = heads.top()->current.doc;
+            while (!heads.empty() && heads.top()->current.doc == doc) {
+                Cursor* cursor = heads.top();
+                heads.pop();
+                weights[cursor - cursors.data()] = weight(*cursor, lengthScale);
+                if (cursor->next()) heads.push(cursor);
+            }
+            double score = 0;
+            for (double& part : weights) {
+                score += part;
+                part = 0;
+            }
+            offer(doc, score);
+        }
+    }
+
+    sort(hits.begin(), hits.end(), worse);
+    return hits;
+}
+
+void TextIndex::clear() {
+    termIDs.clear();
+    terms.clear();
+    stamps.clear();
+    lengths.clear();
+    docTerms.clear();
+    documents = 0;
+    totalLength = 0;
+    livePostings = 0;
+    stalePostings = 0;
+}
+
+PoolStats TextIndex::memoryStats() const {
+    long long bytes = (long long)(stamps.capacity() * 2 * sizeof(uint32_t) +
+                                  docTerms.capacity() * sizeof(vector<uint32_t>) + terms.capacity() * sizeof(Term));
+    for (const vector<uint32_t>& ids : docTerms)
+        bytes += (long long)(ids.capacity() * sizeof(uint32_t));
+    for (const Term& term : terms)
+        bytes += (long long)(term.data.capacity() + term.skips.capacity() * sizeof(Skip) +
+                             term.recent.capacity() * sizeof(Posting));
+    return PoolStats{documents, 0, 0, documents, 0, bytes};
+}
@@ -0,0 +1,343 @@
+// In-memory indexes over assignments: titles (B+ tree), due dates (skip
+// list) and words (inverted index).
+#ifndef ELEARNING_INDEX_H
+#define ELEARNING_INDEX_H
+
+#include "core.h"
+
+const int BPLUS_ORDER = 32;              // max children per internal node
+const int BPLUS_MAX_KEYS = BPLUS_ORDER - 1;
+const int BPLUS_MIN_KEYS = BPLUS_MAX_KEYS / 2;  // below this a non-root node borrows or merges
+
+// Keys are (title, assignmentID) so duplicate titles stay distinct
+struct BPlusNode {
+    bool isLeaf;
+    int keyCount;
+    string titles[BPLUS_ORDER];           // one spare slot for overflow before a split
+    string ids[BPLUS_ORDER];
+    Assignment* values[BPLUS_ORDER];      // leaves only
+    BPlusNode* children[BPLUS_ORDER + 1]; // internal nodes only
+    BPlusNode* next;                      // leaf chain for ordered scans
+};
+
+// ============== B+ TREE CLASS (Title Index) ==============
+class BPlusTree {
+private:
+    BPlusNode* root;
+    int count;
+    ObjectPool<BPlusNode, 16> nodePool;
+
+    BPlusNode* newNode(bool isLeaf);
+
+    // Compares (title, id) pairs; an empty id sorts before every real ID
+    int compareKey(const string& title1, const string& id1, const string& title2, const string& id2) {
+        int cmp = title1.compare(title2);
+        if (cmp != 0) return cmp;
+        return id1.compare(id2);
+    }
+
+    // Number of keys in node strictly less than (title, id)
+    int lowerBound(BPlusNode* node, const string& title, const string& id);
+
+    // Leaf that may hold the first key >= (title, id)
+    BPlusNode* findLeaf(const string& title, const string& id);
+
+    // Walk the leaf chain from the first key >= (title, id), calling visit until it returns false
+    template <typename Visit>
+    void scanFrom(const string& title, const string& id, Visit visit) {
+        BPlusNode* leaf = findLeaf(title, id);
+        if (leaf == nullptr) return;
+        int i = lowerBound(leaf, title, id);
+        while (leaf != nullptr) {
+            for (; i < leaf->keyCount; i++) {
+                if (!visit(leaf->titles[i], leaf->values[i]))
+                    return;
+            }
+            leaf = leaf->next;
+            i = 0;
+        }
+    }
+
+    void insertAt(BPlusNode* node, int pos, const string& title, const string& id);
+
+    void removeAt(BPlusNode* node, int pos);
+
+    // Child i of parent takes the last key of child i - 1. A leaf's new
+    // first key becomes the separator; an internal node rotates through it.
+    void borrowFromLeft(BPlusNode* parent, int i);
+
+    // Child i of parent takes the first key of child i + 1
+    void borrowFromRight(BPlusNode* parent, int i);
+
+    // Appends child i + 1 of parent to child i and frees it; an internal
+    // merge pulls the separator between them down
+    void mergeChildren(BPlusNode* parent, int i);
+
+    // Moves keys [from, keyCount) of node into the empty node right
+    void moveTail(BPlusNode* node, int from, BPlusNode* right);
+
+public:
+    BPlusTree() : root(nullptr), count(0) {}
+
+    // Iterative insert: descend recording the path, then split upward
+    void insertItem(string key, Assignment* value);
+
+    // First assignment with this exact title
+    Assignment* searchByTitle(string key);
+
+    // Every assignment with this exact title, ordered by ID
+    vector<Assignment*> searchAll(string key);
+
+    // Every assignment whose title starts with prefix, in title order
+    vector<Assignment*> searchPrefix(string prefix);
+
+    // Every assignment with low <= title <= high, in title order
+    vector<Assignment*> searchRange(string low, string high);
+
+    // Removes exactly this assignment. A node left with fewer than
+    // BPLUS_MIN_KEYS keys borrows from a sibling that can spare one, or else
+    // merges with it, which may leave the parent short in turn; a root left
+    // with a single child is replaced by it.
+    void deleteItem(string key, Assignment* value);
+
+    // Adds many assignments with one sort and a bottom-up rebuild, O(n log n)
+    // for the batch plus O(total) to merge, instead of one descent per item
+    void bulkInsert(vector<Assignment*> items);
+
+    int getSize() {
+        return count;
+    }
+
+    PoolStats memoryStats() {
+        return nodePool.getStats();
+    }
+};
+
+// ============== CALENDAR INDEX (Skip List) ==============
+const int CALENDAR_MAX_LEVEL = 16;  // 4^16 entries before searches slow down
+
+// Keyed on (dueDay, listOrder), the same order as the due-date list
+struct CalendarNode {
+    int day;
+    uint32_t order;
+    Assignment* value;
+    int level;
+    CalendarNode* next[CALENDAR_MAX_LEVEL];
+};
+
+// Ordered index of the due-date list. Each node is promoted one level with
+// probability 1/4, so search, insert and erase are O(log n) expected and a
+// range of k dates is O(log n + k).
+class CalendarIndex {
+private:
+    CalendarNode head;  // sentinel before every key
+    int level;
+    int count;
+    uint64_t random;
+    ObjectPool<CalendarNode> nodePool;
+
+    static bool before(const CalendarNode* node, int day, uint32_t order) {
+        return node->day < day || (node->day == day && node->order < order);
+    }
+
+    int randomLevel();
+
+    // Last node before (day, order) on every level
+    void findPath(int day, uint32_t order, CalendarNode* path[]);
+
+public:
+    CalendarIndex();
+
+    // Indexes the assignment under (dueDay, listOrder); returns the
+    // assignment just before it, or nullptr if it is now the earliest
+    Assignment* insert(Assignment* assg);
+
+    void erase(Assignment* assg);
+
+    // First entry due on or after day; follow next[0] for the rest in order
+    const CalendarNode* lowerBound(int day) {
+        CalendarNode* path[CALENDAR_MAX_LEVEL];
+        findPath(day, 0, path);
+        return path[0]->next[0];
+    }
+
+    int getSize() {
+        return count;
+    }
+
+    PoolStats memoryStats() {
+        return nodePool.getStats();
+    }
+};
+
+// ============== FULL-TEXT INDEX (Inverted Index) ==============
+const uint32_t POSTING_BLOCK = 128;  // postings between skip entries
+const size_t MIN_RECENT = 64;        // out-of-order postings buffered before a merge
+const double BM25_K1 = 1.2;
+const double BM25_B = 0.75;
+
+struct TextHit {
+    uint32_t doc;
+    double score;
+};
+
+// Lower-cased runs of ASCII letters and digits; anything else separates words
+template <typename Visit>
+void forEachToken(string_view text, Visit visit) {
+    string token;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = i < text.size() ? (unsigned char)text[i] : ' ';
+        if (isalnum(c)) {
+            token += (char)tolower(c);
+        } else if (!token.empty()) {
+            visit(token);
+            token.clear();
+        }
+    }
+}
+
+// Word -> documents index with BM25 ranking. Documents are small dense
+// integers (assignment or submission numbers).
+//
+// Each term's postings are sorted by document and stored as varint deltas,
+// with a skip entry every POSTING_BLOCK postings so AND queries jump over
+// blocks. Documents added in increasing order are appended directly; the
+// rest wait in a small unsorted buffer that is merged in once it reaches
+// 1/8 of the list, so updates stay amortized O(1) per posting.
+//
+// Removing a document only bumps its stamp: postings carry the stamp they
+// were written with and older ones are skipped, then dropped at the next
+// merge or once stale postings outnumber live ones.
+class TextIndex {
+private:
+    struct Posting {
+        uint32_t doc;
+        uint32_t stamp;
+        uint32_t frequency;
+    };
+
+    struct Skip {
+        uint32_t previousDoc;  // doc just before the block
+        uint32_t offset;       // byte offset of the block
+    };
+
+    struct Term {
+        vector<uint8_t> data;
+        vector<Skip> skips;
+        uint32_t encoded = 0;
+        uint32_t lastDoc = 0;
+        vector<Posting> recent;
+        uint32_t live = 0;     // documents containing the term
+    };
+
+    // Reads one term's postings in document order, skipping stale ones
+    struct Cursor {
+        const Term* term;
+        const vector<uint32_t>* stamps;
+        size_t offset = 0;
+        uint32_t read = 0;
+        uint32_t previous = 0;
+        Posting current{0, 0, 0};
+        double idf = 0;
+
+        static uint32_t getVarint(const uint8_t* data, size_t& offset) {
+            uint32_t value = 0;
+            for (int shift = 0;; shift += 7) {
+                uint8_t byte = data[offset++];
+                value |= (uint32_t)(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0) return value;
+            }
+        }
+
+        bool next() {
+            while (read < term->encoded) {
+                if (read % POSTING_BLOCK == 0) previous = term->skips[read / POSTING_BLOCK].previousDoc;
+                current.doc = previous + getVarint(term->data.data(), offset);
+                current.stamp = getVarint(term->data.data(), offset);
+                current.frequency = getVarint(term->data.data(), offset);
+                previous = current.doc;
+                read++;
+                if (current.doc < stamps->size() && (*stamps)[current.doc] == current.stamp)
+                    return true;
+            }
+            current.doc = UINT32_MAX;
+            return false;
+        }
+
+        // First live posting with doc >= target
+        bool seek(uint32_t target) {
+            if (current.doc >= target && read > 0) return current.doc != UINT32_MAX;
+            // Last block starting after a doc < target, if it is ahead of us
+            size_t low = read / POSTING_BLOCK, high = term->skips.size();
+            while (high - low > 1) {
+                size_t mid = (low + high) / 2;
+                if (term->skips[mid].previousDoc < target) low = mid;
+                else high = mid;
+            }
+            if (low * POSTING_BLOCK > read) {
+                read = (uint32_t)(low * POSTING_BLOCK);
+                offset = term->skips[low].offset;
+            }
+            while (next()) {
+                if (current.doc >= target) return true;
+            }
+            return false;
+        }
+    };
+
+    unordered_map<string, uint32_t> termIDs;
+    vector<Term> terms;
+    // Per document, split so scans touch only stamps and lengths
+    vector<uint32_t> stamps;           // 0: not indexed
+    vector<uint32_t> lengths;          // words
+    vector<vector<uint32_t>> docTerms; // distinct term IDs
+    uint32_t nextStamp;
+    uint32_t documents;
+    uint64_t totalLength;
+    size_t livePostings;
+    size_t stalePostings;
+
+    static void putVarint(vector<uint8_t>& out, uint32_t value);
+
+    void encode(Term& term, const Posting& posting);
+
+    bool isLive(const Posting& posting) const {
+        return posting.doc < stamps.size() && stamps[posting.doc] == posting.stamp;
+    }
+
+    // Re-encodes the term's live postings with the buffered ones merged in
+    void settle(Term& term);
+
+    void addPosting(Term& term, const Posting& posting);
+
+    uint32_t termID(const string& word);
+
+    // BM25 term weight; lengthScale is BM25_B / average length
+    double weight(const Cursor& cursor, double lengthScale) const {
+        double tf = cursor.current.frequency;
+        double norm = 1 - BM25_B + lengthScale * lengths[cursor.current.doc];
+        return cursor.idf * tf * (BM25_K1 + 1) / (tf + BM25_K1 * norm);
+    }
+
+public:
+    TextIndex() : nextStamp(1), documents(0), totalLength(0), livePostings(0), stalePostings(0) {}
+
+    // Indexes text under doc, replacing whatever doc held before
+    void add(uint32_t doc, string_view text);
+
+    void remove(uint32_t doc);
+
+    // Best `limit` documents by BM25, highest first (ties: lower doc
+    // first). matchAll: every word must appear; otherwise any word.
+    vector<TextHit> search(string_view query, bool matchAll, size_t limit);
+
+    void clear();
+
+    uint32_t documentCount() const {
+        return documents;
+    }
+
+    PoolStats memoryStats() const;
+};
+
+#endif
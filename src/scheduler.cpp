@@ -0,0 +1,90 @@
+#include "scheduler.h"
+
+// ============== GRADING SCHEDULER ==============
+int GradingScheduler::graderSlot(const string& grader) {
+    auto it = graderIndex.find(grader);
+    if (it != graderIndex.end()) return it->second;
+    graders.push_back(Grader{GraderStats{grader, 0, 0, 0, 0, 0.0}, 0});
+    graderIndex.emplace(grader, (int)graders.size() - 1);
+    return (int)graders.size() - 1;
+}
+
+void GradingScheduler::enqueue(uint32_t submissionID, const Item& item) {
+    oldest.push(Entry{submissionID, submissionID, item.generation});
+    nearestDue.push(Entry{((uint64_t)item.dueKey << 32) | submissionID, submissionID, item.generation});
+    byAssignment[item.assignmentID].push(Entry{submissionID, submissionID, item.generation});
+    queuedCount++;
+    entryCount += 3;
+}
+
+void GradingScheduler::drop(uint32_t submissionID) {
+    auto it = items.find(submissionID);
+    if (it == items.end()) return;
+    if (it->second.state == ITEM_QUEUED) queuedCount--;
+    items.erase(it);
+}
+
+void GradingScheduler::compactIfStale() {
+    if (entryCount < COMPACT_MIN_ENTRIES || entryCount <= 6 * queuedCount) return;
+    oldest = Heap();
+    nearestDue = Heap();
+    byAssignment.clear();
+    leases = Heap();
+    queuedCount = 0;
+    entryCount = 0;
+    for (auto& entry : items) {
+        Item& item = entry.second;
+        if (item.state == ITEM_QUEUED)
+            enqueue(entry.first, item);
+        else
+            leases.push(Entry{(uint64_t)item.expiresAt.time_since_epoch().count(), entry.first, item.generation});
+    }
+}
+
+void GradingScheduler::add(uint32_t submissionID, Symbol assignmentID, uint32_t dueKey) {
+    if (items.count(submissionID)) return;
+    Item& item = items[submissionID];
+    item = Item{assignmentID, dueKey, ++generations, ITEM_QUEUED, -1, Clock::time_point(), Clock::time_point()};
+    enqueue(submissionID, item);
+}
+
+void GradingScheduler::expireLeases(Clock::time_point now) {
+    uint64_t nowKey = (uint64_t)now.time_since_epoch().count();
+    while (!leases.empty() && leases.top().key <= nowKey) {
+        Entry lease = leases.top();
+        leases.pop();
+        auto it = items.find(lease.submissionID);
+        if (it == items.end() || it->second.state != ITEM_LEASED ||
+            it->second.generation != lease.generation)
+            continue;
+        graders[it->second.owner].stats.expired++;
+        requeue(lease.submissionID, it->second);
+    }
+}
+
+bool GradingScheduler::holds(const string& grader, uint32_t submissionID, Clock::time_point now) {
+    expireLeases(now);
+    auto owner = graderIndex.find(grader);
+    auto it = items.find(submissionID);
+    return owner != graderIndex.end() && it != items.end() &&
+           it->second.state == ITEM_LEASED && it->second.owner == owner->second;
+}
+
+Status GradingScheduler::complete(const string& grader, uint32_t submissionID, Clock::time_point now) {
+    if (!holds(grader, submissionID, now)) return STATUS_INVALID;
+    Item& item = items[submissionID];
+    GraderStats& stats = graders[item.owner].stats;
+    stats.completed++;
+    stats.busySeconds += chrono::duration<double>(now - item.claimedAt).count();
+    drop(submissionID);
+    compactIfStale();
+    return STATUS_OK;
+}
+
+Status GradingScheduler::release(const string& grader, uint32_t submissionID, Clock::time_point now) {
+    if (!holds(grader, submissionID, now)) return STATUS_INVALID;
+    Item& item = items[submissionID];
+    graders[item.owner].stats.released++;
+    requeue(submissionID, item);
+    return STATUS_OK;
+}
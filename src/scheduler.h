@@ -0,0 +1,198 @@
+// Grading work queue: fair claims across assignments with leases.
+#ifndef ELEARNING_SCHEDULER_H
+#define ELEARNING_SCHEDULER_H
+
+#include "core.h"
+
+// ============== GRADING SCHEDULER ==============
+enum GradingPolicy : uint8_t {
+    GRADE_OLDEST_FIRST,   // arrival order, like the pending list
+    GRADE_NEAREST_DUE,    // earliest assignment due date first, then oldest
+    GRADE_BY_ASSIGNMENT   // stay on the grader's current assignment while it has work
+};
+
+struct GraderStats {
+    string grader;
+    long long claimed;
+    long long completed;
+    long long released;     // handed back before grading
+    long long expired;      // lease ran out
+    double busySeconds;     // claim to completion, completed items only
+
+    double perHour() const {
+        return busySeconds > 0 ? completed * 3600.0 / busySeconds : 0.0;
+    }
+};
+
+// Hands pending submissions to graders. Each claim is a lease: the item
+// is invisible to other graders until it is completed, released or the
+// lease expires. Items sit in three heaps (arrival, due date, and one per
+// assignment); stale heap entries are skipped on pop, and the heaps are
+// rebuilt once most of their entries are stale, so every operation is
+// O(log n) amortized. Graded items are forgotten. Not thread-safe;
+// ELearningSystem serializes it.
+class GradingScheduler {
+public:
+    typedef chrono::steady_clock Clock;
+
+private:
+    enum ItemState : uint8_t { ITEM_QUEUED, ITEM_LEASED };
+
+    // Heaps with more entries than this, and mostly stale ones, are rebuilt
+    static const size_t COMPACT_MIN_ENTRIES = 1024;
+
+    struct Item {
+        Symbol assignmentID;
+        uint32_t dueKey;
+        uint32_t generation;   // new on every (re)queue; older heap entries are stale
+        ItemState state;
+        int owner;             // grader index while leased
+        Clock::time_point claimedAt;
+        Clock::time_point expiresAt;
+    };
+
+    struct Entry {
+        uint64_t key;
+        uint32_t submissionID;
+        uint32_t generation;
+        bool operator>(const Entry& other) const { return key > other.key; }
+    };
+    typedef priority_queue<Entry, vector<Entry>, greater<Entry>> Heap;
+
+    struct Grader {
+        GraderStats stats;
+        Symbol currentAssignment;   // 0 until the first GRADE_BY_ASSIGNMENT claim
+    };
+
+    unordered_map<uint32_t, Item> items;
+    Heap oldest;
+    Heap nearestDue;
+    unordered_map<Symbol, Heap> byAssignment;
+    Heap leases;                    // key: expiry in steady-clock ticks
+    vector<Grader> graders;
+    unordered_map<string, int> graderIndex;
+    Clock::duration leaseTime;
+    size_t queuedCount;
+    size_t entryCount;              // in oldest, nearestDue and byAssignment
+    uint32_t generations;           // never reused, so a re-added item cannot revive old entries
+
+    int graderSlot(const string& grader);
+
+    void enqueue(uint32_t submissionID, const Item& item);
+
+    // Forgets the item whatever its state; its heap entries become stale
+    void drop(uint32_t submissionID);
+
+    // Each queued item needs three entries; past twice that, rebuild the
+    // heaps from the items instead of waiting for the stale ones to surface
+    void compactIfStale();
+
+    bool isLive(const Entry& entry) {
+        auto it = items.find(entry.submissionID);
+        return it != items.end() && it->second.state == ITEM_QUEUED &&
+               it->second.generation == entry.generation;
+    }
+
+    // Top live entry of the heap, dropping stale ones and any item the
+    // caller reports as no longer pending; false when empty
+    template <typename Pending>
+    bool peekLive(Heap& heap, Entry& top, Pending& pending) {
+        while (!heap.empty()) {
+            if (isLive(heap.top())) {
+                if (pending(heap.top().submissionID)) {
+                    top = heap.top();
+                    return true;
+                }
+                drop(heap.top().submissionID);
+            }
+            heap.pop();
+            entryCount--;
+        }
+        return false;
+    }
+
+    void requeue(uint32_t submissionID, Item& item) {
+        item.state = ITEM_QUEUED;
+        item.generation = ++generations;
+        enqueue(submissionID, item);
+    }
+
+public:
+    explicit GradingScheduler(Clock::duration lease = chrono::minutes(30))
+        : leaseTime(lease), queuedCount(0), entryCount(0), generations(0) {}
+
+    void setLeaseTime(Clock::duration lease) {
+        leaseTime = lease;
+    }
+
+    // Adds a pending submission, or one whose grade was undone; known IDs
+    // are ignored
+    void add(uint32_t submissionID, Symbol assignmentID, uint32_t dueKey);
+
+    // The submission was graded elsewhere; drop it whatever its state
+    void remove(uint32_t submissionID) {
+        drop(submissionID);
+        compactIfStale();
+    }
+
+    // Returns expired leases to the queue
+    void expireLeases(Clock::time_point now);
+
+    // Leases the next submission for the grader under the policy; false
+    // when nothing is queued. pending(id) lets the caller drop submissions
+    // that were graded without going through the scheduler.
+    template <typename Pending>
+    bool claim(const string& grader, GradingPolicy policy, Clock::time_point now,
+               uint32_t& submissionID, Pending pending) {
+        expireLeases(now);
+        compactIfStale();
+        int slot = graderSlot(grader);
+        Entry top;
+        bool found = false;
+        if (policy == GRADE_BY_ASSIGNMENT) {
+            Symbol current = graders[slot].currentAssignment;
+            auto it = byAssignment.find(current);
+            if (it != byAssignment.end()) found = peekLive(it->second, top, pending);
+            if (!found && peekLive(oldest, top, pending)) {
+                // Move on to the assignment with the oldest pending work
+                graders[slot].currentAssignment = items[top.submissionID].assignmentID;
+                found = peekLive(byAssignment[graders[slot].currentAssignment], top, pending);
+            }
+        } else {
+            found = peekLive(policy == GRADE_NEAREST_DUE ? nearestDue : oldest, top, pending);
+        }
+        if (!found) return false;
+
+        Item& item = items[top.submissionID];
+        item.state = ITEM_LEASED;
+        item.owner = slot;
+        item.claimedAt = now;
+        item.expiresAt = now + leaseTime;
+        leases.push(Entry{(uint64_t)item.expiresAt.time_since_epoch().count(), top.submissionID, item.generation});
+        queuedCount--;
+        graders[slot].stats.claimed++;
+        submissionID = top.submissionID;
+        return true;
+    }
+
+    // True while the grader's lease on the submission is live
+    bool holds(const string& grader, uint32_t submissionID, Clock::time_point now);
+
+    // Ends a lease the grader holds, after the grade was recorded
+    Status complete(const string& grader, uint32_t submissionID, Clock::time_point now);
+
+    // Hands a leased submission back without grading it
+    Status release(const string& grader, uint32_t submissionID, Clock::time_point now);
+
+    size_t queued() const {
+        return queuedCount;
+    }
+
+    vector<GraderStats> graderStats() const {
+        vector<GraderStats> out;
+        for (const Grader& grader : graders) out.push_back(grader.stats);
+        return out;
+    }
+};
+
+#endif
@@ -0,0 +1,438 @@
+#include "server.h"
+
+// ============== CLIENT PROTOCOL ==============
+void RequestHandler::putAssignment(RecordWriter& out, string_view id, string_view title,
+                          string_view dueDate, int maxScore) {
+    out.putString(id);
+    out.putString(title);
+    out.putString(dueDate);
+    out.putInt(maxScore);
+}
+
+Status RequestHandler::uploadPath(const string& name, string& path) const {
+    if (uploadRoot.empty() || name.empty() || name[0] == '/' || name[0] == '\\') return STATUS_DENIED;
+    size_t start = 0;
+    while (start <= name.size()) {
+        size_t end = name.find_first_of("/\\", start);
+        if (end == string::npos) end = name.size();
+        if (name.compare(start, end - start, "..") == 0) return STATUS_DENIED;
+        start = end + 1;
+    }
+    if (!resolvePath(uploadRoot + "/" + name, path)) return STATUS_FILE_ERROR;
+    string prefix = uploadRoot.back() == '/' ? uploadRoot : uploadRoot + "/";
+    return path.compare(0, prefix.size(), prefix) == 0 ? STATUS_OK : STATUS_DENIED;
+}
+
+void RequestHandler::listAssignments(ClientSession& session, uint32_t offset, uint32_t limit, RecordWriter& out) {
+    AssignmentLinkedList& list = session.course->assignments;
+    auto put = [&](string_view id, string_view title, string_view dueDate, int maxScore) {
+        putAssignment(out, id, title, dueDate, maxScore);
+    };
+    if (offset != session.assignmentsNext || session.assignmentsVersion != list.getChangeCount()) {
+        session.assignmentsCursor = list.firstByDueDate();
+        list.forEachByDueDateFrom(session.assignmentsCursor, offset,
+                                  [](string_view, string_view, string_view, int) {});
+    }
+    out.putU32((uint32_t)list.visibleCount());
+    size_t rowsAt = out.bytes.size();
+    out.putU32(0);
+    size_t rows = list.forEachByDueDateFrom(session.assignmentsCursor, limit, put);
+    out.setU32(rowsAt, (uint32_t)rows);
+    session.assignmentsNext = offset + (uint32_t)rows;
+    session.assignmentsVersion = list.getChangeCount();
+}
+
+void RequestHandler::listPending(ClientSession& session, uint32_t offset, uint32_t limit, RecordWriter& out) {
+    SubmissionQueue& queue = session.course->submissions;
+    auto put = [&](const Submission& sub) {
+        out.putString(formatSubmissionID(sub.submissionID));
+        out.putString(symbolText(sub.studentName));
+        out.putString(symbolText(sub.assignmentTitle));
+        out.putString(sub.submittedDate);
+    };
+    // Grading does not move the cursor's nodes, but a new submission
+    // may belong on a page the cursor has already passed
+    if (offset != session.pendingNext || session.pendingVersion != queue.submissionCount()) {
+        session.pendingCursor = queue.firstPending();
+        queue.forEachPendingFrom(session.pendingCursor, offset, [](const Submission&) {});
+    }
+    out.putU32((uint32_t)queue.pendingCount());
+    size_t rowsAt = out.bytes.size();
+    out.putU32(0);
+    size_t rows = queue.forEachPendingFrom(session.pendingCursor, limit, put);
+    out.setU32(rowsAt, (uint32_t)rows);
+    session.pendingNext = offset + (uint32_t)rows;
+    session.pendingVersion = queue.submissionCount();
+}
+
+Status RequestHandler::execute(ClientSession& session, RequestOp op, RecordReader& in, RecordWriter& out) {
+    if (op < OP_LOGIN_STUDENT || op > OP_REGRADE) return STATUS_INVALID;
+    if (session.course == nullptr) session.course = &general;
+    ELearningSystem& system = *session.course;
+    switch (op) {
+        case OP_LOGIN_STUDENT: {
+            Student student{in.getString(), in.getString(), in.getString(), 0, 0};
+            if (!complete(in) || student.studentID.empty()) return STATUS_INVALID;
+            session = ClientSession();
+            session.course = &system;  // a course chosen before login is kept
+            session.role = ROLE_STUDENT;
+            session.student = student;
+            return STATUS_OK;
+        }
+        case OP_LOGIN_LECTURER: {
+            string grader = in.getString();
+            if (!complete(in) || grader.empty()) return STATUS_INVALID;
+            session = ClientSession();
+            session.course = &system;
+            session.role = ROLE_LECTURER;
+            session.grader = grader;
+            return STATUS_OK;
+        }
+        case OP_LOGOUT:
+            if (!complete(in)) return STATUS_INVALID;
+            session = ClientSession();
+            return STATUS_OK;
+        case OP_SELECT_COURSE: {
+            string courseID = in.getString();
+            uint8_t create = in.getU8();
+            if (!complete(in) || create > 1) return STATUS_INVALID;
+            if (create && session.role != ROLE_LECTURER) return STATUS_DENIED;
+            ELearningSystem* course = nullptr;
+            Status status = router.course(courseID, &course, create != 0);
+            if (status != STATUS_OK) return status;
+            if (course != session.course) {
+                // Saved cursors point into the old course's lists
+                session.course = course;
+                session.assignmentsNext = UINT32_MAX;
+                session.pendingNext = UINT32_MAX;
+            }
+            return STATUS_OK;
+        }
+        default:
+            break;
+    }
+
+    if (session.role == ROLE_NONE) return STATUS_DENIED;
+    bool student = session.role == ROLE_STUDENT;
+    switch (op) {
+        case OP_LIST_ASSIGNMENTS: {
+            uint32_t offset = in.getU32();
+            uint32_t limit = in.getU32();
+            if (!complete(in)) return STATUS_INVALID;
+            listAssignments(session, offset, min(limit, MAX_PAGE_ROWS), out);
+            return STATUS_OK;
+        }
+        case OP_SEARCH_TITLE: {
+            string title = in.getString();
+            if (!complete(in)) return STATUS_INVALID;
+            vector<Assignment*> matches = system.assignments.searchAllByTitle(title);
+            if (matches.size() > MAX_PAGE_ROWS) matches.resize(MAX_PAGE_ROWS);
+            out.putU32((uint32_t)matches.size());
+            for (Assignment* assg : matches)
+                putAssignment(out, assg->assignmentID, assg->title, assg->dueDate, assg->maxScore);
+            return STATUS_OK;
+        }
+        case OP_RANKINGS: {
+            uint32_t offset = in.getU32();
+            uint32_t limit = in.getU32();
+            if (!complete(in)) return STATUS_INVALID;
+            int total = system.submissions.rankingSize();
+            int first = (int)min(offset, (uint32_t)total);
+            int last = (int)min((uint32_t)total, first + min(limit, MAX_PAGE_ROWS));
+            vector<Student> students = system.submissions.rankingRange(first, last);
+            out.putU32((uint32_t)total);
+            out.putU32((uint32_t)students.size());
+            for (const Student& entry : students) {
+                out.putString(entry.studentID);
+                out.putString(entry.name);
+                out.putInt(entry.totalScore);
+                out.putInt(entry.submissionCount);
+            }
+            return STATUS_OK;
+        }
+        case OP_SUBMIT: {
+            string assignmentID = in.getString();
+            string filePath = in.getString();
+            if (!complete(in)) return STATUS_INVALID;
+            if (!student) return STATUS_DENIED;
+            string path;
+            Status allowed = uploadPath(filePath, path);
+            if (allowed != STATUS_OK) return allowed;
+            Submission* created = nullptr;
+            Status status = system.submit(session.student, assignmentID, path, &created);
+            if (status == STATUS_OK) out.putString(formatSubmissionID(created->submissionID));
+            return status;
+        }
+        case OP_MY_SUBMISSIONS: {
+            uint32_t offset = in.getU32();
+            uint32_t limit = in.getU32();
+            if (!complete(in)) return STATUS_INVALID;
+            if (!student) return STATUS_DENIED;
+            SubmissionQueue& queue = system.submissions;
+            out.putU32((uint32_t)queue.studentSubmissionCount(session.student.studentID));
+            size_t rowsAt = out.bytes.size();
+            out.putU32(0);
+            uint32_t rows = 0;
+            queue.forEachByStudentFrom(session.student.studentID, offset, min(limit, MAX_PAGE_ROWS),
+                [&](const Submission& sub) {
+                    out.putString(formatSubmissionID(sub.submissionID));
+                    out.putString(symbolText(sub.assignmentTitle));
+                    out.putString(sub.submittedDate);
+                    out.putU8(sub.status);
+                    out.putInt(sub.score);
+                    out.putString(sub.feedback);
+                    rows++;
+                });
+            out.setU32(rowsAt, rows);
+            return STATUS_OK;
+        }
+        case OP_MY_RANK:
+            if (!complete(in)) return STATUS_INVALID;
+            if (!student) return STATUS_DENIED;
+            out.putU32((uint32_t)system.submissions.rankOf(session.student.studentID));
+            out.putU32((uint32_t)system.submissions.rankingSize());
+            return STATUS_OK;
+        case OP_LIST_COURSES: {
+            if (!complete(in)) return STATUS_INVALID;
+            vector<CourseSummary> summaries = router.courseSummaries();
+            out.putU32((uint32_t)summaries.size());
+            for (const CourseSummary& summary : summaries) {
+                out.putString(summary.courseID);
+                out.putU32((uint32_t)summary.assignments);
+                out.putU32((uint32_t)summary.submissions);
+                out.putU32((uint32_t)summary.graded);
+                out.putU32((uint32_t)summary.pending);
+            }
+            return STATUS_OK;
+        }
+        default:
+            break;
+    }
+
+    if (student) return STATUS_DENIED;
+    switch (op) {
+        case OP_CREATE_ASSIGNMENT: {
+            AssignmentSpec spec{in.getString(), in.getString(), in.getString(), in.getInt()};
+            if (!complete(in)) return STATUS_INVALID;
+            Assignment* created = nullptr;
+            Status status = system.createAssignment(spec, &created);
+            if (status == STATUS_OK) out.putString(created->assignmentID);
+            return status;
+        }
+        case OP_PENDING: {
+            uint32_t offset = in.getU32();
+            uint32_t limit = in.getU32();
+            if (!complete(in)) return STATUS_INVALID;
+            listPending(session, offset, min(limit, MAX_PAGE_ROWS), out);
+            return STATUS_OK;
+        }
+        case OP_GRADE:
+        case OP_REGRADE:
+        case OP_COMPLETE_GRADING: {
+            string submissionID = in.getString();
+            int score = in.getInt();
+            string feedback = in.getString();
+            if (!complete(in)) return STATUS_INVALID;
+            if (op == OP_GRADE) return system.grade(submissionID, score, feedback);
+            if (op == OP_REGRADE) return system.regrade(submissionID, score, feedback);
+            return system.completeGrading(session.grader, submissionID, score, feedback);
+        }
+        case OP_CLAIM_NEXT: {
+            uint8_t policy = in.getU8();
+            if (!complete(in) || policy > GRADE_BY_ASSIGNMENT) return STATUS_INVALID;
+            string submissionID;
+            Status status = system.claimNextSubmission(session.grader, (GradingPolicy)policy, &submissionID);
+            if (status == STATUS_OK) out.putString(submissionID);
+            return status;
+        }
+        case OP_STATS:
+            if (!complete(in)) return STATUS_INVALID;
+            out.putString(router.metricsText());
+            return STATUS_OK;
+        default:
+            return STATUS_INVALID;
+    }
+}
+
+size_t RequestHandler::process(ClientSession& session, const char* data, size_t size, RecordWriter& out,
+               long long& handled, bool& broken) {
+    size_t used = 0;
+    while (true) {
+        size_t frame = frameSize(data + used, size - used);
+        if (frame == SIZE_MAX) {
+            broken = true;
+            break;
+        }
+        if (frame == 0) break;
+
+        MetricTimer timer(METRIC_REQUEST);
+        RecordReader in(data + used + 4, frame - 4);
+        uint32_t requestID = in.getU32();
+        RequestOp op = (RequestOp)in.getU8();
+        size_t start = beginFrame(out, requestID, STATUS_OK);
+        size_t payload = out.bytes.size();
+        Status status = execute(session, op, in, out);
+        if (status != STATUS_OK) {
+            out.bytes.resize(payload);
+            out.bytes[payload - 1] = (char)status;
+        }
+        endFrame(out, start);
+        used += frame;
+        handled++;
+    }
+    return used;
+}
+
+#ifdef __linux__
+// ============== SOCKET SERVER (epoll) ==============
+void SocketServer::watch(int fd, Connection& connection, uint32_t events) {
+    if (connection.events == events) return;
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+    connection.events = events;
+}
+
+void SocketServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return;  // EAGAIN, or out of descriptors until a client leaves
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections[fd].events = EPOLLIN;
+        stats.accepted++;
+    }
+}
+
+bool SocketServer::flush(int fd, Connection& connection) {
+    string& bytes = connection.output.bytes;
+    while (connection.sent < bytes.size()) {
+        ssize_t n = send(fd, bytes.data() + connection.sent, bytes.size() - connection.sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            connection.sent += (size_t)n;
+            stats.bytesOut += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            return false;
+        }
+    }
+    size_t backlog = bytes.size() - connection.sent;
+    if (backlog == 0) {
+        bytes.clear();  // keeps its capacity for the next batch
+        connection.sent = 0;
+    }
+    uint32_t events = backlog == 0 ? EPOLLIN : backlog < SERVER_MAX_BACKLOG ? EPOLLIN | EPOLLOUT : EPOLLOUT;
+    watch(fd, connection, events);
+    return true;
+}
+
+bool SocketServer::serve(int fd, Connection& connection) {
+    bool open = true;
+    while (connection.output.bytes.size() - connection.sent < SERVER_MAX_BACKLOG) {
+        ssize_t n = read(fd, readBuffer.data(), readBuffer.size());
+        if (n > 0) {
+            connection.input.append(readBuffer.data(), (size_t)n);
+            stats.bytesIn += n;
+            if ((size_t)n < readBuffer.size()) break;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            open = false;  // closed by the client, or failed
+            break;
+        }
+    }
+
+    bool broken = false;
+    size_t used = handler.process(connection.session, connection.input.data(), connection.input.size(),
+                                  connection.output, stats.requests, broken);
+    connection.input.erase(0, used);
+    stats.reads++;
+    // Answers to a client that has finished sending still go out
+    return flush(fd, connection) && open && !broken;
+}
+
+bool SocketServer::listen(const string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) return false;
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    struct stat info;
+    if (stat(socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) return false;
+        unlink(socketPath.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (listenFd < 0 || epollFd < 0 ||
+        bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 ||
+        ::listen(listenFd, SOMAXCONN) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) != 0) {
+        close();
+        return false;
+    }
+    path = socketPath;
+    return true;
+}
+
+void SocketServer::run(const atomic<bool>& stop) {
+    epoll_event events[SERVER_MAX_EVENTS];
+    auto nextDump = chrono::steady_clock::now();
+    while (!stop) {
+        if (chrono::steady_clock::now() >= nextDump) {
+            router.writeMetrics();
+            nextDump = chrono::steady_clock::now() + chrono::seconds(METRICS_DUMP_SECONDS);
+        }
+        int ready = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, GROUP_COMMIT_MS);
+        if (ready < 0 && errno != EINTR) return;
+        if (ready <= 0) {
+            router.sync();
+            continue;
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            bool keep;
+            if (events[i].events & EPOLLIN) keep = serve(fd, it->second);
+            else if (events[i].events & EPOLLOUT) keep = flush(fd, it->second);
+            else keep = false;  // hang-up or error with nothing left to read
+            if (!keep) drop(fd);
+        }
+        router.checkpointIfNeeded();
+    }
+}
+
+void SocketServer::close() {
+    for (auto& entry : connections)
+        ::close(entry.first);
+    connections.clear();
+    if (epollFd >= 0) ::close(epollFd);
+    if (listenFd >= 0) ::close(listenFd);
+    if (!path.empty()) unlink(path.c_str());
+    epollFd = listenFd = -1;
+    path.clear();
+}
+#endif
@@ -0,0 +1,229 @@
+// Binary client protocol and the epoll socket server (Linux only).
+#ifndef ELEARNING_SERVER_H
+#define ELEARNING_SERVER_H
+
+#include "system.h"
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#endif
+
+// ============== CLIENT PROTOCOL ==============
+// Binary protocol of the socket server. Every message is a frame
+// [u32 length][u32 request id][u8 code][payload], little-endian, where the
+// length counts the bytes after itself. A request's code is a RequestOp; a
+// response echoes the request id and carries the operation's Status, with a
+// payload only when the status is STATUS_OK. Strings are [u32 length][bytes]
+// as in the log. Clients may pipeline: send any number of requests without
+// waiting, then match the responses, which come back in order, by id.
+const uint32_t MAX_FRAME_BYTES = 1 << 20;
+const uint32_t MAX_PAGE_ROWS = 200;
+
+enum RequestOp : uint8_t {
+    OP_LOGIN_STUDENT = 1,  // studentID, name, email
+    OP_LOGIN_LECTURER,     // grader name
+    OP_LOGOUT,
+    OP_LIST_ASSIGNMENTS,   // u32 offset, u32 limit -> u32 total, u32 rows, rows of (id, title, dueDate, maxScore)
+    OP_SEARCH_TITLE,       // title -> u32 rows, rows as above
+    OP_SUBMIT,             // assignmentID, file name in the upload root -> submissionID
+    OP_MY_SUBMISSIONS,     // u32 offset, u32 limit -> u32 total, u32 rows, rows of
+                           //   (submissionID, title, date, u8 status, score, feedback)
+    OP_MY_RANK,            // -> u32 rank (0 if unranked), u32 ranked students
+    OP_RANKINGS,           // u32 offset, u32 limit -> u32 total, u32 rows, rows of
+                           //   (studentID, name, totalScore, submissionCount)
+    OP_CREATE_ASSIGNMENT,  // title, description, dueDate, maxScore -> assignmentID
+    OP_PENDING,            // u32 offset, u32 limit -> u32 total, u32 rows, rows of
+                           //   (submissionID, studentName, title, date)
+    OP_GRADE,              // submissionID, score, feedback
+    OP_CLAIM_NEXT,         // u8 GradingPolicy -> submissionID
+    OP_COMPLETE_GRADING,   // submissionID, score, feedback
+    OP_STATS,              // -> metrics in Prometheus text format
+    OP_SELECT_COURSE,      // courseID, u8 create (lecturers only) -> later requests go to that course
+    OP_LIST_COURSES,       // -> u32 rows, rows of (courseID, u32 assignments, u32 submissions, u32 graded, u32 pending)
+    OP_REGRADE             // submissionID, score, feedback (the submission must be graded)
+};
+
+// Appends a frame header; endFrame fills in the length once the payload is written
+inline size_t beginFrame(RecordWriter& out, uint32_t requestID, uint8_t code) {
+    size_t start = out.bytes.size();
+    out.putU32(0);
+    out.putU32(requestID);
+    out.putU8(code);
+    return start;
+}
+
+inline void endFrame(RecordWriter& out, size_t start) {
+    out.setU32(start, (uint32_t)(out.bytes.size() - start - 4));
+}
+
+// Size of the complete frame at the start of data, 0 if more bytes are
+// needed, SIZE_MAX if the header is not one a client could have sent
+inline size_t frameSize(const char* data, size_t size) {
+    if (size < 4) return 0;
+    RecordReader header(data, 4);
+    uint32_t length = header.getU32();
+    if (length < 5 || length > MAX_FRAME_BYTES) return SIZE_MAX;
+    return size - 4 < length ? 0 : (size_t)length + 4;
+}
+
+enum SessionRole : uint8_t {
+    ROLE_NONE,
+    ROLE_STUDENT,
+    ROLE_LECTURER
+};
+
+// Per-connection state, in place of the menu's global currentStudent
+struct ClientSession {
+    SessionRole role = ROLE_NONE;
+    Student student{};
+    string grader;
+    ELearningSystem* course = nullptr;  // nullptr until a course is selected: DEFAULT_COURSE
+
+    // Where the last listing page ended, so a request for the next page
+    // resumes there instead of skipping from the top. Each is used only
+    // while the list's change count matches.
+    uint32_t assignmentsNext = UINT32_MAX;
+    DueDateCursor assignmentsCursor{};
+    uint64_t assignmentsVersion = 0;
+    uint32_t pendingNext = UINT32_MAX;
+    QueueCursor pendingCursor{};
+    long long pendingVersion = 0;
+};
+
+// Decodes request frames, runs them against the session's course and
+// appends the responses. It does no I/O itself. Like the menus it reads the
+// engine's members directly, so all calls must come from one thread.
+class RequestHandler {
+private:
+    CourseRouter& router;
+    ELearningSystem& general;
+    string uploadRoot;  // resolved; OP_SUBMIT is refused until one is set
+
+    // Arguments must fill the payload exactly
+    static bool complete(RecordReader& in) {
+        return in.ok() && in.atEnd();
+    }
+
+    static void putAssignment(RecordWriter& out, string_view id, string_view title,
+                              string_view dueDate, int maxScore);
+
+    // A submitted name is resolved inside uploadRoot, so a client can only
+    // have the server read files placed there for it. Absolute names and
+    // ".." are refused before the lookup, so nothing outside can be probed.
+    Status uploadPath(const string& name, string& path) const;
+
+    void listAssignments(ClientSession& session, uint32_t offset, uint32_t limit, RecordWriter& out);
+
+    void listPending(ClientSession& session, uint32_t offset, uint32_t limit, RecordWriter& out);
+
+    Status execute(ClientSession& session, RequestOp op, RecordReader& in, RecordWriter& out);
+
+public:
+    RequestHandler(CourseRouter& router) : router(router), general(router.defaultCourse()) {}
+
+    // Directory OP_SUBMIT names files in; false if it does not exist
+    bool setUploadRoot(const string& directory) {
+        return resolvePath(directory, uploadRoot);
+    }
+
+    // Handles every complete frame in [data, data + size), appending one
+    // response each, and returns the bytes consumed; the rest is a partial
+    // frame to retry when more arrives. *handled counts the frames.
+    // `broken` is set on a frame header no client could have sent.
+    size_t process(ClientSession& session, const char* data, size_t size, RecordWriter& out,
+                   long long& handled, bool& broken);
+};
+
+#ifdef __linux__
+// ============== SOCKET SERVER (epoll) ==============
+const int SERVER_MAX_EVENTS = 64;
+const size_t SERVER_READ_CHUNK = 64 * 1024;
+const size_t SERVER_MAX_BACKLOG = 4 << 20;  // unsent response bytes before a client stops being read
+const int METRICS_DUMP_SECONDS = 10;        // how often the server rewrites baseName.prom
+
+struct ServerStats {
+    long long accepted;
+    long long requests;
+    long long reads;      // read batches: each is decoded and answered with one write
+    long long bytesIn;
+    long long bytesOut;
+};
+
+// One thread serving many clients over a Unix domain socket. epoll reports
+// the sockets that are ready; everything a client has sent is read, every
+// complete frame in it is handled back to back, and all of their responses
+// leave in one write. A client whose responses back up stops being read
+// until they drain, so a slow reader cannot grow the server's memory.
+class SocketServer {
+private:
+    struct Connection {
+        ClientSession session;
+        string input;
+        RecordWriter output;
+        size_t sent = 0;
+        uint32_t events = 0;
+    };
+
+    CourseRouter& router;
+    RequestHandler handler;
+    string path;
+    int listenFd;
+    int epollFd;
+    unordered_map<int, Connection> connections;
+    vector<char> readBuffer;
+    ServerStats stats;
+
+    void watch(int fd, Connection& connection, uint32_t events);
+
+    void drop(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    }
+
+    void acceptClients();
+
+    // Sends what it can; false if the client is gone
+    bool flush(int fd, Connection& connection);
+
+    // Reads until the socket is drained, answers every complete frame and
+    // flushes the answers; false if the client should be dropped
+    bool serve(int fd, Connection& connection);
+
+public:
+    SocketServer(CourseRouter& router)
+        : router(router), handler(router), listenFd(-1), epollFd(-1), readBuffer(SERVER_READ_CHUNK), stats{} {}
+
+    // See RequestHandler::setUploadRoot; without one, submissions are refused
+    bool setUploadRoot(const string& directory) {
+        return handler.setUploadRoot(directory);
+    }
+
+    // Binds the socket at socketPath, replacing a stale socket file left
+    // by an earlier run; false if it cannot
+    bool listen(const string& socketPath);
+
+    // Serves until `stop` is set (e.g. by a signal handler). Batched log
+    // records are synced whenever the server is idle for a group-commit
+    // interval, the log is compacted as it would be from the menus, and
+    // the metrics file is rewritten every METRICS_DUMP_SECONDS.
+    void run(const atomic<bool>& stop);
+
+    ServerStats getStats() const {
+        return stats;
+    }
+
+    size_t clientCount() const {
+        return connections.size();
+    }
+
+    void close();
+
+    ~SocketServer() {
+        close();
+    }
+};
+#endif
+
+#endif
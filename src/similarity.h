@@ -0,0 +1,276 @@
+// Near-duplicate detection for submitted files.
+#ifndef ELEARNING_SIMILARITY_H
+#define ELEARNING_SIMILARITY_H
+
+#include "blobs.h"
+
+// ============== SIMILARITY (MinHash + LSH) ==============
+// Near-duplicate hints for graders. Each submitted file is read once, in
+// chunks, by a worker pool; every 8 consecutive non-space bytes (lower-
+// cased, so reformatting does not matter) form a shingle, and the file's
+// fingerprint is the minimum of MINHASH_SIZE hash functions over its
+// shingles. Equal fraction of two fingerprints estimates the Jaccard
+// similarity of the shingle sets. Fingerprints are banded into a
+// locality-sensitive hash index per assignment, so a query only compares
+// against submissions sharing at least one band.
+const int MINHASH_SIZE = 64;
+const int LSH_BANDS = 16;                    // of MINHASH_SIZE / LSH_BANDS rows each
+const double SIMILARITY_THRESHOLD = 0.5;     // hints below this are not reported
+const size_t SIMILARITY_CHUNK = 64 * 1024;
+
+struct Fingerprint {
+    uint32_t minimum[MINHASH_SIZE];
+};
+
+// Shingling state carried from one chunk of a file to the next
+struct ShingleWindow {
+    uint64_t bytes;      // last 8 normalized bytes
+    long long seen;      // normalized bytes so far
+
+    long long shingles() const { return max(seen - 7, 0LL); }
+};
+
+struct SimilarMatch {
+    uint32_t submissionID;
+    double similarity;  // estimated Jaccard similarity, 0..1
+};
+
+struct SimilarityStats {
+    long long queued;        // waiting for a worker
+    long long indexed;
+    long long unreadable;    // missing or unreadable files
+    long long tooShort;      // fewer than one shingle
+};
+
+class MinHasher {
+private:
+    uint32_t multiply[MINHASH_SIZE];
+    uint32_t add[MINHASH_SIZE];
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+public:
+    MinHasher() {
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (int i = 0; i < MINHASH_SIZE; i++) {
+            state = mix(state + 0x9E3779B97F4A7C15ULL);
+            multiply[i] = (uint32_t)state | 1;
+            add[i] = (uint32_t)(state >> 32);
+        }
+    }
+
+    // Folds one shingle into every lane. Plain arrays and no branches, so
+    // the compiler vectorizes the loop (four or eight lanes per instruction).
+    void addShingle(Fingerprint& print, uint64_t shingle) const {
+        uint32_t h = (uint32_t)mix(shingle);
+        for (int i = 0; i < MINHASH_SIZE; i++) {
+            uint32_t x = h * multiply[i] + add[i];
+            x ^= x >> 15;
+            x *= 0x2c1b3c6dU;
+            x ^= x >> 12;
+            print.minimum[i] = min(print.minimum[i], x);
+        }
+    }
+
+    static void begin(Fingerprint& print, ShingleWindow& window) {
+        fill(print.minimum, print.minimum + MINHASH_SIZE, UINT32_MAX);
+        window = ShingleWindow{0, 0};
+    }
+
+    // The next chunk of a document started with begin()
+    void addBytes(Fingerprint& print, ShingleWindow& window, const unsigned char* data, size_t size) const {
+        for (size_t i = 0; i < size; i++) {
+            unsigned char c = data[i];
+            if (isspace(c)) continue;
+            window.bytes = window.bytes << 8 | (unsigned char)tolower(c);
+            if (++window.seen >= 8) addShingle(print, window.bytes);
+        }
+    }
+
+    // Streams a file in fixed-size chunks; false if it cannot be read
+    bool fingerprintFile(const string& path, Fingerprint& print, ShingleWindow& window) const {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (in == nullptr) return false;
+        begin(print, window);
+        vector<unsigned char> buffer(SIMILARITY_CHUNK);
+        size_t got;
+        while ((got = fread(buffer.data(), 1, buffer.size(), in)) > 0)
+            addBytes(print, window, buffer.data(), got);
+        bool ok = !ferror(in);
+        fclose(in);
+        return ok;
+    }
+
+    static double similarity(const Fingerprint& a, const Fingerprint& b) {
+        int equal = 0;
+        for (int i = 0; i < MINHASH_SIZE; i++) equal += a.minimum[i] == b.minimum[i];
+        return (double)equal / MINHASH_SIZE;
+    }
+
+    static uint64_t bandKey(const Fingerprint& print, int band) {
+        const int rows = MINHASH_SIZE / LSH_BANDS;
+        uint64_t key = (uint64_t)band;
+        for (int r = 0; r < rows; r++) key = mix(key ^ ((uint64_t)print.minimum[band * rows + r] << 8));
+        return key;
+    }
+};
+
+// Fingerprints submissions on a pool of worker threads and answers
+// "similar submissions" queries. add() only queues the file, so the
+// submission path never waits for I/O; queries see a file once a worker
+// has indexed it.
+class SimilarityIndex {
+private:
+    struct Job {
+        uint32_t submissionID;
+        Symbol assignmentID;
+        string file;
+    };
+
+    struct AssignmentIndex {
+        unordered_map<uint64_t, vector<uint32_t>> buckets;  // band key -> submissions
+    };
+
+    struct Entry {
+        Symbol assignmentID;
+        Fingerprint print;
+    };
+
+    MinHasher hasher;
+    const BlobStore* blobs;   // where digests are read; set by start
+
+    mutex jobLock;
+    condition_variable jobReady;
+    deque<Job> jobs;
+    vector<thread> workers;
+    bool stopping;
+
+    mutable shared_mutex indexLock;
+    unordered_map<uint32_t, Entry> entries;
+    unordered_map<Symbol, AssignmentIndex> assignments;
+    atomic<long long> unreadable;
+    atomic<long long> tooShort;
+
+    void insert(const Job& job, const Fingerprint& print) {
+        unique_lock<shared_mutex> writing(indexLock);
+        if (!entries.emplace(job.submissionID, Entry{job.assignmentID, print}).second) return;
+        AssignmentIndex& index = assignments[job.assignmentID];
+        for (int band = 0; band < LSH_BANDS; band++)
+            index.buckets[MinHasher::bandKey(print, band)].push_back(job.submissionID);
+    }
+
+    void work() {
+        Fingerprint print;
+        for (;;) {
+            Job job;
+            {
+                unique_lock<mutex> guard(jobLock);
+                jobReady.wait(guard, [&] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = move(jobs.front());
+                jobs.pop_front();
+            }
+            ShingleWindow window;
+            bool read;
+            if (blobs != nullptr && isBlobDigest(job.file)) {
+                MinHasher::begin(print, window);
+                read = blobs->read(job.file, [&](const unsigned char* data, size_t size) {
+                    hasher.addBytes(print, window, data, size);
+                });
+            } else {
+                read = hasher.fingerprintFile(job.file, print, window);
+            }
+            if (!read) unreadable++;
+            else if (window.shingles() == 0) tooShort++;
+            else insert(job, print);
+        }
+    }
+
+public:
+    SimilarityIndex() : blobs(nullptr), stopping(false), unreadable(0), tooShort(0) {}
+
+    bool isRunning() const {
+        return !workers.empty();
+    }
+
+    // A blob digest is read from store, anything else opened as a path
+    void start(int threads, const BlobStore* store = nullptr) {
+        if (isRunning()) return;
+        blobs = store;
+        stopping = false;
+        for (int i = 0; i < max(threads, 1); i++)
+            workers.emplace_back([this] { work(); });
+    }
+
+    // Queued files are dropped; what was indexed stays queryable
+    void stop() {
+        {
+            lock_guard<mutex> guard(jobLock);
+            stopping = true;
+            jobs.clear();
+        }
+        jobReady.notify_all();
+        for (thread& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    void add(uint32_t submissionID, Symbol assignmentID, const string& file) {
+        {
+            lock_guard<mutex> guard(jobLock);
+            jobs.push_back(Job{submissionID, assignmentID, file});
+        }
+        jobReady.notify_one();
+    }
+
+    // Submissions of the same assignment estimated at least `threshold`
+    // similar, most similar first; empty if the file is not indexed (yet)
+    vector<SimilarMatch> similarTo(uint32_t submissionID, size_t limit = 5,
+                                   double threshold = SIMILARITY_THRESHOLD) const {
+        shared_lock<shared_mutex> reading(indexLock);
+        vector<SimilarMatch> matches;
+        auto self = entries.find(submissionID);
+        if (self == entries.end()) return matches;
+        const AssignmentIndex& index = assignments.at(self->second.assignmentID);
+        unordered_set<uint32_t> seen{submissionID};
+        for (int band = 0; band < LSH_BANDS; band++) {
+            auto bucket = index.buckets.find(MinHasher::bandKey(self->second.print, band));
+            if (bucket == index.buckets.end()) continue;
+            for (uint32_t candidate : bucket->second) {
+                if (!seen.insert(candidate).second) continue;
+                double similarity = MinHasher::similarity(self->second.print, entries.at(candidate).print);
+                if (similarity >= threshold) matches.push_back(SimilarMatch{candidate, similarity});
+            }
+        }
+        sort(matches.begin(), matches.end(), [](const SimilarMatch& a, const SimilarMatch& b) {
+            return a.similarity != b.similarity ? a.similarity > b.similarity : a.submissionID < b.submissionID;
+        });
+        if (matches.size() > limit) matches.resize(limit);
+        return matches;
+    }
+
+    bool isIndexed(uint32_t submissionID) const {
+        shared_lock<shared_mutex> reading(indexLock);
+        return entries.count(submissionID) > 0;
+    }
+
+    SimilarityStats stats() {
+        long long queued;
+        {
+            lock_guard<mutex> guard(jobLock);
+            queued = (long long)jobs.size();
+        }
+        shared_lock<shared_mutex> reading(indexLock);
+        return SimilarityStats{queued, (long long)entries.size(), unreadable.load(), tooShort.load()};
+    }
+
+    ~SimilarityIndex() {
+        stop();
+    }
+};
+
+#endif
@@ -0,0 +1,534 @@
+#include "storage.h"
+#include "history.h"
+
+// ============== WRITE-AHEAD LOG ==============
+void WriteAheadLog::append(LogRecordType type, RecordWriter& payload) {
+    if (file == nullptr) {
+        fail();
+        return;
+    }
+
+    RecordWriter body;
+    body.putU64(nextSequence++);
+    body.putU8((uint8_t)type);
+    body.bytes += payload.bytes;
+
+    RecordWriter header;
+    header.putU32((uint32_t)body.bytes.size());
+    header.putU32(checksum(body.bytes.data(), body.bytes.size()));
+
+    if (fwrite(header.bytes.data(), 1, header.bytes.size(), file) != header.bytes.size() ||
+        fwrite(body.bytes.data(), 1, body.bytes.size(), file) != body.bytes.size() ||
+        fflush(file) != 0) {
+        fail();
+        return;
+    }
+    recordsInLog++;
+    metrics().count(COUNTER_LOG_RECORDS);
+
+    if (unsyncedRecords == 0)
+        oldestUnsynced = chrono::steady_clock::now();
+    unsyncedRecords++;
+
+    auto age = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - oldestUnsynced);
+    if (unsyncedRecords >= GROUP_COMMIT_RECORDS || age.count() >= GROUP_COMMIT_MS)
+        sync();
+}
+
+bool WriteAheadLog::open(string logPath, uint64_t firstSequence, int existingRecords) {
+    path = logPath;
+    nextSequence = firstSequence;
+    recordsInLog = existingRecords;
+    file = fopen(path.c_str(), "ab");
+    return file != nullptr;
+}
+
+void WriteAheadLog::reset() {
+    if (file) fclose(file);
+    file = fopen(path.c_str(), "wb");
+    damaged = file == nullptr || !syncFile(file);
+    if (damaged) failedWrites++;
+    recordsInLog = 0;
+    unsyncedRecords = 0;
+}
+
+bool WriteAheadLog::sync() {
+    if (file == nullptr || unsyncedRecords == 0) return !damaged;
+    MetricTimer timer(METRIC_LOG_SYNC);
+    unsyncedRecords = 0;
+    if (!syncFile(file)) fail();
+    return !damaged;
+}
+
+void WriteAheadLog::close() {
+    if (file == nullptr) return;
+    sync();
+    fclose(file);
+    file = nullptr;
+}
+
+void WriteAheadLog::logCreateAssignment(Assignment* assg) {
+    RecordWriter payload;
+    payload.putString(assg->assignmentID);
+    payload.putString(assg->title);
+    payload.putString(assg->description);
+    payload.putString(assg->dueDate);
+    payload.putInt(assg->maxScore);
+    append(LOG_CREATE_ASSIGNMENT, payload);
+}
+
+void WriteAheadLog::logEditAssignment(Assignment* assg) {
+    RecordWriter payload;
+    payload.putString(assg->assignmentID);
+    payload.putString(assg->title);
+    payload.putString(assg->description);
+    payload.putString(assg->dueDate);
+    payload.putInt(assg->maxScore);
+    append(LOG_EDIT_ASSIGNMENT, payload);
+}
+
+void WriteAheadLog::logSubmit(Submission* sub) {
+    RecordWriter payload;
+    payload.putString(formatSubmissionID(sub->submissionID));
+    payload.putString(symbolText(sub->studentID));
+    payload.putString(symbolText(sub->studentName));
+    payload.putString(symbolText(sub->assignmentID));
+    payload.putString(symbolText(sub->assignmentTitle));
+    payload.putString(sub->submittedDate);
+    payload.putString(sub->file);
+    append(LOG_SUBMIT, payload);
+}
+
+void WriteAheadLog::logGrade(Submission* sub) {
+    RecordWriter payload;
+    payload.putString(formatSubmissionID(sub->submissionID));
+    payload.putInt(sub->score);
+    payload.putString(sub->feedback);
+    append(LOG_GRADE, payload);
+}
+
+void WriteAheadLog::logRegrade(const vector<RegradeEntry>& entries) {
+    RecordWriter payload;
+    payload.putU32((uint32_t)entries.size());
+    for (const RegradeEntry& entry : entries) {
+        payload.putString(formatSubmissionID(entry.submissionID));
+        payload.putInt(entry.score);
+        payload.putString(entry.feedback);
+    }
+    append(LOG_REGRADE, payload);
+}
+
+// ============== MAPPED SNAPSHOT ==============
+SnapshotStatus MappedSnapshot::open(string path) {
+    close();
+#ifdef _WIN32
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return SNAPSHOT_MISSING;
+    fseek(in, 0, SEEK_END);
+    long length = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if (length <= 0) { fclose(in); return SNAPSHOT_CORRUPT; }
+    char* buffer = new char[length];
+    bool complete = fread(buffer, 1, length, in) == (size_t)length;
+    fclose(in);
+    if (!complete) { delete[] buffer; return SNAPSHOT_CORRUPT; }
+    data = buffer;
+    size = length;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return SNAPSHOT_MISSING;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) { ::close(fd); return SNAPSHOT_CORRUPT; }
+    void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) return SNAPSHOT_CORRUPT;
+    data = static_cast<const char*>(view);
+    size = info.st_size;
+    mapped = true;
+#endif
+    if (size < sizeof(SnapHeader)) return SNAPSHOT_CORRUPT;
+
+    memcpy(&head, data, sizeof(SnapHeader));
+    SnapHeader unsummed = head;
+    unsummed.headerChecksum = 0;
+    if (head.magic != SNAPSHOT_MAGIC || head.version != SNAPSHOT_VERSION ||
+        head.byteOrder != SNAPSHOT_BYTE_ORDER || head.fileSize != size ||
+        checksum(reinterpret_cast<const char*>(&unsummed), sizeof(SnapHeader)) != head.headerChecksum)
+        return SNAPSHOT_CORRUPT;
+
+    if (!fits(head.stringsOffset, head.stringsSize, 1) ||
+        !fits(head.assignmentsOffset, head.assignmentCount, sizeof(SnapAssignment)) ||
+        !fits(head.byDueOffset, head.assignmentCount, sizeof(uint32_t)) ||
+        !fits(head.byTitleOffset, head.assignmentCount, sizeof(uint32_t)) ||
+        !fits(head.byAssignmentIDOffset, head.assignmentCount, sizeof(uint32_t)) ||
+        !fits(head.submissionsOffset, head.submissionCount, sizeof(SnapSubmission)) ||
+        !fits(head.bySubmissionIDOffset, head.submissionCount, sizeof(uint32_t)) ||
+        !fits(head.byStudentOffset, head.submissionCount, sizeof(uint32_t)) ||
+        !fits(head.studentsOffset, head.studentCount, sizeof(SnapStudent)))
+        return SNAPSHOT_CORRUPT;
+
+    return SNAPSHOT_OK;
+}
+
+void MappedSnapshot::close() {
+    if (data == nullptr) return;
+#ifdef _WIN32
+    delete[] data;
+#else
+    if (mapped) munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+long MappedSnapshot::findAssignment(string_view id) const {
+    auto keyOf = [&](uint32_t i) { return text(assignment(i).assignmentID); };
+    uint32_t pos = lowerBound(head.byAssignmentIDOffset, head.assignmentCount, id, keyOf);
+    if (pos == head.assignmentCount) return -1;
+    uint32_t index = order(head.byAssignmentIDOffset, head.assignmentCount, pos);
+    return keyOf(index) == id ? (long)index : -1;
+}
+
+long MappedSnapshot::findSubmission(string_view id) const {
+    auto keyOf = [&](uint32_t i) { return text(submission(i).submissionID); };
+    uint32_t pos = lowerBound(head.bySubmissionIDOffset, head.submissionCount, id, keyOf);
+    if (pos == head.submissionCount) return -1;
+    uint32_t index = order(head.bySubmissionIDOffset, head.submissionCount, pos);
+    return keyOf(index) == id ? (long)index : -1;
+}
+
+pair<uint32_t, uint32_t> MappedSnapshot::studentRange(string_view studentID) const {
+    auto keyOf = [&](uint32_t i) { return text(submission(i).studentID); };
+    uint32_t first = lowerBound(head.byStudentOffset, head.submissionCount, studentID, keyOf);
+    uint32_t last = first;
+    while (last < head.submissionCount && keyOf(byStudent(last)) == studentID)
+        last++;
+    return {first, last};
+}
+
+SnapString SnapshotWriter::addString(const string& value, bool dedupe) {
+    if (dedupe) {
+        auto it = shared.find(value);
+        if (it != shared.end()) return it->second;
+    }
+    SnapString ref{(uint32_t)strings.size(), (uint32_t)value.size()};
+    strings += value;
+    if (dedupe) shared[value] = ref;
+    return ref;
+}
+
+void SnapshotWriter::writeAt(FILE* out, uint64_t& written, uint64_t offset, const void* bytes, size_t length) {
+    static const char padding[8] = {0};
+    fwrite(padding, 1, offset - written, out);
+    if (length > 0) fwrite(bytes, 1, length, out);
+    written = offset + length;
+}
+
+void SnapshotWriter::addAssignment(const Assignment& assg) {
+    SnapAssignment record;
+    record.assignmentID = addString(assg.assignmentID, true);
+    record.title = addString(assg.title, true);
+    record.description = addString(assg.description, false);
+    record.dueDate = addString(assg.dueDate, true);
+    record.maxScore = assg.maxScore;
+    record.reserved = 0;
+    assignments.push_back(record);
+}
+
+void SnapshotWriter::addSubmission(const Submission& sub) {
+    SnapSubmission record;
+    record.submissionID = addString(formatSubmissionID(sub.submissionID), false);
+    record.studentID = addString(symbolText(sub.studentID), true);
+    record.studentName = addString(symbolText(sub.studentName), true);
+    record.assignmentID = addString(symbolText(sub.assignmentID), true);
+    record.assignmentTitle = addString(symbolText(sub.assignmentTitle), true);
+    record.submittedDate = addString(sub.submittedDate, true);
+    record.file = addString(sub.file, false);
+    record.feedback = addString(sub.feedback, true);
+    record.score = sub.score;
+    record.graded = sub.status == SUBMISSION_GRADED ? 1 : 0;
+    submissions.push_back(record);
+
+    if (record.graded) {
+        auto it = studentIndex.find(sub.studentID);
+        if (it == studentIndex.end()) {
+            studentIndex[sub.studentID] = (uint32_t)students.size();
+            students.push_back(SnapStudent{record.studentID, record.studentName, sub.score, 1});
+        } else {
+            students[it->second].totalScore += sub.score;
+            students[it->second].submissionCount++;
+        }
+    }
+}
+
+bool SnapshotWriter::write(string path, uint64_t lastSequence, int assignmentCounter, int submissionCounter) {
+    uint32_t assignmentTotal = (uint32_t)assignments.size();
+    uint32_t submissionTotal = (uint32_t)submissions.size();
+
+    auto sequence = [](uint32_t count) {
+        vector<uint32_t> order(count);
+        for (uint32_t i = 0; i < count; i++) order[i] = i;
+        return order;
+    };
+
+    // Same order as the linked list: by due date, oldest first on ties
+    vector<uint32_t> byDue = sequence(assignmentTotal);
+    stable_sort(byDue.begin(), byDue.end(), [&](uint32_t a, uint32_t b) {
+        return text(assignments[a].dueDate) < text(assignments[b].dueDate);
+    });
+    vector<uint32_t> byTitle = sequence(assignmentTotal);
+    sort(byTitle.begin(), byTitle.end(), [&](uint32_t a, uint32_t b) {
+        int cmp = text(assignments[a].title).compare(text(assignments[b].title));
+        return cmp != 0 ? cmp < 0 : text(assignments[a].assignmentID) < text(assignments[b].assignmentID);
+    });
+    vector<uint32_t> byAssignmentID = sequence(assignmentTotal);
+    sort(byAssignmentID.begin(), byAssignmentID.end(), [&](uint32_t a, uint32_t b) {
+        return text(assignments[a].assignmentID) < text(assignments[b].assignmentID);
+    });
+    vector<uint32_t> bySubmissionID = sequence(submissionTotal);
+    sort(bySubmissionID.begin(), bySubmissionID.end(), [&](uint32_t a, uint32_t b) {
+        return text(submissions[a].submissionID) < text(submissions[b].submissionID);
+    });
+    vector<uint32_t> byStudent = sequence(submissionTotal);
+    stable_sort(byStudent.begin(), byStudent.end(), [&](uint32_t a, uint32_t b) {
+        return text(submissions[a].studentID) < text(submissions[b].studentID);
+    });
+    sort(students.begin(), students.end(), [&](const SnapStudent& a, const SnapStudent& b) {
+        return text(a.studentID) < text(b.studentID);
+    });
+
+    SnapHeader head;
+    memset(&head, 0, sizeof(head));
+    head.magic = SNAPSHOT_MAGIC;
+    head.version = SNAPSHOT_VERSION;
+    head.byteOrder = SNAPSHOT_BYTE_ORDER;
+    head.lastSequence = lastSequence;
+    head.assignmentCounter = assignmentCounter;
+    head.submissionCounter = submissionCounter;
+    head.assignmentCount = assignmentTotal;
+    head.submissionCount = submissionTotal;
+    head.studentCount = (uint32_t)students.size();
+
+    uint64_t offset = align(sizeof(SnapHeader));
+    head.stringsOffset = offset;
+    head.stringsSize = strings.size();
+    offset = align(offset + strings.size());
+    head.assignmentsOffset = offset;
+    offset = align(offset + assignmentTotal * sizeof(SnapAssignment));
+    head.byDueOffset = offset;
+    offset = align(offset + assignmentTotal * sizeof(uint32_t));
+    head.byTitleOffset = offset;
+    offset = align(offset + assignmentTotal * sizeof(uint32_t));
+    head.byAssignmentIDOffset = offset;
+    offset = align(offset + assignmentTotal * sizeof(uint32_t));
+    head.submissionsOffset = offset;
+    offset = align(offset + submissionTotal * sizeof(SnapSubmission));
+    head.bySubmissionIDOffset = offset;
+    offset = align(offset + submissionTotal * sizeof(uint32_t));
+    head.byStudentOffset = offset;
+    offset = align(offset + submissionTotal * sizeof(uint32_t));
+    head.studentsOffset = offset;
+    offset = offset + students.size() * sizeof(SnapStudent);
+    head.fileSize = offset;
+    head.headerChecksum = checksum(reinterpret_cast<const char*>(&head), sizeof(head));
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == nullptr) return false;
+    uint64_t written = 0;
+    writeAt(out, written, 0, &head, sizeof(head));
+    writeAt(out, written, head.stringsOffset, strings.data(), strings.size());
+    writeAt(out, written, head.assignmentsOffset, assignments.data(), assignmentTotal * sizeof(SnapAssignment));
+    writeAt(out, written, head.byDueOffset, byDue.data(), assignmentTotal * sizeof(uint32_t));
+    writeAt(out, written, head.byTitleOffset, byTitle.data(), assignmentTotal * sizeof(uint32_t));
+    writeAt(out, written, head.byAssignmentIDOffset, byAssignmentID.data(), assignmentTotal * sizeof(uint32_t));
+    writeAt(out, written, head.submissionsOffset, submissions.data(), submissionTotal * sizeof(SnapSubmission));
+    writeAt(out, written, head.bySubmissionIDOffset, bySubmissionID.data(), submissionTotal * sizeof(uint32_t));
+    writeAt(out, written, head.byStudentOffset, byStudent.data(), submissionTotal * sizeof(uint32_t));
+    writeAt(out, written, head.studentsOffset, students.data(), students.size() * sizeof(SnapStudent));
+    bool ok = !ferror(out);
+    syncFile(out);
+    fclose(out);
+    return ok;
+}
+
+// ============== PERSISTENT STORAGE ==============
+bool Storage::applyRecord(LogRecordType type, RecordReader& reader) {
+    if (type == LOG_CREATE_ASSIGNMENT) {
+        string id = reader.getString();
+        string title = reader.getString();
+        string description = reader.getString();
+        string dueDate = reader.getString();
+        int maxScore = reader.getInt();
+        if (!reader.ok()) return false;
+        history.recordCreation(assignments.restoreAssignment(id, title, description, dueDate, maxScore));
+        return true;
+    }
+    if (type == LOG_EDIT_ASSIGNMENT) {
+        string id = reader.getString();
+        AssignmentSpec spec;
+        spec.title = reader.getString();
+        spec.description = reader.getString();
+        spec.dueDate = reader.getString();
+        spec.maxScore = reader.getInt();
+        return reader.ok() && history.editAssignment(id, spec) == STATUS_OK;
+    }
+    if (type == LOG_DELETE_ASSIGNMENT) {
+        string id = reader.getString();
+        return reader.ok() && history.deleteAssignment(id) == STATUS_OK;
+    }
+    if (type == LOG_UNDO) return history.undo() == STATUS_OK;
+    if (type == LOG_REDO) return history.redo() == STATUS_OK;
+    if (type == LOG_SUBMIT) {
+        string submissionID = reader.getString();
+        string studentID = reader.getString();
+        string studentName = reader.getString();
+        string assignmentID = reader.getString();
+        string assignmentTitle = reader.getString();
+        string submittedDate = reader.getString();
+        string file = reader.getString();
+        if (!reader.ok()) return false;
+        return submissions.restoreSubmission(submissionID, studentID, studentName, assignmentID,
+                                             assignmentTitle, submittedDate, file);
+    }
+    if (type == LOG_GRADE) {
+        string submissionID = reader.getString();
+        int score = reader.getInt();
+        string feedback = reader.getString();
+        if (!reader.ok() || !submissions.restoreGrade(submissionID, score, feedback)) return false;
+        history.recordGrade(submissionID);
+        return true;
+    }
+    if (type == LOG_REGRADE) {
+        uint32_t total = reader.getU32();
+        vector<RegradeEntry> entries;
+        for (uint32_t i = 0; i < total && reader.ok(); i++) {
+            RegradeEntry entry{parseSubmissionID(reader.getString()), 0, 0, "", ""};
+            entry.score = reader.getInt();
+            entry.feedback = reader.getString();
+            entries.push_back(entry);
+        }
+        if (!reader.ok()) return false;
+        submissions.applyRegrades(entries);
+        if (entries.empty()) return false;
+        history.recordRegrade(entries);
+        return entries.size() == total;
+    }
+    return false;
+}
+
+void Storage::loadHistory() {
+    FILE* in = fopen(historyPath.c_str(), "rb");
+    if (in == nullptr) return;
+    string bytes;
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        bytes.append(buffer, got);
+    fclose(in);
+
+    RecordReader header(bytes.data(), bytes.size());
+    uint32_t magic = header.getU32();
+    uint32_t version = header.getU32();
+    uint64_t sequence = header.getU64();
+    uint32_t length = header.getU32();
+    uint32_t expected = header.getU32();
+    if (!header.ok() || magic != HISTORY_MAGIC || version < 1 || version > HISTORY_VERSION ||
+        sequence != snapshotSequence || bytes.size() != 24 + (size_t)length ||
+        checksum(bytes.data() + 24, length) != expected)
+        return;
+    RecordReader reader(bytes.data() + 24, length);
+    history.load(reader, version);
+}
+
+void Storage::saveHistory() {
+    RecordWriter payload;
+    history.save(payload);
+    RecordWriter file;
+    file.putU32(HISTORY_MAGIC);
+    file.putU32(HISTORY_VERSION);
+    file.putU64(snapshotSequence);
+    file.putU32((uint32_t)payload.bytes.size());
+    file.putU32(checksum(payload.bytes.data(), payload.bytes.size()));
+    file.bytes += payload.bytes;
+
+    string tempPath = historyPath + ".tmp";
+    FILE* out = fopen(tempPath.c_str(), "wb");
+    if (out == nullptr) return;
+    bool written = fwrite(file.bytes.data(), 1, file.bytes.size(), out) == file.bytes.size();
+    syncFile(out);
+    fclose(out);
+#ifdef _WIN32
+    remove(historyPath.c_str());
+#endif
+    if (!written || rename(tempPath.c_str(), historyPath.c_str()) != 0)
+        remove(tempPath.c_str());
+}
+
+bool Storage::open(string baseName) {
+    snapshotPath = baseName + ".snap";
+    logPath = baseName + ".wal";
+    historyPath = baseName + ".hist";
+
+    SnapshotStatus status = snapshot.open(snapshotPath);
+    if (status == SNAPSHOT_CORRUPT) return false;
+    if (status == SNAPSHOT_OK) {
+        snapshotSequence = snapshot.header().lastSequence;
+        assignments.attachBase(&snapshot);
+        submissions.attachBase(&snapshot);
+        loadHistory();
+    }
+
+    uint64_t lastSequence = snapshotSequence;
+    int records = 0;
+    skippedRecords = 0;
+    bool clean = WriteAheadLog::replay(logPath, lastSequence, records,
+        [&](uint64_t sequence, LogRecordType type, RecordReader& reader) {
+            if (sequence <= snapshotSequence) return;
+            if (!applyRecord(type, reader)) skippedRecords++;
+        });
+
+    if (!wal.open(logPath, lastSequence + 1, records)) return false;
+    assignments.attachLog(&wal);
+    submissions.attachLog(&wal);
+    history.attachLog(&wal);
+    enabled = true;
+
+    // A torn tail must be cut off before new records are appended after it
+    if (!clean || records >= SNAPSHOT_EVERY_RECORDS)
+        checkpoint();
+    return true;
+}
+
+bool Storage::checkpoint() {
+    if (!enabled) return false;
+    MetricTimer timer(METRIC_CHECKPOINT);
+    wal.sync();
+
+    SnapshotWriter writer;
+    assignments.forEachAssignment([&](const Assignment& assg) { writer.addAssignment(assg); });
+    submissions.forEachSubmission([&](const Submission& sub) { writer.addSubmission(sub); });
+
+    string tempPath = snapshotPath + ".tmp";
+    if (!writer.write(tempPath, wal.getNextSequence() - 1,
+                      assignments.getCounter(), submissions.getCounter()))
+        return false;
+
+#ifdef _WIN32
+    remove(snapshotPath.c_str());
+#endif
+    if (rename(tempPath.c_str(), snapshotPath.c_str()) != 0)
+        return false;
+    snapshotSequence = wal.getNextSequence() - 1;
+    wal.reset();
+    saveHistory();
+    return true;
+}
+
+void Storage::close() {
+    if (!enabled) return;
+    if (wal.getRecordCount() > 0 || wal.isDamaged())
+        checkpoint();
+    wal.close();
+    enabled = false;
+}
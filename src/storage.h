@@ -0,0 +1,518 @@
+// Durability: the write-ahead log, the mapped snapshot and the Storage
+// that ties them to the in-memory state.
+#ifndef ELEARNING_STORAGE_H
+#define ELEARNING_STORAGE_H
+
+#include "core.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// Storage replays into these; their definitions follow in the later headers
+class AssignmentLinkedList;
+class SubmissionQueue;
+class ChangeHistory;
+
+// ============== WRITE-AHEAD LOG ==============
+enum LogRecordType {
+    LOG_CREATE_ASSIGNMENT = 1,
+    LOG_SUBMIT = 3,
+    LOG_GRADE = 4,
+    LOG_EDIT_ASSIGNMENT = 5,
+    LOG_DELETE_ASSIGNMENT = 6,
+    LOG_UNDO = 7,               // step back / forward in ChangeHistory
+    LOG_REDO = 8,
+    LOG_REGRADE = 9             // a batch of new grades for graded submissions
+};
+
+const int GROUP_COMMIT_RECORDS = 32;   // fsync after this many records...
+const int GROUP_COMMIT_MS = 200;       // ...or once the oldest unsynced record is this old
+
+// FNV-1a, used to detect torn or corrupt records
+inline uint32_t checksum(const char* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Forces written data to stable storage; false if it did not get there
+inline bool syncFile(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Little-endian binary encoder shared by the log and snapshots
+class RecordWriter {
+public:
+    string bytes;
+
+    void putU8(uint8_t value) { bytes.push_back((char)value); }
+
+    void putU32(uint32_t value) {
+        for (int i = 0; i < 4; i++) bytes.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+
+    void putU64(uint64_t value) {
+        for (int i = 0; i < 8; i++) bytes.push_back((char)((value >> (8 * i)) & 0xFF));
+    }
+
+    void putInt(int value) { putU32((uint32_t)value); }
+
+    void putString(string_view value) {
+        putU32((uint32_t)value.size());
+        bytes += value;
+    }
+
+    // Overwrites four bytes written earlier, e.g. a count known only later
+    void setU32(size_t pos, uint32_t value) {
+        for (int i = 0; i < 4; i++) bytes[pos + i] = (char)((value >> (8 * i)) & 0xFF);
+    }
+};
+
+class RecordReader {
+private:
+    const char* data;
+    size_t size;
+    size_t pos;
+    bool valid;
+
+    bool need(size_t n) {
+        if (!valid || size - pos < n) valid = false;
+        return valid;
+    }
+
+public:
+    RecordReader(const char* data, size_t size) : data(data), size(size), pos(0), valid(true) {}
+
+    uint8_t getU8() {
+        if (!need(1)) return 0;
+        return (uint8_t)data[pos++];
+    }
+
+    uint32_t getU32() {
+        if (!need(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= (uint32_t)(unsigned char)data[pos++] << (8 * i);
+        return value;
+    }
+
+    uint64_t getU64() {
+        if (!need(8)) return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= (uint64_t)(unsigned char)data[pos++] << (8 * i);
+        return value;
+    }
+
+    int getInt() { return (int)getU32(); }
+
+    string getString() {
+        uint32_t length = getU32();
+        if (!need(length)) return "";
+        string value(data + pos, length);
+        pos += length;
+        return value;
+    }
+
+    bool ok() { return valid; }
+    bool atEnd() { return pos == size; }
+};
+
+// Each record is [u32 length][u32 checksum][u64 sequence][u8 type][payload].
+// Records reach the OS on every append; fsync is batched (group commit).
+class WriteAheadLog {
+private:
+    FILE* file;
+    string path;
+    uint64_t nextSequence;
+    int unsyncedRecords;
+    chrono::steady_clock::time_point oldestUnsynced;
+    int recordsInLog;
+    uint64_t failedWrites;  // appends and syncs that did not reach the disk, ever
+    bool damaged;           // one of them since the last reset: the file may end in a partial record
+
+    void fail() {
+        if (file) clearerr(file);
+        failedWrites++;
+        damaged = true;
+    }
+
+    // Only called once open succeeded, so no file means reset could not reopen it
+    void append(LogRecordType type, RecordWriter& payload);
+
+public:
+    WriteAheadLog() : file(nullptr), nextSequence(1), unsyncedRecords(0), recordsInLog(0), failedWrites(0),
+                      damaged(false) {}
+
+    bool open(string logPath, uint64_t firstSequence, int existingRecords);
+
+    // Starts an empty log once a snapshot covers everything in it
+    void reset();
+
+    // False if the records written since the last sync may not be on disk
+    bool sync();
+
+    void close();
+
+    // Calls apply(sequence, type, reader) for every intact record; stops at a torn tail
+    template <typename Apply>
+    static bool replay(string logPath, uint64_t& lastSequence, int& records, Apply apply) {
+        records = 0;
+        FILE* in = fopen(logPath.c_str(), "rb");
+        if (in == nullptr) return true;
+
+        bool clean = true;
+        char header[8];
+        string body;
+        while (true) {
+            size_t got = fread(header, 1, 8, in);
+            if (got == 0) break;
+            if (got < 8) { clean = false; break; }
+
+            RecordReader headerReader(header, 8);
+            uint32_t length = headerReader.getU32();
+            uint32_t expected = headerReader.getU32();
+            if (length < 9) { clean = false; break; }
+
+            body.resize(length);
+            if (fread(&body[0], 1, length, in) != length || checksum(body.data(), length) != expected) {
+                clean = false;
+                break;
+            }
+
+            RecordReader reader(body.data(), length);
+            uint64_t sequence = reader.getU64();
+            LogRecordType type = (LogRecordType)reader.getU8();
+            apply(sequence, type, reader);
+            lastSequence = sequence;
+            records++;
+        }
+        fclose(in);
+        return clean;
+    }
+
+    void logCreateAssignment(Assignment* assg);
+
+    void logEditAssignment(Assignment* assg);
+
+    void logDeleteAssignment(const string& assignmentID) {
+        RecordWriter payload;
+        payload.putString(assignmentID);
+        append(LOG_DELETE_ASSIGNMENT, payload);
+    }
+
+    void logUndo() {
+        RecordWriter payload;
+        append(LOG_UNDO, payload);
+    }
+
+    void logRedo() {
+        RecordWriter payload;
+        append(LOG_REDO, payload);
+    }
+
+    void logSubmit(Submission* sub);
+
+    void logGrade(Submission* sub);
+
+    void logRegrade(const vector<RegradeEntry>& entries);
+
+    uint64_t getNextSequence() { return nextSequence; }
+    int getRecordCount() { return recordsInLog; }
+    uint64_t getFailedWrites() { return failedWrites; }
+    bool isDamaged() { return damaged; }
+
+    ~WriteAheadLog() {
+        close();
+    }
+};
+
+// ============== MAPPED SNAPSHOT ==============
+const uint32_t SNAPSHOT_MAGIC = 0x50414E53; // "SNAP"
+const uint32_t SNAPSHOT_VERSION = 2;        // flat layout, served straight from mmap
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// Flat, versioned snapshot. Every section is 8-byte aligned; strings are
+// (offset, length) pairs into one string table, and the index arrays hold
+// record numbers already sorted, so the file is used as-is once mapped.
+struct SnapString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct SnapAssignment {
+    SnapString assignmentID;
+    SnapString title;
+    SnapString description;
+    SnapString dueDate;
+    int32_t maxScore;
+    uint32_t reserved;
+};
+
+struct SnapSubmission {
+    SnapString submissionID;
+    SnapString studentID;
+    SnapString studentName;
+    SnapString assignmentID;
+    SnapString assignmentTitle;
+    SnapString submittedDate;
+    SnapString file;
+    SnapString feedback;
+    int32_t score;
+    uint32_t graded;
+};
+
+struct SnapStudent {
+    SnapString studentID;
+    SnapString name;
+    int32_t totalScore;
+    int32_t submissionCount;
+};
+
+struct SnapHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t headerChecksum;       // over this header with this field zeroed
+    uint64_t fileSize;
+    uint64_t lastSequence;         // last log record covered
+    uint32_t assignmentCounter;
+    uint32_t submissionCounter;
+    uint32_t assignmentCount;
+    uint32_t submissionCount;
+    uint32_t studentCount;
+    uint32_t reserved;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t assignmentsOffset;    // SnapAssignment[], creation order
+    uint64_t byDueOffset;          // uint32_t[], due-date list order
+    uint64_t byTitleOffset;        // uint32_t[], by (title, ID)
+    uint64_t byAssignmentIDOffset; // uint32_t[], by ID
+    uint64_t submissionsOffset;    // SnapSubmission[], FIFO order
+    uint64_t bySubmissionIDOffset; // uint32_t[], by ID
+    uint64_t byStudentOffset;      // uint32_t[], by (student ID, FIFO order)
+    uint64_t studentsOffset;       // SnapStudent[], graded totals by student ID
+};
+
+enum SnapshotStatus {
+    SNAPSHOT_MISSING,
+    SNAPSHOT_OK,
+    SNAPSHOT_CORRUPT
+};
+
+// Read-only view of a snapshot file. Opening validates only the header and
+// section bounds; records are read from the mapped pages when queried.
+class MappedSnapshot {
+private:
+    const char* data;
+    size_t size;
+    bool mapped;  // false when the file was read into memory instead
+    SnapHeader head;
+
+    template <typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(data + offset);
+    }
+
+    bool fits(uint64_t offset, uint64_t count, size_t elementSize) const {
+        return offset % 8 == 0 && offset <= size && count <= (size - offset) / elementSize;
+    }
+
+    uint32_t order(uint64_t offset, uint32_t count, uint32_t pos) const {
+        uint32_t index = section<uint32_t>(offset)[pos];
+        return index < count ? index : 0;
+    }
+
+    // First position in an index array whose key is not less than key
+    template <typename KeyOf>
+    uint32_t lowerBound(uint64_t offset, uint32_t count, string_view key, KeyOf keyOf) const {
+        uint32_t low = 0, high = count;
+        while (low < high) {
+            uint32_t mid = low + (high - low) / 2;
+            if (keyOf(order(offset, count, mid)) < key)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+public:
+    MappedSnapshot() : data(nullptr), size(0), mapped(false), head() {}
+
+    SnapshotStatus open(string path);
+
+    void close();
+
+    const SnapHeader& header() const { return head; }
+
+    string_view text(const SnapString& ref) const {
+        if (ref.offset > head.stringsSize || ref.length > head.stringsSize - ref.offset)
+            return string_view();
+        return string_view(data + head.stringsOffset + ref.offset, ref.length);
+    }
+
+    uint32_t assignmentCount() const { return head.assignmentCount; }
+    const SnapAssignment& assignment(uint32_t index) const {
+        return section<SnapAssignment>(head.assignmentsOffset)[index];
+    }
+    uint32_t byDue(uint32_t pos) const { return order(head.byDueOffset, head.assignmentCount, pos); }
+    uint32_t byTitle(uint32_t pos) const { return order(head.byTitleOffset, head.assignmentCount, pos); }
+
+    // Record number, or -1
+    long findAssignment(string_view id) const;
+
+    // First position in byDue with a due date >= dueDate
+    uint32_t dueLowerBound(string_view dueDate) const {
+        return lowerBound(head.byDueOffset, head.assignmentCount, dueDate,
+                          [&](uint32_t i) { return text(assignment(i).dueDate); });
+    }
+
+    uint32_t titleLowerBound(string_view title) const {
+        return lowerBound(head.byTitleOffset, head.assignmentCount, title,
+                          [&](uint32_t i) { return text(assignment(i).title); });
+    }
+
+    uint32_t submissionCount() const { return head.submissionCount; }
+    const SnapSubmission& submission(uint32_t index) const {
+        return section<SnapSubmission>(head.submissionsOffset)[index];
+    }
+    uint32_t byStudent(uint32_t pos) const { return order(head.byStudentOffset, head.submissionCount, pos); }
+
+    long findSubmission(string_view id) const;
+
+    // Positions [first, second) in student order belonging to studentID
+    pair<uint32_t, uint32_t> studentRange(string_view studentID) const;
+
+    uint32_t studentCount() const { return head.studentCount; }
+    const SnapStudent& student(uint32_t index) const {
+        return section<SnapStudent>(head.studentsOffset)[index];
+    }
+
+    ~MappedSnapshot() {
+        close();
+    }
+};
+
+// Builds a version 2 snapshot from records streamed in creation/FIFO order
+class SnapshotWriter {
+private:
+    string strings;
+    unordered_map<string, SnapString> shared;  // repeated names, titles, IDs and dates
+    vector<SnapAssignment> assignments;
+    vector<SnapSubmission> submissions;
+    vector<SnapStudent> students;
+    unordered_map<Symbol, uint32_t> studentIndex;
+
+    SnapString addString(const string& value, bool dedupe);
+
+    string_view text(const SnapString& ref) const {
+        return string_view(strings.data() + ref.offset, ref.length);
+    }
+
+    static uint64_t align(uint64_t offset) {
+        return (offset + 7) & ~(uint64_t)7;
+    }
+
+    static void writeAt(FILE* out, uint64_t& written, uint64_t offset, const void* bytes, size_t length);
+
+public:
+    void addAssignment(const Assignment& assg);
+
+    void addSubmission(const Submission& sub);
+
+    bool write(string path, uint64_t lastSequence, int assignmentCounter, int submissionCounter);
+};
+
+// ============== PERSISTENT STORAGE ==============
+const int SNAPSHOT_EVERY_RECORDS = 1000;    // compact once the log holds this many records
+const uint32_t HISTORY_MAGIC = 0x54534948;  // "HIST"
+const uint32_t HISTORY_VERSION = 2;         // 1 had no regrades; still read
+
+// Snapshot + log tail. Startup maps the snapshot (no parsing) and replays
+// only the log records written after it, so restart time is bounded by the
+// compaction interval rather than the size of the history.
+class Storage {
+private:
+    AssignmentLinkedList& assignments;
+    SubmissionQueue& submissions;
+    ChangeHistory& history;
+    WriteAheadLog wal;
+    MappedSnapshot snapshot;
+    string snapshotPath;
+    string logPath;
+    string historyPath;
+    uint64_t snapshotSequence;  // last log sequence covered by the snapshot
+    int skippedRecords;         // log records at open that did not apply
+    uint64_t reportedFailures;  // failed log writes already returned by logged()
+    bool enabled;
+
+    // Returns false if the record does not fit the current state
+    bool applyRecord(LogRecordType type, RecordReader& reader);
+
+    // The undo history is kept in its own small file, tagged with the log
+    // sequence of the snapshot it belongs to: [magic][version][sequence]
+    // [length][checksum][payload]. A missing or stale file means no history.
+    void loadHistory();
+
+    // Best effort: without the file, undo history simply starts empty
+    void saveHistory();
+
+public:
+    Storage(AssignmentLinkedList& assignments, SubmissionQueue& submissions, ChangeHistory& history)
+        : assignments(assignments), submissions(submissions), history(history), snapshotSequence(0),
+          skippedRecords(0), reportedFailures(0), enabled(false) {}
+
+    // Loads saved state; false means the snapshot is unreadable and nothing will be saved
+    bool open(string baseName);
+
+    // Writes a full snapshot atomically (temp file + rename), then empties the log.
+    // The running process keeps serving from its current mapping. False if the
+    // snapshot could not be written; the log is then kept as it is.
+    bool checkpoint();
+
+    bool isEnabled() {
+        return enabled;
+    }
+
+    int getSkippedRecords() {
+        return skippedRecords;
+    }
+
+    // False only if a checkpoint was due and failed. A log that failed a
+    // write is due at once: the snapshot then covers what it lost.
+    bool checkpointIfNeeded() {
+        if (enabled && (wal.getRecordCount() >= SNAPSHOT_EVERY_RECORDS || wal.isDamaged()))
+            return checkpoint();
+        return true;
+    }
+
+    // False if acknowledged changes may not be on disk yet
+    bool sync() {
+        return !enabled || wal.sync();
+    }
+
+    // The facade's result for a change: STATUS_FILE_ERROR instead of
+    // STATUS_OK if a log write failed since the last call. The change is
+    // kept in memory and is saved by the next successful checkpoint.
+    Status logged(Status status) {
+        if (wal.getFailedWrites() == reportedFailures) return status;
+        reportedFailures = wal.getFailedWrites();
+        return status == STATUS_OK ? STATUS_FILE_ERROR : status;
+    }
+
+    // Clean shutdown leaves just a snapshot, so the next start replays nothing
+    void close();
+
+    ~Storage() {
+        close();
+    }
+};
+
+#endif
@@ -0,0 +1,1657 @@
+// Submissions: ranking, concurrent intake, the columnar store, grade
+// views and the queue that owns them.
+#ifndef ELEARNING_SUBMISSIONS_H
+#define ELEARNING_SUBMISSIONS_H
+
+#include "assignments.h"
+
+// ============== RANKING TREE (Order-Statistics AVL) ==============
+struct RankNode {
+    Student* student;
+    int height;
+    int size;        // nodes in this subtree, used for rank/select
+    RankNode* left;
+    RankNode* right;
+};
+
+class RankingTree {
+private:
+    RankNode* root;
+    unordered_map<string, Student> totals;  // studentID -> aggregate
+    ObjectPool<RankNode> nodePool;
+
+    // Higher total first, ties broken by student ID
+    bool ranksBefore(Student* a, Student* b) {
+        if (a->totalScore != b->totalScore)
+            return a->totalScore > b->totalScore;
+        return a->studentID < b->studentID;
+    }
+
+    int height(RankNode* node) { return node ? node->height : 0; }
+    int size(RankNode* node) { return node ? node->size : 0; }
+
+    void update(RankNode* node) {
+        node->height = 1 + max(height(node->left), height(node->right));
+        node->size = 1 + size(node->left) + size(node->right);
+    }
+
+    RankNode* rotateRight(RankNode* node) {
+        RankNode* pivot = node->left;
+        node->left = pivot->right;
+        pivot->right = node;
+        update(node);
+        update(pivot);
+        return pivot;
+    }
+
+    RankNode* rotateLeft(RankNode* node) {
+        RankNode* pivot = node->right;
+        node->right = pivot->left;
+        pivot->left = node;
+        update(node);
+        update(pivot);
+        return pivot;
+    }
+
+    RankNode* balance(RankNode* node) {
+        update(node);
+        int factor = height(node->left) - height(node->right);
+        if (factor > 1) {
+            if (height(node->left->left) < height(node->left->right))
+                node->left = rotateLeft(node->left);
+            return rotateRight(node);
+        }
+        if (factor < -1) {
+            if (height(node->right->right) < height(node->right->left))
+                node->right = rotateRight(node->right);
+            return rotateLeft(node);
+        }
+        return node;
+    }
+
+    RankNode* insert(RankNode* node, Student* student) {
+        if (!node) {
+            RankNode* newNode = nodePool.allocate();
+            *newNode = RankNode{student, 1, 1, nullptr, nullptr};
+            return newNode;
+        }
+        if (ranksBefore(student, node->student))
+            node->left = insert(node->left, student);
+        else
+            node->right = insert(node->right, student);
+        return balance(node);
+    }
+
+    RankNode* removeMin(RankNode* node, RankNode*& minNode) {
+        if (!node->left) {
+            minNode = node;
+            return node->right;
+        }
+        node->left = removeMin(node->left, minNode);
+        return balance(node);
+    }
+
+    RankNode* remove(RankNode* node, Student* student) {
+        if (!node) return nullptr;
+        if (node->student == student) {
+            RankNode* left = node->left;
+            RankNode* right = node->right;
+            nodePool.release(node);
+            if (!right) return left;
+            RankNode* succ = nullptr;
+            right = removeMin(right, succ);
+            succ->left = left;
+            succ->right = right;
+            return balance(succ);
+        }
+        if (ranksBefore(student, node->student))
+            node->left = remove(node->left, student);
+        else
+            node->right = remove(node->right, student);
+        return balance(node);
+    }
+
+    // Collect ranks [from, to) (0-based) in order, skipping whole subtrees
+    void collect(RankNode* node, int offset, int from, int to, vector<Student>& out) {
+        if (!node || from >= to) return;
+        int leftSize = size(node->left);
+        int nodeRank = offset + leftSize;
+        if (from < nodeRank)
+            collect(node->left, offset, from, to, out);
+        if (from <= nodeRank && nodeRank < to)
+            out.push_back(*node->student);
+        if (nodeRank + 1 < to)
+            collect(node->right, nodeRank + 1, from, to, out);
+    }
+
+public:
+    RankingTree() : root(nullptr) {}
+
+    // Add a graded score to a student's total and reposition them: O(log S)
+    void addScore(string studentID, string name, int score) {
+        addTotals(studentID, name, score, 1);
+    }
+
+    // Add several graded submissions' worth of score at once: O(log S)
+    void addTotals(string studentID, string name, int score, int submissions) {
+        auto it = totals.find(studentID);
+        if (it == totals.end()) {
+            Student& student = totals[studentID];
+            student.studentID = studentID;
+            student.name = name;
+            student.totalScore = score;
+            student.submissionCount = submissions;
+            root = insert(root, &student);
+            return;
+        }
+
+        Student* student = &it->second;
+        root = remove(root, student);
+        student->totalScore += score;
+        student->submissionCount += submissions;
+        if (student->submissionCount <= 0) {
+            totals.erase(it);    // last graded submission was taken back
+            return;
+        }
+        root = insert(root, student);
+    }
+
+    // 1-based rank of a student, 0 if they have no graded work: O(log S)
+    int rankOf(string studentID) {
+        auto it = totals.find(studentID);
+        if (it == totals.end()) return 0;
+
+        Student* student = &it->second;
+        RankNode* node = root;
+        int rank = 0;
+        while (node != nullptr) {
+            if (node->student == student)
+                return rank + size(node->left) + 1;
+            if (ranksBefore(student, node->student)) {
+                node = node->left;
+            } else {
+                rank += size(node->left) + 1;
+                node = node->right;
+            }
+        }
+        return 0;
+    }
+
+    vector<Student> topK(int k) {
+        return range(0, k);
+    }
+
+    // Page numbers start at 1
+    vector<Student> page(int pageNumber, int pageSize) {
+        if (pageNumber < 1 || pageSize < 1) return {};
+        return range((pageNumber - 1) * pageSize, pageNumber * pageSize);
+    }
+
+    // Ranks [from, to) in leaderboard order: O(log S + k)
+    vector<Student> range(int from, int to) {
+        vector<Student> out;
+        if (from < 0) from = 0;
+        if (to > size(root)) to = size(root);
+        collect(root, 0, from, to, out);
+        return out;
+    }
+
+    int getSize() {
+        return size(root);
+    }
+
+    PoolStats memoryStats() {
+        return nodePool.getStats();
+    }
+};
+
+// ============== CONCURRENT INTAKE ==============
+// Intrusive multi-producer / single-consumer FIFO (Vyukov). push() is one
+// atomic exchange and never blocks, so any number of threads can enqueue at
+// once; pop() must only be called by one thread at a time.
+template <typename T>
+class MpscQueue {
+private:
+    struct Node {
+        atomic<Node*> next;
+        T value;
+    };
+
+    atomic<Node*> head;  // last pushed node, shared by producers
+    Node* tail;          // consumer side; always a dummy whose value was taken
+
+public:
+    MpscQueue() {
+        Node* dummy = new Node();
+        dummy->next.store(nullptr, memory_order_relaxed);
+        head.store(dummy, memory_order_relaxed);
+        tail = dummy;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T value) {
+        Node* node = new Node();
+        node->value = move(value);
+        node->next.store(nullptr, memory_order_relaxed);
+        Node* prev = head.exchange(node, memory_order_acq_rel);
+        prev->next.store(node, memory_order_release);
+    }
+
+    // False when empty, or when the next producer has not finished linking
+    // its node yet; that item is returned by a later pop, still in order
+    bool pop(T& out) {
+        Node* next = tail->next.load(memory_order_acquire);
+        if (next == nullptr) return false;
+        out = move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    ~MpscQueue() {
+        T discard;
+        while (pop(discard)) {}
+        delete tail;
+    }
+};
+
+// (student, assignment) symbol pair -> submission, split into independently
+// locked shards. claim() is the atomic check-and-insert used for duplicate
+// detection, so two racing submissions for one pair cannot both succeed;
+// the submission pointer is filled in once the claim reaches the queue.
+class ClaimTable {
+private:
+    static const int SHARD_COUNT = 64;
+
+    struct Shard {
+        mutex lock;
+        unordered_map<uint64_t, Submission*> items;
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    // Multiplicative hash so pairs sharing an assignment spread over shards
+    Shard& shardFor(uint64_t key) {
+        return shards[(key * 0x9E3779B97F4A7C15ull) >> 58];
+    }
+
+public:
+    // False if the key is already claimed
+    bool claim(uint64_t key) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        return shard.items.emplace(key, nullptr).second;
+    }
+
+    void assign(uint64_t key, Submission* sub) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        shard.items[key] = sub;
+    }
+
+    bool contains(uint64_t key) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        return shard.items.count(key) > 0;
+    }
+
+    // nullptr if unknown or still in the intake queue
+    Submission* find(uint64_t key) {
+        Shard& shard = shardFor(key);
+        lock_guard<mutex> guard(shard.lock);
+        auto it = shard.items.find(key);
+        return it == shard.items.end() ? nullptr : it->second;
+    }
+};
+
+// ============== COLUMNAR SUBMISSION STORE ==============
+const int SCORE_BINS = 11;  // 0-9, 10-19, ..., 90-99, 100 and above
+
+struct StudentAggregate {
+    Symbol studentID;
+    long long totalScore;
+    int graded;
+    double average;    // over graded submissions
+};
+
+struct AssignmentAggregate {
+    Symbol assignmentID;
+    int submissions;
+    int graded;
+    double mean;       // over graded submissions
+    int minScore;
+    int maxScore;
+    int histogram[SCORE_BINS];
+};
+
+// Threads kept for forEachPartition: started on first use, grown to the
+// most extra workers any call has asked for, and joined at exit. A caller
+// waiting for its tasks runs queued ones itself, so nested partitions (a
+// report over courses that each aggregate in parallel) cannot starve it.
+class WorkerPool {
+private:
+    mutex lock;
+    condition_variable ready;     // a task was queued, or the pool is stopping
+    condition_variable finished;  // a task of some run() completed
+    deque<function<void()>> tasks;
+    vector<thread> threads;
+    bool stopping;
+
+    void workLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            ready.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return;
+            function<void()> task = move(tasks.front());
+            tasks.pop_front();
+            guard.unlock();
+            task();
+            guard.lock();
+        }
+    }
+
+public:
+    WorkerPool() : stopping(false) {}
+
+    // Runs task(1) .. task(count - 1) on the pool and task(0) on the
+    // calling thread; returns when all of them are done
+    template <typename Task>
+    void run(int count, Task& task) {
+        int remaining = count - 1;
+        {
+            lock_guard<mutex> guard(lock);
+            while ((int)threads.size() < count - 1)
+                threads.emplace_back([this] { workLoop(); });
+            for (int i = 1; i < count; i++) {
+                tasks.push_back([this, &task, &remaining, i] {
+                    task(i);
+                    lock_guard<mutex> done(lock);
+                    if (--remaining == 0) finished.notify_all();
+                });
+            }
+        }
+        ready.notify_all();
+        task(0);
+
+        unique_lock<mutex> guard(lock);
+        while (remaining > 0) {
+            if (tasks.empty()) {
+                finished.wait(guard);
+                continue;
+            }
+            function<void()> other = move(tasks.front());
+            tasks.pop_front();
+            guard.unlock();
+            other();
+            guard.lock();
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (thread& t : threads) t.join();
+    }
+};
+
+inline WorkerPool& workerPool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+// Splits [0, n) into one contiguous slice per worker and runs them on the
+// worker pool, the calling thread taking slice 0. Returns when all are done.
+template <typename Work>
+void forEachPartition(size_t n, int workers, Work work) {
+    if (workers <= 1) {
+        work(0, n, 0);
+        return;
+    }
+    auto slice = [&](int w) { work(n * w / workers, n * (w + 1) / workers, w); };
+    workerPool().run(workers, slice);
+}
+
+// Below this many rows per worker, handing out slices costs more than it saves
+const size_t MIN_ROWS_PER_WORKER = 1 << 16;
+
+inline int partitionCount(size_t rows, int threads) {
+    size_t useful = rows / MIN_ROWS_PER_WORKER + 1;
+    return (int)max<size_t>(1, min<size_t>(threads, useful));
+}
+
+inline int hardwareThreads() {
+    unsigned cores = thread::hardware_concurrency();
+    return cores ? (int)cores : 1;
+}
+
+// The four fields analytics read, one array each, one row per submission.
+// Students and assignments are mapped to dense indices so aggregations
+// index plain arrays; the passes below are branch-free sequential scans.
+class SubmissionColumns {
+private:
+    vector<uint32_t> studentColumn;
+    vector<uint32_t> assignmentColumn;
+    vector<uint8_t> statusColumn;     // SubmissionStatus; 1 means graded
+    vector<int32_t> scoreColumn;      // 0 while pending
+
+    vector<Symbol> students;          // dense index -> symbol
+    vector<Symbol> assignments;
+    unordered_map<Symbol, uint32_t> studentIndex;
+    unordered_map<Symbol, uint32_t> assignmentIndex;
+
+    // Per-worker partial sums; a student's two sums share a cache line
+    struct StudentTotals { long long score; long long graded; };
+    struct AssignmentTotals {
+        long long score;
+        int submitted, graded, low, high;
+        int bins[SCORE_BINS];
+    };
+
+    static uint32_t slot(Symbol symbol, vector<Symbol>& symbols, unordered_map<Symbol, uint32_t>& index) {
+        auto it = index.find(symbol);
+        if (it != index.end()) return it->second;
+        uint32_t dense = (uint32_t)symbols.size();
+        symbols.push_back(symbol);
+        index.emplace(symbol, dense);
+        return dense;
+    }
+
+public:
+    uint32_t studentSlot(Symbol studentID) {
+        return slot(studentID, students, studentIndex);
+    }
+
+    uint32_t assignmentSlot(Symbol assignmentID) {
+        return slot(assignmentID, assignments, assignmentIndex);
+    }
+
+    void reserve(size_t rows) {
+        studentColumn.reserve(rows);
+        assignmentColumn.reserve(rows);
+        statusColumn.reserve(rows);
+        scoreColumn.reserve(rows);
+    }
+
+    // Dense indices come from studentSlot / assignmentSlot
+    void append(uint32_t student, uint32_t assignment, SubmissionStatus status, int score) {
+        studentColumn.push_back(student);
+        assignmentColumn.push_back(assignment);
+        statusColumn.push_back(status == SUBMISSION_GRADED ? 1 : 0);
+        scoreColumn.push_back(status == SUBMISSION_GRADED ? score : 0);
+    }
+
+    void setGrade(uint32_t row, int score) {
+        statusColumn[row] = 1;
+        scoreColumn[row] = score;
+    }
+
+    void setPending(uint32_t row) {
+        statusColumn[row] = 0;
+        scoreColumn[row] = 0;
+    }
+
+    // visit(studentID, assignmentID, graded, score) for every row in order
+    template <typename Visit>
+    void forEachRow(Visit visit) const {
+        for (size_t i = 0; i < rowCount(); i++)
+            visit(students[studentColumn[i]], assignments[assignmentColumn[i]], statusColumn[i] != 0, scoreColumn[i]);
+    }
+
+    size_t rowCount() const {
+        return statusColumn.size();
+    }
+
+    long long gradedCount(int threads = 1) const {
+        const uint8_t* status = statusColumn.data();
+        vector<long long> partial(partitionCount(rowCount(), threads), 0);
+        forEachPartition(rowCount(), (int)partial.size(), [&](size_t begin, size_t end, int worker) {
+            long long graded = 0;
+            for (size_t i = begin; i < end; i++)
+                graded += status[i];
+            partial[worker] = graded;
+        });
+        long long graded = 0;
+        for (long long count : partial) graded += count;
+        return graded;
+    }
+
+    // One entry per student with at least one submission, in first-seen order.
+    // With threads > 1 each worker sums a slice of the rows into its own
+    // table and the tables are merged by student; integer sums make the
+    // result identical for any thread count.
+    vector<StudentAggregate> studentAggregates(int threads = 1) const {
+        size_t studentCount = students.size();
+        int workers = partitionCount(rowCount(), threads);
+        vector<vector<StudentTotals>> partial(workers);
+
+        const uint32_t* student = studentColumn.data();
+        const uint8_t* status = statusColumn.data();
+        const int32_t* score = scoreColumn.data();
+        forEachPartition(rowCount(), workers, [&](size_t begin, size_t end, int worker) {
+            vector<StudentTotals>& totals = partial[worker];
+            totals.assign(studentCount, StudentTotals{0, 0});
+            for (size_t i = begin; i < end; i++) {
+                StudentTotals& entry = totals[student[i]];
+                entry.score += score[i];     // pending rows hold 0
+                entry.graded += status[i];
+            }
+        });
+
+        vector<StudentAggregate> out(studentCount);
+        forEachPartition(studentCount, workers, [&](size_t begin, size_t end, int) {
+            for (size_t s = begin; s < end; s++) {
+                long long total = 0, graded = 0;
+                for (const vector<StudentTotals>& totals : partial) {
+                    total += totals[s].score;
+                    graded += totals[s].graded;
+                }
+                out[s] = StudentAggregate{students[s], total, (int)graded,
+                                          graded ? (double)total / graded : 0.0};
+            }
+        });
+        return out;
+    }
+
+    // One entry per assignment with at least one submission, in first-seen order
+    vector<AssignmentAggregate> assignmentAggregates(int threads = 1) const {
+        size_t assignmentCount = assignments.size();
+        int workers = partitionCount(rowCount(), threads);
+        vector<vector<AssignmentTotals>> partial(workers);
+
+        const uint32_t* assignment = assignmentColumn.data();
+        const uint8_t* status = statusColumn.data();
+        const int32_t* score = scoreColumn.data();
+        forEachPartition(rowCount(), workers, [&](size_t begin, size_t end, int worker) {
+            vector<AssignmentTotals>& totals = partial[worker];
+            totals.assign(assignmentCount, AssignmentTotals{0, 0, 0, INT_MAX, INT_MIN, {}});
+            for (size_t i = begin; i < end; i++) {
+                AssignmentTotals& entry = totals[assignment[i]];
+                int g = status[i];
+                int value = score[i];
+                entry.submitted++;
+                entry.graded += g;
+                entry.score += value;
+                // Pending rows must not move min/max: select instead of branching
+                entry.low = min(entry.low, g ? value : INT_MAX);
+                entry.high = max(entry.high, g ? value : INT_MIN);
+                entry.bins[min(max(value, 0) / 10, SCORE_BINS - 1)] += g;
+            }
+        });
+
+        vector<AssignmentAggregate> out(assignmentCount);
+        for (size_t a = 0; a < assignmentCount; a++) {
+            AssignmentTotals sums = partial[0][a];
+            for (int w = 1; w < workers; w++) {
+                const AssignmentTotals& more = partial[w][a];
+                sums.score += more.score;
+                sums.submitted += more.submitted;
+                sums.graded += more.graded;
+                sums.low = min(sums.low, more.low);
+                sums.high = max(sums.high, more.high);
+                for (int b = 0; b < SCORE_BINS; b++) sums.bins[b] += more.bins[b];
+            }
+            AssignmentAggregate& entry = out[a];
+            entry.assignmentID = assignments[a];
+            entry.submissions = sums.submitted;
+            entry.graded = sums.graded;
+            entry.mean = sums.graded ? (double)sums.score / sums.graded : 0.0;
+            entry.minScore = sums.graded ? sums.low : 0;
+            entry.maxScore = sums.graded ? sums.high : 0;
+            memcpy(entry.histogram, sums.bins, sizeof(sums.bins));
+        }
+        return out;
+    }
+
+    // Students with a graded submission, highest total first and ties by
+    // student ID (the RankingTree order), recomputed from the columns.
+    // Slices are sorted in parallel, then merged pairwise.
+    vector<StudentAggregate> rankStudents(int threads = 1) const {
+        vector<StudentAggregate> ranked;
+        for (const StudentAggregate& entry : studentAggregates(threads))
+            if (entry.graded > 0) ranked.push_back(entry);
+
+        auto ranksBefore = [](const StudentAggregate& a, const StudentAggregate& b) {
+            if (a.totalScore != b.totalScore) return a.totalScore > b.totalScore;
+            return symbolText(a.studentID) < symbolText(b.studentID);
+        };
+        int workers = partitionCount(ranked.size(), threads);
+        vector<size_t> bounds(workers + 1, ranked.size());
+        forEachPartition(ranked.size(), workers, [&](size_t begin, size_t end, int worker) {
+            bounds[worker] = begin;
+            sort(ranked.begin() + begin, ranked.begin() + end, ranksBefore);
+        });
+        for (int width = 1; width < workers; width *= 2) {
+            int merges = (workers + 2 * width - 1) / (2 * width);
+            forEachPartition(merges, merges, [&](size_t begin, size_t end, int) {
+                for (size_t m = begin; m < end; m++) {
+                    size_t first = bounds[m * 2 * width];
+                    size_t middle = bounds[min<size_t>(m * 2 * width + width, workers)];
+                    size_t last = bounds[min<size_t>(m * 2 * width + 2 * width, workers)];
+                    inplace_merge(ranked.begin() + first, ranked.begin() + middle,
+                                  ranked.begin() + last, ranksBefore);
+                }
+            });
+        }
+        return ranked;
+    }
+
+    PoolStats memoryStats() const {
+        long long rows = (long long)rowCount();
+        long long capacity = (long long)statusColumn.capacity();
+        long long bytes = capacity * (long long)(2 * sizeof(uint32_t) + sizeof(uint8_t) + sizeof(int32_t));
+        return PoolStats{rows, 0, 0, rows, 4, bytes};
+    }
+};
+
+// ============== GRADE EVENTS (Materialized Views) ==============
+// Every change to a submission's state is published once, as an event, to
+// the views that summarize submissions and then to any subscribers. Each
+// view applies an event in O(1) or O(log n) instead of re-walking the
+// queue when it is read.
+enum SubmissionEventType : uint8_t {
+    EVENT_SUBMITTED,
+    EVENT_GRADED,
+    EVENT_REGRADED,            // graded again; previous* hold the old grade
+    EVENT_UNGRADED,            // grade taken back (undo); previousScore is the old score
+    EVENT_ASSIGNMENT_REMOVED,  // assignment deleted; its submissions stay
+    EVENT_ASSIGNMENT_RESTORED  // deletion undone
+};
+
+struct SubmissionEvent {
+    SubmissionEventType type;
+    const Submission* submission;  // as it is after the change; nullptr for assignment events
+    Symbol assignmentID;
+    int previousScore;
+    string previousFeedback;       // EVENT_REGRADED only
+};
+
+// Subscribers run on the thread making the change, inside the engine's
+// lock: they must be quick and must not call back into the engine
+typedef function<void(const SubmissionEvent&)> SubmissionSubscriber;
+
+struct GradeTotals {
+    long long submitted;
+    long long graded;
+    long long scoreTotal;  // over graded submissions
+
+    long long pending() const { return submitted - graded; }
+    double average() const { return graded ? (double)scoreTotal / graded : 0.0; }
+};
+
+// Class, per-assignment and per-student (transcript) totals. Seeded once
+// from every existing submission, then kept in step by apply(). A deleted
+// assignment's grades still count, as in the rankings, but it has no
+// pending work until the deletion is undone.
+class GradeViews {
+private:
+    struct AssignmentView {
+        GradeTotals totals;
+        map<int, int> scores;  // graded score -> count, for min and max
+        int bins[SCORE_BINS];
+        bool removed;
+    };
+
+    GradeTotals classTotals;
+    unordered_map<Symbol, AssignmentView> assignments;
+    vector<Symbol> assignmentOrder;  // first seen first, like the column aggregates
+    unordered_map<Symbol, GradeTotals> transcripts;
+
+    AssignmentView& assignmentView(Symbol assignmentID) {
+        auto it = assignments.find(assignmentID);
+        if (it != assignments.end()) return it->second;
+        assignmentOrder.push_back(assignmentID);
+        return assignments.emplace(assignmentID, AssignmentView{GradeTotals{0, 0, 0}, {}, {}, false}).first->second;
+    }
+
+    static int binOf(int score) {
+        return min(max(score, 0) / 10, SCORE_BINS - 1);
+    }
+
+    // sign +1 adds a graded score to every view, -1 takes it back out
+    void applyScore(Symbol studentID, AssignmentView& assignment, int score, int sign) {
+        classTotals.graded += sign;
+        classTotals.scoreTotal += sign * score;
+        GradeTotals& transcript = transcripts[studentID];
+        transcript.graded += sign;
+        transcript.scoreTotal += sign * score;
+        assignment.totals.graded += sign;
+        assignment.totals.scoreTotal += sign * score;
+        assignment.bins[binOf(score)] += sign;
+        if (sign > 0) {
+            assignment.scores[score]++;
+        } else {
+            auto it = assignment.scores.find(score);
+            if (it != assignment.scores.end() && --it->second == 0) assignment.scores.erase(it);
+        }
+    }
+
+public:
+    GradeViews() : classTotals{0, 0, 0} {}
+
+    // One existing submission, while seeding
+    void addSubmission(Symbol studentID, Symbol assignmentID, bool graded, int score) {
+        AssignmentView& assignment = assignmentView(assignmentID);
+        classTotals.submitted++;
+        transcripts[studentID].submitted++;
+        assignment.totals.submitted++;
+        if (graded) applyScore(studentID, assignment, score, 1);
+    }
+
+    // After seeding: marks the assignments exists(id) no longer knows
+    template <typename Exists>
+    void markRemoved(Exists exists) {
+        for (Symbol assignmentID : assignmentOrder) {
+            if (!exists(assignmentID)) assignments.at(assignmentID).removed = true;
+        }
+    }
+
+    void apply(const SubmissionEvent& event) {
+        const Submission* sub = event.submission;
+        switch (event.type) {
+            case EVENT_SUBMITTED:
+                addSubmission(sub->studentID, sub->assignmentID, sub->status == SUBMISSION_GRADED, sub->score);
+                break;
+            case EVENT_GRADED:
+                applyScore(sub->studentID, assignmentView(sub->assignmentID), sub->score, 1);
+                break;
+            case EVENT_REGRADED: {
+                AssignmentView& assignment = assignmentView(sub->assignmentID);
+                applyScore(sub->studentID, assignment, event.previousScore, -1);
+                applyScore(sub->studentID, assignment, sub->score, 1);
+                break;
+            }
+            case EVENT_UNGRADED:
+                applyScore(sub->studentID, assignmentView(sub->assignmentID), event.previousScore, -1);
+                break;
+            case EVENT_ASSIGNMENT_REMOVED:
+            case EVENT_ASSIGNMENT_RESTORED: {
+                // No view means no submissions, and a deleted assignment gets none
+                auto it = assignments.find(event.assignmentID);
+                if (it != assignments.end()) it->second.removed = event.type == EVENT_ASSIGNMENT_REMOVED;
+                break;
+            }
+        }
+    }
+
+    const GradeTotals& totals() const {
+        return classTotals;
+    }
+
+    // A student's totals; all zero if they never submitted
+    GradeTotals transcript(Symbol studentID) const {
+        auto it = transcripts.find(studentID);
+        return it != transcripts.end() ? it->second : GradeTotals{0, 0, 0};
+    }
+
+    GradeTotals assignmentTotals(Symbol assignmentID) const {
+        auto it = assignments.find(assignmentID);
+        return it != assignments.end() ? it->second.totals : GradeTotals{0, 0, 0};
+    }
+
+    // Ungraded submissions of an assignment that still exists
+    long long pending(Symbol assignmentID) const {
+        auto it = assignments.find(assignmentID);
+        return it != assignments.end() && !it->second.removed ? it->second.totals.pending() : 0;
+    }
+
+    // One entry per assignment with submissions, as SubmissionColumns
+    // computes them, in O(1) per assignment
+    vector<AssignmentAggregate> assignmentAggregates() const {
+        vector<AssignmentAggregate> out;
+        for (Symbol assignmentID : assignmentOrder) {
+            const AssignmentView& view = assignments.at(assignmentID);
+            if (view.totals.submitted == 0) continue;
+            AssignmentAggregate entry;
+            entry.assignmentID = assignmentID;
+            entry.submissions = (int)view.totals.submitted;
+            entry.graded = (int)view.totals.graded;
+            entry.mean = view.totals.average();
+            entry.minScore = view.scores.empty() ? 0 : view.scores.begin()->first;
+            entry.maxScore = view.scores.empty() ? 0 : view.scores.rbegin()->first;
+            memcpy(entry.histogram, view.bins, sizeof(view.bins));
+            out.push_back(entry);
+        }
+        return out;
+    }
+};
+
+// ============== SUBMISSION QUEUE ==============
+// Where a pending listing stopped; valid until the queue changes
+struct QueueCursor {
+    uint32_t baseIndex;       // next snapshot record
+    const Submission* node;   // next queue node
+};
+
+class SubmissionQueue {
+private:
+    Submission* front;
+    Submission* rear;
+    atomic<int> count;
+
+    // Hash indexes kept in sync with the FIFO chain
+    unordered_map<uint32_t, Submission*> byID;
+    ClaimTable claims;  // by (student, assignment); shared with producer threads
+    unordered_map<Symbol, vector<Submission*>> byStudent;
+    unordered_map<Symbol, vector<Submission*>> byAssignment;  // for batch regrades
+
+    RankingTree rankings;  // maintained as submissions are graded
+    ObjectPool<Submission> submissionPool;
+    WriteAheadLog* log;
+    AssignmentLinkedList* assignments;  // for max scores; optional
+
+    // Submissions from the mapped snapshot; copied out only when looked up
+    // by ID (e.g. to be graded), and those copies shadow the mapped record
+    const MappedSnapshot* base;
+    unordered_map<uint32_t, Submission*> baseCache;
+    bool rankingsSeeded;
+
+    // Analytics columns, built on first use and then kept in step
+    SubmissionColumns columns;
+    bool columnsSeeded;
+    uint32_t baseRows;
+    uint32_t linkedRows;
+
+    // Feedback words of graded submissions; built on first search
+    TextIndex feedbackIndex;
+    bool feedbackSeeded;
+
+    // Class, assignment and student totals, seeded on first read; then
+    // they and the subscribers follow the events from publish()
+    GradeViews views;
+    bool viewsSeeded;
+    vector<pair<int, SubmissionSubscriber>> subscribers;
+    int nextSubscriber;
+
+    uint32_t generateID() {
+        return 10000 + (uint32_t)++count;
+    }
+
+    static uint64_t pairKey(Symbol studentID, Symbol assignmentID) {
+        return (uint64_t)studentID << 32 | assignmentID;
+    }
+
+    // Key for a pair given as text; false if either string was never
+    // interned, in which case no queued submission can match
+    static bool findPairKey(const string& studentID, const string& assignmentID, uint64_t& key) {
+        Symbol student, assignment;
+        if (!symbols().find(studentID, student) || !symbols().find(assignmentID, assignment))
+            return false;
+        key = pairKey(student, assignment);
+        return true;
+    }
+
+    void indexSubmission(Submission* sub) {
+        byID[sub->submissionID] = sub;
+        uint64_t key = pairKey(sub->studentID, sub->assignmentID);
+        claims.claim(key);
+        claims.assign(key, sub);
+        byStudent[sub->studentID].push_back(sub);
+        byAssignment[sub->assignmentID].push_back(sub);
+    }
+
+    // Submissions accepted by intake() but not yet linked into the queue
+    MpscQueue<Submission> intakeQueue;
+
+    // Queue operation (FIFO)
+    void linkSubmission(Submission* newSub) {
+        newSub->next = nullptr;
+        newSub->row = baseRows + linkedRows++;
+        if (rear == nullptr) {
+            front = rear = newSub;
+        } else {
+            rear->next = newSub;
+            rear = newSub;
+        }
+        indexSubmission(newSub);
+        publish(SubmissionEvent{EVENT_SUBMITTED, newSub, newSub->assignmentID, 0, ""});
+    }
+
+    // The one place a change to a submission reaches the rankings, the
+    // columns, the feedback index and the views, and then the subscribers.
+    // Views not seeded yet skip the event: seeding reads the current state.
+    void publish(const SubmissionEvent& event) {
+        const Submission* sub = event.submission;
+        switch (event.type) {
+            case EVENT_SUBMITTED:
+                if (columnsSeeded) {
+                    columns.append(columns.studentSlot(sub->studentID),
+                                   columns.assignmentSlot(sub->assignmentID), sub->status, sub->score);
+                }
+                break;
+            case EVENT_GRADED:
+                if (columnsSeeded) columns.setGrade(sub->row, sub->score);
+                if (feedbackSeeded) feedbackIndex.add(sub->submissionID, sub->feedback);
+                ensureRankings();
+                rankings.addScore(symbolText(sub->studentID), symbolText(sub->studentName), sub->score);
+                break;
+            case EVENT_REGRADED:
+                if (columnsSeeded) columns.setGrade(sub->row, sub->score);
+                if (feedbackSeeded && sub->feedback != event.previousFeedback) {
+                    feedbackIndex.remove(sub->submissionID);
+                    feedbackIndex.add(sub->submissionID, sub->feedback);
+                }
+                // The student moves by the difference: O(log S), no recompute
+                ensureRankings();
+                if (sub->score != event.previousScore)
+                    rankings.addTotals(symbolText(sub->studentID), symbolText(sub->studentName),
+                                       sub->score - event.previousScore, 0);
+                break;
+            case EVENT_UNGRADED:
+                if (columnsSeeded) columns.setPending(sub->row);
+                if (feedbackSeeded) feedbackIndex.remove(sub->submissionID);
+                ensureRankings();
+                rankings.addTotals(symbolText(sub->studentID), symbolText(sub->studentName), -event.previousScore, -1);
+                break;
+            default:
+                break;
+        }
+        if (viewsSeeded) views.apply(event);
+        for (auto& subscriber : subscribers) subscriber.second(event);
+    }
+
+    void copyBase(uint32_t index, Submission* sub) {
+        const SnapSubmission& record = base->submission(index);
+        sub->submissionID = parseSubmissionID(base->text(record.submissionID));
+        sub->studentID = intern(base->text(record.studentID));
+        sub->studentName = intern(base->text(record.studentName));
+        sub->assignmentID = intern(base->text(record.assignmentID));
+        sub->assignmentTitle = intern(base->text(record.assignmentTitle));
+        sub->submittedDate = string(base->text(record.submittedDate));
+        sub->file = string(base->text(record.file));
+        sub->status = record.graded ? SUBMISSION_GRADED : SUBMISSION_PENDING;
+        sub->score = record.score;
+        sub->feedback = string(base->text(record.feedback));
+        sub->row = index;
+        sub->next = nullptr;
+    }
+
+    Submission* baseSubmission(uint32_t index) {
+        auto it = baseCache.find(index);
+        if (it != baseCache.end()) return it->second;
+        Submission* sub = submissionPool.allocate();
+        copyBase(index, sub);
+        baseCache[index] = sub;
+        return sub;
+    }
+
+    // The cached copy if there is one, otherwise the record copied into scratch
+    const Submission* viewBase(uint32_t index, Submission& scratch) {
+        auto it = baseCache.find(index);
+        if (it != baseCache.end()) return it->second;
+        copyBase(index, &scratch);
+        return &scratch;
+    }
+
+    // Loads the snapshot's per-student totals the first time rankings are needed
+    void ensureRankings() {
+        if (rankingsSeeded || base == nullptr) return;
+        rankingsSeeded = true;
+        for (uint32_t i = 0; i < base->studentCount(); i++) {
+            const SnapStudent& student = base->student(i);
+            rankings.addTotals(string(base->text(student.studentID)), string(base->text(student.name)),
+                               student.totalScore, student.submissionCount);
+        }
+    }
+
+    // Loads every submission into the columns the first time analytics run.
+    // Snapshot strings are deduplicated, so equal IDs share an offset and
+    // each distinct student or assignment is interned once, not per row.
+    void ensureColumns() {
+        if (columnsSeeded) return;
+        columnsSeeded = true;
+        columns.reserve(baseRows + linkedRows);
+
+        unordered_map<uint32_t, uint32_t> studentByOffset, assignmentByOffset;
+        for (uint32_t i = 0; i < baseRows; i++) {
+            const SnapSubmission& record = base->submission(i);
+            auto student = studentByOffset.find(record.studentID.offset);
+            if (student == studentByOffset.end())
+                student = studentByOffset.emplace(record.studentID.offset,
+                    columns.studentSlot(intern(base->text(record.studentID)))).first;
+            auto assignment = assignmentByOffset.find(record.assignmentID.offset);
+            if (assignment == assignmentByOffset.end())
+                assignment = assignmentByOffset.emplace(record.assignmentID.offset,
+                    columns.assignmentSlot(intern(base->text(record.assignmentID)))).first;
+
+            // A cached copy may have been graded since the snapshot
+            SubmissionStatus status = record.graded ? SUBMISSION_GRADED : SUBMISSION_PENDING;
+            int score = record.score;
+            if (!baseCache.empty()) {
+                auto cached = baseCache.find(i);
+                if (cached != baseCache.end()) {
+                    status = cached->second->status;
+                    score = cached->second->score;
+                }
+            }
+            columns.append(student->second, assignment->second, status, score);
+        }
+
+        for (Submission* temp = front; temp != nullptr; temp = temp->next) {
+            columns.append(columns.studentSlot(temp->studentID),
+                           columns.assignmentSlot(temp->assignmentID), temp->status, temp->score);
+        }
+    }
+
+    // Totals every submission once, the first time a view is read
+    void ensureViews() {
+        if (viewsSeeded) return;
+        ensureColumns();
+        columns.forEachRow([&](Symbol studentID, Symbol assignmentID, bool graded, int score) {
+            views.addSubmission(studentID, assignmentID, graded, score);
+        });
+        if (assignments) {
+            views.markRemoved([&](Symbol assignmentID) {
+                int maxScore;
+                return assignments->findMaxScore(symbolText(assignmentID), maxScore);
+            });
+        }
+        viewsSeeded = true;
+    }
+
+    // Indexes the feedback of every graded submission the first time a
+    // feedback search runs; snapshot text is read from the mapping
+    void ensureFeedback() {
+        if (feedbackSeeded) return;
+        feedbackSeeded = true;
+        for (uint32_t i = 0; i < baseRows; i++) {
+            auto cached = baseCache.empty() ? baseCache.end() : baseCache.find(i);
+            if (cached != baseCache.end()) {
+                const Submission* sub = cached->second;
+                if (sub->status == SUBMISSION_GRADED) feedbackIndex.add(sub->submissionID, sub->feedback);
+                continue;
+            }
+            const SnapSubmission& record = base->submission(i);
+            if (record.graded)
+                feedbackIndex.add(parseSubmissionID(base->text(record.submissionID)), base->text(record.feedback));
+        }
+        for (Submission* temp = front; temp != nullptr; temp = temp->next) {
+            if (temp->status == SUBMISSION_GRADED)
+                feedbackIndex.add(temp->submissionID, temp->feedback);
+        }
+    }
+
+    // False if any key could not be interned (see SymbolTable::intern)
+    static bool interned(initializer_list<Symbol> keys) {
+        for (Symbol key : keys) {
+            if (key == NO_SYMBOL) return false;
+        }
+        return true;
+    }
+
+    static void fillPending(Submission* sub, uint32_t id, Symbol studentID, Symbol studentName,
+                            Symbol assignmentID, Symbol assignmentTitle, string submittedDate,
+                            string file) {
+        sub->submissionID = id;
+        sub->studentID = studentID;
+        sub->studentName = studentName;
+        sub->assignmentID = assignmentID;
+        sub->assignmentTitle = assignmentTitle;
+        sub->submittedDate = move(submittedDate);
+        sub->file = move(file);
+        sub->status = SUBMISSION_PENDING;
+        sub->score = 0;
+        sub->feedback = "Not graded yet";
+        sub->next = nullptr;
+    }
+
+    void markGraded(Submission* sub, int score, const string& feedback) {
+        sub->score = score;
+        sub->feedback = feedback;
+        sub->status = SUBMISSION_GRADED;
+        publish(SubmissionEvent{EVENT_GRADED, sub, sub->assignmentID, 0, ""});
+    }
+
+    void changeGrade(Submission* sub, int score, const string& feedback) {
+        int previousScore = sub->score;
+        string previousFeedback = move(sub->feedback);
+        sub->score = score;
+        sub->feedback = feedback;
+        publish(SubmissionEvent{EVENT_REGRADED, sub, sub->assignmentID, previousScore, move(previousFeedback)});
+    }
+
+    // Index of the snapshot's submission for the pair, or -1
+    long findBase(const string& studentID, const string& assignmentID) {
+        if (base == nullptr) return -1;
+        pair<uint32_t, uint32_t> range = base->studentRange(studentID);
+        for (uint32_t pos = range.first; pos < range.second; pos++) {
+            uint32_t index = base->byStudent(pos);
+            if (base->text(base->submission(index).assignmentID) == assignmentID)
+                return index;
+        }
+        return -1;
+    }
+
+public:
+    SubmissionQueue() {
+        front = nullptr;
+        rear = nullptr;
+        count = 0;
+        log = nullptr;
+        assignments = nullptr;
+        base = nullptr;
+        rankingsSeeded = false;
+        columnsSeeded = false;
+        feedbackSeeded = false;
+        viewsSeeded = false;
+        nextSubscriber = 0;
+        baseRows = 0;
+        linkedRows = 0;
+    }
+
+    void attachLog(WriteAheadLog* wal) {
+        log = wal;
+    }
+
+    void attachAssignments(AssignmentLinkedList* list) {
+        assignments = list;
+    }
+
+    // From 0 to the assignment's max score. Without an attached list, or
+    // once the assignment is gone, only the lower bound is known.
+    bool isValidScore(const Submission* sub, int score) {
+        int maxScore;
+        if (score < 0) return false;
+        return assignments == nullptr || !assignments->findMaxScore(symbolText(sub->assignmentID), maxScore) ||
+               score <= maxScore;
+    }
+
+    // Serves snapshot submissions from the mapping; new ones join the queue
+    void attachBase(const MappedSnapshot* snapshot) {
+        base = snapshot;
+        rankingsSeeded = false;
+        baseRows = snapshot->submissionCount();
+        setCounter(snapshot->header().submissionCounter);
+    }
+
+    // Enqueue; one submission per student and assignment
+    Status submit(const Student& student, Assignment* assignment, string file,
+                  Submission** created = nullptr) {
+        MetricTimer timer(METRIC_SUBMIT);
+        if (assignment == nullptr) return STATUS_NOT_FOUND;
+        Symbol studentID = intern(student.studentID);
+        Symbol studentName = intern(student.name);
+        Symbol assignmentID = intern(assignment->assignmentID);
+        Symbol assignmentTitle = intern(assignment->title);
+        if (!interned({studentID, studentName, assignmentID, assignmentTitle})) return STATUS_FULL;
+        if (findBase(student.studentID, assignment->assignmentID) >= 0 ||
+            !claims.claim(pairKey(studentID, assignmentID))) {
+            metrics().count(COUNTER_DUPLICATES_REJECTED);
+            return STATUS_DUPLICATE;
+        }
+
+        Submission* newSub = submissionPool.allocate();
+        fillPending(newSub, generateID(), studentID, studentName, assignmentID, assignmentTitle,
+                    currentTimestamp(), file);
+
+        linkSubmission(newSub);
+        if (log) log->logSubmit(newSub);
+
+        if (created) *created = newSub;
+        return STATUS_OK;
+    }
+
+    bool isDuplicate(string studentID, string assignmentID) {
+        MetricTimer timer(METRIC_DUPLICATE_CHECK);
+        uint64_t key;
+        if (findPairKey(studentID, assignmentID, key) && claims.contains(key)) return true;
+        return findBase(studentID, assignmentID) >= 0;
+    }
+
+    // A student's submission for an assignment, or nullptr
+    Submission* searchByStudentAssignment(string studentID, string assignmentID) {
+        uint64_t key;
+        if (findPairKey(studentID, assignmentID, key)) {
+            Submission* sub = claims.find(key);
+            if (sub != nullptr) return sub;
+        }
+        long index = findBase(studentID, assignmentID);
+        return index >= 0 ? baseSubmission((uint32_t)index) : nullptr;
+    }
+
+    // Thread-safe intake: any number of threads may call this at once, and
+    // concurrently with drainIntake(). The duplicate check claims the pair
+    // atomically; the submission joins the queue on the next drain.
+    Status intake(const Student& student, const string& assignmentID, const string& assignmentTitle,
+                  string file, string* submissionID = nullptr) {
+        MetricTimer timer(METRIC_INTAKE);
+        Symbol studentSymbol = intern(student.studentID);
+        Symbol nameSymbol = intern(student.name);
+        Symbol assignmentSymbol = intern(assignmentID);
+        Symbol titleSymbol = intern(assignmentTitle);
+        if (!interned({studentSymbol, nameSymbol, assignmentSymbol, titleSymbol})) return STATUS_FULL;
+        if (findBase(student.studentID, assignmentID) >= 0 ||
+            !claims.claim(pairKey(studentSymbol, assignmentSymbol))) {
+            metrics().count(COUNTER_DUPLICATES_REJECTED);
+            return STATUS_DUPLICATE;
+        }
+
+        Submission sub;
+        fillPending(&sub, generateID(), studentSymbol, nameSymbol, assignmentSymbol, titleSymbol,
+                    currentTimestamp(), file);
+
+        if (submissionID) *submissionID = formatSubmissionID(sub.submissionID);
+        intakeQueue.push(move(sub));
+        return STATUS_OK;
+    }
+
+    // Moves accepted intake into the FIFO queue and the log, calling
+    // visit(submission) in arrival order. One drainer at a time.
+    template <typename Visit>
+    int drainIntake(Visit visit) {
+        int drained = 0;
+        Submission incoming;
+        while (intakeQueue.pop(incoming)) {
+            Submission* newSub = submissionPool.allocate();
+            *newSub = move(incoming);
+            linkSubmission(newSub);
+            if (log) log->logSubmit(newSub);
+            visit(*newSub);
+            drained++;
+        }
+        return drained;
+    }
+
+    // Search by ID (hash lookup, then the snapshot's sorted ID index)
+    Submission* searchByID(string submissionID) {
+        auto it = byID.find(parseSubmissionID(submissionID));
+        if (it != byID.end()) return it->second;
+        if (base != nullptr) {
+            long index = base->findSubmission(submissionID);
+            if (index >= 0) return baseSubmission((uint32_t)index);
+        }
+        return nullptr;
+    }
+
+    bool isEmpty() {
+        return front == nullptr && (base == nullptr || base->submissionCount() == 0);
+    }
+
+    // Pending submissions in FIFO order; snapshot records are older than
+    // anything in the queue
+    template <typename Visit>
+    void forEachPending(Visit visit) {
+        QueueCursor cursor = firstPending();
+        forEachPendingFrom(cursor, SIZE_MAX, visit);
+    }
+
+    QueueCursor firstPending() {
+        return QueueCursor{0, front};
+    }
+
+    // Up to `limit` rows of forEachPending starting at the cursor, which is
+    // moved past them; returns the number visited
+    template <typename Visit>
+    size_t forEachPendingFrom(QueueCursor& cursor, size_t limit, Visit visit) {
+        size_t visited = 0;
+        uint32_t i = cursor.baseIndex;
+        if (base != nullptr) {
+            Submission scratch;
+            for (; i < base->submissionCount() && visited < limit; i++) {
+                if (base->submission(i).graded && baseCache.count(i) == 0) continue;
+                const Submission* sub = viewBase(i, scratch);
+                if (sub->status == SUBMISSION_PENDING) {
+                    visit(*sub);
+                    visited++;
+                }
+            }
+        }
+        const Submission* temp = cursor.node;
+        for (; temp != nullptr && visited < limit; temp = temp->next) {
+            if (temp->status == SUBMISSION_PENDING) {
+                visit(*temp);
+                visited++;
+            }
+        }
+        cursor = QueueCursor{i, temp};
+        return visited;
+    }
+
+    // Submissions forEachPending would visit
+    size_t pendingCount() {
+        ensureViews();
+        return (size_t)views.totals().pending();
+    }
+
+    // Queue submissions linked after `after` (nullptr: from the front), for
+    // consumers that follow the queue incrementally. Returns the newest
+    // submission, to pass as `after` next time.
+    template <typename Visit>
+    const Submission* forEachLinkedAfter(const Submission* after, Visit visit) {
+        const Submission* temp = after ? after->next : front;
+        for (; temp != nullptr; temp = temp->next)
+            visit(*temp);
+        return rear;
+    }
+
+    const Submission* newestLinked() const {
+        return rear;
+    }
+
+    // One student's submissions, oldest first
+    template <typename Visit>
+    void forEachByStudent(string studentID, Visit visit) {
+        forEachByStudentFrom(studentID, 0, SIZE_MAX, visit);
+    }
+
+    // Rows [first, first + limit) of forEachByStudent, O(log n + limit)
+    template <typename Visit>
+    void forEachByStudentFrom(const string& studentID, size_t first, size_t limit, Visit visit) {
+        size_t last = first + min(limit, SIZE_MAX - first);
+        size_t row = 0;
+        if (base != nullptr) {
+            Submission scratch;
+            pair<uint32_t, uint32_t> range = base->studentRange(studentID);
+            size_t from = range.first + min(first, (size_t)(range.second - range.first));
+            size_t to = range.first + min(last, (size_t)(range.second - range.first));
+            for (size_t pos = from; pos < to; pos++)
+                visit(*viewBase(base->byStudent((uint32_t)pos), scratch));
+            row = range.second - range.first;
+        }
+        Symbol student;
+        if (!symbols().find(studentID, student)) return;
+        auto it = byStudent.find(student);
+        if (it == byStudent.end()) return;
+        const vector<Submission*>& queued = it->second;
+        size_t from = first > row ? first - row : 0;
+        size_t to = last > row ? min(last - row, queued.size()) : 0;
+        for (size_t i = from; i < to; i++)
+            visit(*queued[i]);
+    }
+
+    size_t studentSubmissionCount(const string& studentID) {
+        size_t total = 0;
+        if (base != nullptr) {
+            pair<uint32_t, uint32_t> range = base->studentRange(studentID);
+            total = range.second - range.first;
+        }
+        Symbol student;
+        if (symbols().find(studentID, student)) {
+            auto it = byStudent.find(student);
+            if (it != byStudent.end()) total += it->second.size();
+        }
+        return total;
+    }
+
+    Status grade(string submissionID, int score, string feedback) {
+        MetricTimer timer(METRIC_GRADE);
+        Submission* temp = searchByID(submissionID);
+        if (temp == nullptr) return STATUS_NOT_FOUND;
+        if (temp->status == SUBMISSION_GRADED) return STATUS_ALREADY_GRADED;
+        if (!isValidScore(temp, score)) return STATUS_INVALID;
+
+        markGraded(temp, score, feedback);
+        if (log) log->logGrade(temp);
+        return STATUS_OK;
+    }
+
+    // Grades an already graded submission again; *applied receives the change
+    Status regrade(string submissionID, int score, string feedback, RegradeEntry* applied = nullptr) {
+        Submission* sub = searchByID(submissionID);
+        if (sub == nullptr) return STATUS_NOT_FOUND;
+        if (sub->status != SUBMISSION_GRADED) return STATUS_NOT_GRADED;
+        if (!isValidScore(sub, score)) return STATUS_INVALID;
+
+        vector<RegradeEntry> entries{RegradeEntry{sub->submissionID, 0, score, "", feedback}};
+        regrade(entries);
+        if (applied) *applied = entries[0];
+        return STATUS_OK;
+    }
+
+    // Regrades many submissions as one batch written as a single log record.
+    // Entries that do not apply (unknown, pending, score out of range) are dropped.
+    Status regrade(vector<RegradeEntry>& entries) {
+        MetricTimer timer(METRIC_REGRADE);
+        applyRegrades(entries);
+        if (entries.empty()) return STATUS_EMPTY;
+        if (log) log->logRegrade(entries);
+        return STATUS_OK;
+    }
+
+    // Applies each entry to its graded submission and fills in the grade it
+    // replaced; entries that do not apply are dropped. Not logged.
+    void applyRegrades(vector<RegradeEntry>& entries) {
+        size_t kept = 0;
+        for (RegradeEntry& entry : entries) {
+            Submission* sub = searchByID(formatSubmissionID(entry.submissionID));
+            if (sub == nullptr || sub->status != SUBMISSION_GRADED || !isValidScore(sub, entry.score)) continue;
+            entry.previousScore = sub->score;
+            entry.previousFeedback = sub->feedback;
+            changeGrade(sub, entry.score, entry.feedback);
+            entries[kept++] = entry;
+        }
+        entries.resize(kept);
+    }
+
+    // Puts back the grades applied entries replaced (undo), or the new ones
+    // again (redo). Not logged; see ChangeHistory.
+    void restoreRegrades(const vector<RegradeEntry>& entries, bool previous) {
+        for (const RegradeEntry& entry : entries) {
+            Submission* sub = searchByID(formatSubmissionID(entry.submissionID));
+            if (sub == nullptr || sub->status != SUBMISSION_GRADED) continue;
+            if (previous) changeGrade(sub, entry.previousScore, entry.previousFeedback);
+            else changeGrade(sub, entry.score, entry.feedback);
+        }
+    }
+
+    // visit(submission) for every graded submission of an assignment in FIFO
+    // order: one pass over the snapshot records, then the assignment's queued
+    // submissions. Only matching snapshot records are copied out.
+    template <typename Visit>
+    void forEachGradedOf(const string& assignmentID, Visit visit) {
+        Submission scratch;
+        for (uint32_t i = 0; i < baseRows; i++) {
+            if (base->text(base->submission(i).assignmentID) != assignmentID) continue;
+            const Submission* sub = viewBase(i, scratch);
+            if (sub->status == SUBMISSION_GRADED) visit(*sub);
+        }
+        Symbol assignment;
+        if (!symbols().find(assignmentID, assignment)) return;
+        auto it = byAssignment.find(assignment);
+        if (it == byAssignment.end()) return;
+        for (const Submission* sub : it->second) {
+            if (sub->status == SUBMISSION_GRADED) visit(*sub);
+        }
+    }
+
+    // Re-applies a logged submission without prompting or logging; false
+    // if the symbol table is full
+    bool restoreSubmission(string submissionID, string studentID, string studentName,
+                           string assignmentID, string assignmentTitle,
+                           string submittedDate, string file) {
+        Symbol studentSymbol = intern(studentID);
+        Symbol nameSymbol = intern(studentName);
+        Symbol assignmentSymbol = intern(assignmentID);
+        Symbol titleSymbol = intern(assignmentTitle);
+        if (!interned({studentSymbol, nameSymbol, assignmentSymbol, titleSymbol})) return false;
+        Submission* newSub = submissionPool.allocate();
+        fillPending(newSub, parseSubmissionID(submissionID), studentSymbol, nameSymbol, assignmentSymbol,
+                    titleSymbol, move(submittedDate), file);
+        linkSubmission(newSub);
+
+        int number = (int)newSub->submissionID - 10000;
+        if (number > count) count = number;
+        return true;
+    }
+
+    // Adds a submission from a bulk import: new ID, no prompting or logging.
+    // nullptr if the symbol table is full.
+    Submission* importSubmission(string studentID, string studentName, Assignment* assignment,
+                                 string submittedDate, string file) {
+        Symbol studentSymbol = intern(studentID);
+        Symbol nameSymbol = intern(studentName);
+        Symbol assignmentSymbol = intern(assignment->assignmentID);
+        Symbol titleSymbol = intern(assignment->title);
+        if (!interned({studentSymbol, nameSymbol, assignmentSymbol, titleSymbol})) return nullptr;
+        Submission* newSub = submissionPool.allocate();
+        fillPending(newSub, generateID(), studentSymbol, nameSymbol, assignmentSymbol, titleSymbol,
+                    submittedDate.empty() ? currentTimestamp() : move(submittedDate), file);
+        linkSubmission(newSub);
+        return newSub;
+    }
+
+    // Grades a submission from a bulk import without prompting or logging
+    void importGrade(Submission* sub, int score, string feedback) {
+        markGraded(sub, score, feedback);
+    }
+
+    // Re-applies a logged grade; false if the submission is unknown or graded
+    bool restoreGrade(string submissionID, int score, string feedback) {
+        Submission* sub = searchByID(submissionID);
+        if (sub == nullptr || sub->status == SUBMISSION_GRADED) return false;
+        markGraded(sub, score, feedback);
+        return true;
+    }
+
+    // Takes a grade back (undo): the submission is pending again and its
+    // score leaves the rankings and columns. Not logged; see ChangeHistory.
+    bool ungrade(string submissionID) {
+        Submission* sub = searchByID(submissionID);
+        if (sub == nullptr || sub->status != SUBMISSION_GRADED) return false;
+        int previousScore = sub->score;
+        sub->status = SUBMISSION_PENDING;
+        sub->score = 0;
+        sub->feedback = "Not graded yet";
+        publish(SubmissionEvent{EVENT_UNGRADED, sub, sub->assignmentID, previousScore, ""});
+        return true;
+    }
+
+    // Tell the views and subscribers that an assignment was deleted or
+    // brought back (see ChangeHistory); its submissions are untouched
+    void assignmentRemoved(const string& assignmentID) {
+        publish(SubmissionEvent{EVENT_ASSIGNMENT_REMOVED, nullptr, intern(assignmentID), 0, ""});
+    }
+
+    void assignmentRestored(const string& assignmentID) {
+        publish(SubmissionEvent{EVENT_ASSIGNMENT_RESTORED, nullptr, intern(assignmentID), 0, ""});
+    }
+
+    // Calls subscriber(event) for every change from now on; returns an ID
+    // for unsubscribe. The state to start from is what the listings show.
+    int subscribe(SubmissionSubscriber subscriber) {
+        subscribers.push_back({++nextSubscriber, move(subscriber)});
+        return nextSubscriber;
+    }
+
+    void unsubscribe(int id) {
+        subscribers.erase(remove_if(subscribers.begin(), subscribers.end(),
+                                    [id](const pair<int, SubmissionSubscriber>& entry) { return entry.first == id; }),
+                          subscribers.end());
+    }
+
+    // Every submission in FIFO order: the snapshot, then the queue
+    template <typename Visit>
+    void forEachSubmission(Visit visit) {
+        if (base != nullptr) {
+            Submission scratch;
+            for (uint32_t i = 0; i < base->submissionCount(); i++)
+                visit(*viewBase(i, scratch));
+        }
+        for (Submission* temp = front; temp != nullptr; temp = temp->next)
+            visit(*temp);
+    }
+
+    int getCounter() { return count; }
+    void setCounter(int value) { if (value > count) count = value; }
+
+    // Rankings are kept sorted incrementally by the ranking tree
+
+    // Students at ranks [first, last), best first
+    vector<Student> rankingRange(int first, int last) {
+        MetricTimer timer(METRIC_RANKING_PAGE);
+        ensureRankings();
+        return rankings.range(first, last);
+    }
+
+    // 1-based rank, 0 if the student has no graded submissions
+    int rankOf(string studentID) {
+        ensureRankings();
+        return rankings.rankOf(studentID);
+    }
+
+    int rankingSize() {
+        ensureRankings();
+        return rankings.getSize();
+    }
+
+    // Analytics over the columnar store (see SubmissionColumns); threads > 1
+    // splits the scans across cores with the same result
+    long long gradedCount(int threads = 1) {
+        ensureColumns();
+        return columns.gradedCount(threads);
+    }
+
+    long long submissionCount() {
+        return baseRows + linkedRows;
+    }
+
+    vector<StudentAggregate> studentAggregates(int threads = 1) {
+        ensureColumns();
+        return columns.studentAggregates(threads);
+    }
+
+    vector<AssignmentAggregate> assignmentAggregates(int threads = 1) {
+        ensureColumns();
+        return columns.assignmentAggregates(threads);
+    }
+
+    // Graded submissions whose feedback matches, best first
+    vector<Submission*> searchFeedback(string query, bool matchAll, size_t limit = 20) {
+        MetricTimer timer(METRIC_TEXT_SEARCH);
+        ensureFeedback();
+        vector<Submission*> out;
+        for (const TextHit& hit : feedbackIndex.search(query, matchAll, limit)) {
+            Submission* sub = searchByID(formatSubmissionID(hit.doc));
+            if (sub != nullptr) out.push_back(sub);
+        }
+        return out;
+    }
+
+    // Totals from the views: O(1) once seeded. Seeding comes first, since
+    // it interns the IDs of snapshot records.
+    int pendingCount(const string& assignmentID) {
+        ensureViews();
+        Symbol assignment;
+        if (!symbols().find(assignmentID, assignment)) return 0;
+        return (int)views.pending(assignment);
+    }
+
+    GradeTotals classTotals() {
+        ensureViews();
+        return views.totals();
+    }
+
+    GradeTotals transcript(const string& studentID) {
+        ensureViews();
+        Symbol student;
+        if (!symbols().find(studentID, student)) return GradeTotals{0, 0, 0};
+        return views.transcript(student);
+    }
+
+    // Per-assignment statistics from the views, O(assignments)
+    vector<AssignmentAggregate> assignmentSummaries() {
+        ensureViews();
+        return views.assignmentAggregates();
+    }
+
+    vector<StudentAggregate> rankStudents(int threads = 1) {
+        ensureColumns();
+        return columns.rankStudents(threads);
+    }
+
+    vector<pair<string, PoolStats>> memoryStats() {
+        vector<pair<string, PoolStats>> stats = {
+            {"Submission", submissionPool.getStats()},
+            {"RankNode", rankings.memoryStats()}
+        };
+        if (columnsSeeded) stats.push_back({"Column", columns.memoryStats()});
+        if (feedbackSeeded) stats.push_back({"FeedbackText", feedbackIndex.memoryStats()});
+        return stats;
+    }
+};
+
+#endif
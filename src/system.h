@@ -0,0 +1,816 @@
+// The ELearningSystem facade the menus call, and the per-course router.
+#ifndef ELEARNING_SYSTEM_H
+#define ELEARNING_SYSTEM_H
+
+#include "history.h"
+#include "scheduler.h"
+#include "blobs.h"
+#include "import.h"
+#include "table.h"
+#include "similarity.h"
+
+// ============== LATE PENALTIES ==============
+enum LatePenaltyMode : uint8_t {
+    LATE_NONE,
+    LATE_PER_DAY,   // percent off for every day late, up to maxPercent
+    LATE_FLAT       // percent off once late
+};
+
+// Applied when a lecturer enters a score (grade or single regrade); the
+// score stored is the penalized one. Lateness is whole days between the
+// due date and the submission's timestamp, less graceDays.
+struct LatePolicy {
+    LatePenaltyMode mode;
+    int percent;
+    int graceDays;
+    int maxPercent;
+
+    int penaltyPercent(int daysLate) const {
+        int counted = daysLate - graceDays;
+        if (mode == LATE_NONE || counted <= 0) return 0;
+        if (mode == LATE_FLAT) return min(max(percent, 0), 100);
+        return min(max(percent, 0) * counted, min(max(maxPercent, 0), 100));
+    }
+};
+
+// ============== SYSTEM FACADE ==============
+// The whole engine behind one object: lookups go through the public members,
+// and the operations a front end performs are wrapped here so callers need
+// no knowledge of how records are resolved or persisted.
+//
+// The wrapped operations are thread-safe. submitConcurrent() only takes a
+// shared lock on the assignments and pushes to the lock-free intake queue;
+// everything that changes the list, the queue or the log is serialized by
+// engineLock. Direct member access is for single-threaded callers.
+class ELearningSystem {
+private:
+    mutex engineLock;
+    shared_mutex assignmentLock;  // exclusive while the assignment list changes
+    string metricsPath;           // baseName.prom, see writeMetrics
+
+    // Fed from the queue on demand: all pending work the first time, then
+    // whatever was linked after the cursor
+    GradingScheduler scheduler;
+    bool schedulerSeeded = false;
+    const Submission* schedulerCursor = nullptr;
+    unordered_map<Symbol, uint32_t> dueKeys;
+    LatePolicy latePolicy{LATE_NONE, 0, 0, 100};
+
+    SimilarityIndex similarity;  // off until enableSimilarity
+    int similaritySubscriber = 0;
+
+    // Takes no lock: the file is hashed and copied before the submission is
+    // queued. Without an open store the path itself is kept.
+    Status storeFile(const string& filePath, string& file) {
+        if (!blobs.isOpen()) {
+            file = filePath;
+            return STATUS_OK;
+        }
+        MetricTimer timer(METRIC_STORE_FILE);
+        return blobs.put(filePath, file);
+    }
+
+    // Caller holds engineLock. The late policy applied to a score typed for
+    // the submission; a penalty is noted at the end of the feedback.
+    int penalize(string submissionID, int score, string& feedback) {
+        Submission* sub = submissions.searchByID(submissionID);
+        if (sub == nullptr || score <= 0 || latePolicy.mode == LATE_NONE) return score;
+        uint32_t due = dueKey(sub->assignmentID);
+        if (due == UINT32_MAX) return score;
+        int daysLate = dayNumber(sub->submittedDate) - (int)due;
+        int percent = latePolicy.penaltyPercent(daysLate);
+        if (percent == 0) return score;
+        feedback += " [" + to_string(daysLate) + (daysLate == 1 ? " day" : " days") +
+                    " late: -" + to_string(percent) + "%]";
+        return score * (100 - percent) / 100;
+    }
+
+    // Caller holds engineLock. Checked on the score as typed, as the
+    // penalty could bring one above the max score back into range.
+    bool isValidScore(const string& submissionID, int score) {
+        Submission* sub = submissions.searchByID(submissionID);
+        return sub == nullptr || submissions.isValidScore(sub, score);
+    }
+
+    uint32_t dueKey(Symbol assignmentID) {
+        auto it = dueKeys.find(assignmentID);
+        if (it != dueKeys.end()) return it->second;
+        string dueDate;
+        uint32_t key = assignments.findDueDate(symbolText(assignmentID), dueDate) ? (uint32_t)dayNumber(dueDate) : UINT32_MAX;
+        dueKeys.emplace(assignmentID, key);
+        return key;
+    }
+
+    // Caller holds engineLock
+    void syncScheduler() {
+        submissions.drainIntake([](const Submission&) {});
+        auto add = [&](const Submission& sub) {
+            if (sub.status == SUBMISSION_PENDING)
+                scheduler.add(sub.submissionID, sub.assignmentID, dueKey(sub.assignmentID));
+        };
+        if (!schedulerSeeded) {
+            submissions.forEachPending(add);
+            schedulerCursor = submissions.newestLinked();
+            schedulerSeeded = true;
+        } else {
+            schedulerCursor = submissions.forEachLinkedAfter(schedulerCursor, add);
+        }
+    }
+
+public:
+    AssignmentLinkedList assignments;
+    SubmissionQueue submissions;
+    ChangeHistory history;
+    Storage storage;
+    BlobStore blobs;  // submitted files, by content digest
+
+    ELearningSystem() : history(assignments, submissions), storage(assignments, submissions, history) {
+        submissions.attachAssignments(&assignments);
+    }
+
+    // The similarity workers read blobs, which is destroyed first
+    ~ELearningSystem() {
+        disableSimilarity();
+    }
+
+    // Loads baseName.snap / baseName.wal and stores submitted files under
+    // baseName.blobs; false means changes will not be saved
+    bool open(string baseName) {
+        metricsPath = baseName + ".prom";
+        blobs.open(baseName + ".blobs");
+        return storage.open(baseName);
+    }
+
+    // Changes return STATUS_FILE_ERROR when they took effect but could not
+    // be logged; see Storage::logged
+    Status createAssignment(const AssignmentSpec& spec, Assignment** created = nullptr) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        dueKeys.clear();
+        return storage.logged(history.createAssignment(spec, created));
+    }
+
+    Status editAssignment(const string& id, const AssignmentSpec& spec) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        dueKeys.clear();
+        return storage.logged(history.editAssignment(id, spec));
+    }
+
+    Status deleteAssignment(const string& id) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        dueKeys.clear();
+        return storage.logged(history.deleteAssignment(id));
+    }
+
+    // Steps back through the change history; *undone receives the change
+    Status undo(Change* undone = nullptr) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        dueKeys.clear();
+        Change change{};
+        Status status = history.undo(&change);
+        if (status == STATUS_OK && change.type == CHANGE_GRADE) {
+            // Pending again: graders may be handed it
+            Submission* sub = submissions.searchByID(formatSubmissionID(change.submissionID));
+            if (sub != nullptr) scheduler.add(sub->submissionID, sub->assignmentID, dueKey(sub->assignmentID));
+        }
+        if (undone) *undone = change;
+        return storage.logged(status);
+    }
+
+    Status redo(Change* redone = nullptr) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        dueKeys.clear();
+        Change change{};
+        Status status = history.redo(&change);
+        if (status == STATUS_OK && change.type == CHANGE_GRADE) scheduler.remove(change.submissionID);
+        if (redone) *redone = change;
+        return storage.logged(status);
+    }
+
+    // The file at filePath is copied into the store once the assignment and
+    // duplicate checks pass, outside the locks; STATUS_FILE_ERROR if it
+    // cannot be read. Only a lost race with the same student's other
+    // submit leaves the blob unreferenced.
+    Status submit(const Student& student, string assignmentID, string filePath,
+                  Submission** created = nullptr) {
+        {
+            unique_lock<shared_mutex> writing(assignmentLock);  // searchByID may fill the cache
+            lock_guard<mutex> guard(engineLock);
+            if (assignments.searchByID(assignmentID) == nullptr) return STATUS_NOT_FOUND;
+            if (submissions.isDuplicate(student.studentID, assignmentID)) return STATUS_DUPLICATE;
+        }
+        string file;
+        Status stored = storeFile(filePath, file);
+        if (stored != STATUS_OK) return stored;
+        unique_lock<shared_mutex> writing(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        return storage.logged(submissions.submit(student, assignments.searchByID(assignmentID), move(file), created));
+    }
+
+    // Safe to call from many threads at once; the submission is queued in
+    // arrival order and becomes visible after the next drainSubmissions()
+    Status submitConcurrent(const Student& student, string assignmentID, string filePath,
+                            string* submissionID = nullptr) {
+        string title;
+        {
+            shared_lock<shared_mutex> reading(assignmentLock);
+            if (!assignments.findTitle(assignmentID, title)) return STATUS_NOT_FOUND;
+        }
+        if (submissions.isDuplicate(student.studentID, assignmentID)) return STATUS_DUPLICATE;
+        string file;
+        Status stored = storeFile(filePath, file);
+        if (stored != STATUS_OK) return stored;
+        return submissions.intake(student, assignmentID, title, move(file), submissionID);
+    }
+
+    // Moves queued intake into the submission queue, calling
+    // visit(submission) in FIFO order; any number of grader threads may call it
+    template <typename Visit>
+    int drainSubmissions(Visit visit) {
+        lock_guard<mutex> guard(engineLock);
+        return submissions.drainIntake(visit);
+    }
+
+    int drainSubmissions() {
+        return drainSubmissions([](const Submission&) {});
+    }
+
+    // The late policy is applied to score; see LatePolicy
+    Status grade(string submissionID, int score, string feedback) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        if (!isValidScore(submissionID, score)) return STATUS_INVALID;
+        score = penalize(submissionID, score, feedback);
+        Status status = history.grade(submissionID, score, feedback);
+        if (status == STATUS_OK) scheduler.remove(parseSubmissionID(submissionID));
+        return storage.logged(status);
+    }
+
+    // Replaces the grade of a graded submission (STATUS_NOT_GRADED if it is
+    // pending); the student's ranking moves by the difference
+    Status regrade(string submissionID, int score, string feedback) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        if (!isValidScore(submissionID, score)) return STATUS_INVALID;
+        score = penalize(submissionID, score, feedback);
+        return storage.logged(history.regrade(submissionID, score, feedback));
+    }
+
+    // Sets newScore(submission) on every graded submission of an assignment
+    // (e.g. after a rubric fix) as one batch: one log record and one undo
+    // step. Scores are used as given, without the late policy; feedback is
+    // kept. STATUS_EMPTY if no score changes.
+    template <typename NewScore>
+    Status regradeAssignment(const string& assignmentID, NewScore newScore, size_t* regraded = nullptr) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        vector<RegradeEntry> entries;
+        submissions.forEachGradedOf(assignmentID, [&](const Submission& sub) {
+            int score = newScore(sub);
+            if (score != sub.score) entries.push_back(RegradeEntry{sub.submissionID, 0, score, "", sub.feedback});
+        });
+        Status status = entries.empty() ? STATUS_EMPTY : history.regrade(entries);
+        if (regraded) *regraded = status == STATUS_OK ? entries.size() : 0;
+        return storage.logged(status);
+    }
+
+    // Starts fingerprinting submitted files on a pool of worker threads:
+    // everything submitted so far, then each submission as it is linked.
+    // Submitting only queues the file for a worker.
+    void enableSimilarity(int threads = max(hardwareThreads() - 1, 1)) {
+        lock_guard<mutex> guard(engineLock);
+        if (similarity.isRunning()) return;
+        similarity.start(threads, &blobs);
+        submissions.drainIntake([](const Submission&) {});
+        submissions.forEachSubmission([&](const Submission& sub) {
+            similarity.add(sub.submissionID, sub.assignmentID, sub.file);
+        });
+        similaritySubscriber = submissions.subscribe([this](const SubmissionEvent& event) {
+            if (event.type == EVENT_SUBMITTED)
+                similarity.add(event.submission->submissionID, event.submission->assignmentID,
+                               event.submission->file);
+        });
+    }
+
+    // Files still queued are dropped; indexed ones stay queryable
+    void disableSimilarity() {
+        lock_guard<mutex> guard(engineLock);
+        if (!similarity.isRunning()) return;
+        submissions.unsubscribe(similaritySubscriber);
+        similarity.stop();
+    }
+
+    // Submissions of the same assignment whose files look alike, most
+    // similar first; empty until the submission's file has been indexed
+    vector<SimilarMatch> similarSubmissions(const string& submissionID, size_t limit = 5) {
+        return similarity.similarTo(parseSubmissionID(submissionID), limit);
+    }
+
+    SimilarityStats similarityStats() {
+        return similarity.stats();
+    }
+
+    // Copies a submission's file to destination: from the store, or from
+    // the path logged before files were stored
+    Status copySubmittedFile(const string& submissionID, const string& destination) {
+        string file;
+        {
+            lock_guard<mutex> guard(engineLock);
+            submissions.drainIntake([](const Submission&) {});
+            Submission* sub = submissions.searchByID(submissionID);
+            if (sub == nullptr) return STATUS_NOT_FOUND;
+            file = sub->file;
+        }
+        if (isBlobDigest(file)) return blobs.checkout(file, destination);
+        uint64_t copied;
+        return BlobStore::copyFile(file, destination, copied, false) ? STATUS_OK : STATUS_FILE_ERROR;
+    }
+
+    void setLatePolicy(const LatePolicy& policy) {
+        lock_guard<mutex> guard(engineLock);
+        latePolicy = policy;
+    }
+
+    LatePolicy getLatePolicy() {
+        lock_guard<mutex> guard(engineLock);
+        return latePolicy;
+    }
+
+    // Leases the next pending submission to the grader under the policy;
+    // STATUS_EMPTY when there is none. No other grader is handed it until
+    // completeGrading, releaseSubmission or the lease expiring.
+    Status claimNextSubmission(const string& grader, GradingPolicy policy, string* submissionID) {
+        lock_guard<mutex> guard(engineLock);
+        syncScheduler();
+        uint32_t id;
+        auto pending = [&](uint32_t candidate) {
+            Submission* sub = submissions.searchByID(formatSubmissionID(candidate));
+            return sub != nullptr && sub->status == SUBMISSION_PENDING;
+        };
+        if (!scheduler.claim(grader, policy, GradingScheduler::Clock::now(), id, pending))
+            return STATUS_EMPTY;
+        if (submissionID) *submissionID = formatSubmissionID(id);
+        return STATUS_OK;
+    }
+
+    // Grades a submission the grader holds a lease on
+    Status completeGrading(const string& grader, string submissionID, int score, string feedback) {
+        lock_guard<mutex> guard(engineLock);
+        uint32_t id = parseSubmissionID(submissionID);
+        if (!scheduler.holds(grader, id, GradingScheduler::Clock::now())) return STATUS_INVALID;
+        if (!isValidScore(submissionID, score)) return STATUS_INVALID;
+        score = penalize(submissionID, score, feedback);
+        Status status = history.grade(submissionID, score, feedback);
+        if (status == STATUS_OK)
+            scheduler.complete(grader, id, GradingScheduler::Clock::now());
+        else if (status == STATUS_ALREADY_GRADED)
+            scheduler.remove(id);
+        return storage.logged(status);
+    }
+
+    Status releaseSubmission(const string& grader, string submissionID) {
+        lock_guard<mutex> guard(engineLock);
+        return scheduler.release(grader, parseSubmissionID(submissionID), GradingScheduler::Clock::now());
+    }
+
+    void setLeaseTime(GradingScheduler::Clock::duration lease) {
+        lock_guard<mutex> guard(engineLock);
+        scheduler.setLeaseTime(lease);
+    }
+
+    vector<GraderStats> graderStats() {
+        lock_guard<mutex> guard(engineLock);
+        return scheduler.graderStats();
+    }
+
+    // Aggregates include anything still waiting in the intake queue and
+    // use every core by default
+    vector<AssignmentAggregate> assignmentAggregates(int threads = hardwareThreads()) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.assignmentAggregates(threads);
+    }
+
+    // Maintained totals (see GradeViews): no scan after the first call
+    vector<AssignmentAggregate> assignmentSummaries() {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.assignmentSummaries();
+    }
+
+    GradeTotals gradeTotals() {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.classTotals();
+    }
+
+    GradeTotals transcript(const string& studentID) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.transcript(studentID);
+    }
+
+    // subscriber(event) runs under the engine lock for every submission
+    // change from now on, so it must not call back into the system
+    int subscribe(SubmissionSubscriber subscriber) {
+        lock_guard<mutex> guard(engineLock);
+        return submissions.subscribe(move(subscriber));
+    }
+
+    void unsubscribe(int id) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.unsubscribe(id);
+    }
+
+    vector<StudentAggregate> studentAggregates(int threads = hardwareThreads()) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.studentAggregates(threads);
+    }
+
+    // Full leaderboard recomputed from every submission, in RankingTree order
+    vector<StudentAggregate> rankStudents(int threads = hardwareThreads()) {
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        return submissions.rankStudents(threads);
+    }
+
+    // Ranked keyword searches; the first call builds the index
+    vector<Assignment*> searchAssignments(string query, bool matchAll, size_t limit = 20) {
+        unique_lock<shared_mutex> writing(assignmentLock);
+        return assignments.searchText(query, matchAll, limit);
+    }
+
+    vector<Submission*> searchFeedback(string query, bool matchAll, size_t limit = 20) {
+        lock_guard<mutex> guard(engineLock);
+        return submissions.searchFeedback(query, matchAll, limit);
+    }
+
+    int assignmentCount() {
+        shared_lock<shared_mutex> reading(assignmentLock);
+        return (int)assignments.visibleCount();
+    }
+
+    int today() {
+        return dayNumber(currentDate());
+    }
+
+    // visit(id, title, dueDate, maxScore) for assignments due from today
+    // through `days` days from now, earliest first
+    template <typename Visit>
+    void forEachDueWithin(int days, Visit visit) {
+        shared_lock<shared_mutex> reading(assignmentLock);
+        int from = today();
+        assignments.forEachDueBetween(from, from + days, visit);
+    }
+
+    // visit(id, title, dueDate, pending) for assignments past their due
+    // date that still have ungraded submissions, earliest first
+    template <typename Visit>
+    void forEachOverdueUngraded(Visit visit) {
+        shared_lock<shared_mutex> reading(assignmentLock);
+        lock_guard<mutex> guard(engineLock);
+        submissions.drainIntake([](const Submission&) {});
+        assignments.forEachDueBetween(INT_MIN, today() - 1,
+            [&](string_view id, string_view title, string_view dueDate, int) {
+                int pending = submissions.pendingCount(string(id));
+                if (pending > 0) visit(id, title, dueDate, pending);
+            });
+    }
+
+    vector<pair<string, PoolStats>> memoryStats() {
+        lock_guard<mutex> guard(engineLock);
+        vector<pair<string, PoolStats>> stats = assignments.memoryStats();
+        for (auto& entry : submissions.memoryStats())
+            stats.push_back(entry);
+        stats.push_back({"Symbol", symbols().memoryStats()});
+        return stats;
+    }
+
+    // Prometheus text: operation latencies and event counters, plus each
+    // pool's live objects, allocations and reserved bytes as gauges
+    string metricsText() {
+        string out;
+        appendPrometheusMetrics(out);
+        appendPoolMetrics(out, {{"", memoryStats()}});
+        return out;
+    }
+
+    // Replaces baseName.prom (e.g. for a node exporter's textfile
+    // collector) without readers ever seeing a partial file
+    bool writeMetrics() {
+        if (metricsPath.empty()) return false;
+        string text = metricsText();
+        string tempPath = metricsPath + ".tmp";
+        FILE* out = fopen(tempPath.c_str(), "wb");
+        if (out == nullptr) return false;
+        bool written = fwrite(text.data(), 1, text.size(), out) == text.size();
+        written = fclose(out) == 0 && written;
+#ifdef _WIN32
+        if (written) remove(metricsPath.c_str());
+#endif
+        return written && rename(tempPath.c_str(), metricsPath.c_str()) == 0;
+    }
+
+    void close() {
+        disableSimilarity();
+        {
+            lock_guard<mutex> guard(engineLock);
+            submissions.drainIntake([](const Submission&) {});
+            storage.close();
+        }
+        writeMetrics();
+    }
+};
+
+// ============== COURSE SHARDS (Router) ==============
+// Each course is a complete ELearningSystem: its own assignment list,
+// indexes, submission queue, rankings, locks and files. The router maps a
+// course ID to its shard, so an operation in one course never scans or
+// waits on another, and reports over every course run the shards in
+// parallel. Only the symbol table and the metrics are process-wide.
+//
+// A shard is loaded on first use, under its own lock, and stays loaded.
+// Course IDs are listed in baseName.courses; course X keeps its data in
+// baseName.X.snap / .wal / .hist, except DEFAULT_COURSE, which uses the
+// unsharded baseName files so data from before sharding stays in place.
+const char* const DEFAULT_COURSE = "GENERAL";
+const size_t MAX_COURSE_ID = 32;
+
+// One row of the cross-course report
+struct CourseSummary {
+    string courseID;
+    int assignments;
+    long long submissions;
+    long long graded;
+    long long pending;
+    double mean;       // over graded submissions
+    bool stored;       // false if the shard's files could not be opened
+};
+
+class CourseRouter {
+private:
+    struct CourseShard {
+        mutex loadLock;
+        atomic<bool> loaded{false};
+        ELearningSystem system;
+    };
+
+    string baseName;
+    shared_mutex routerLock;  // guards courses; shards are never removed
+    map<string, unique_ptr<CourseShard>> courses;
+
+    string shardPath(const string& courseID) const {
+        return courseID == DEFAULT_COURSE ? baseName : baseName + "." + courseID;
+    }
+
+    // Caller holds routerLock exclusively. Written to a temp file and
+    // renamed, so a crash leaves either the old list or the new one.
+    bool saveCourseList() {
+        if (baseName.empty()) return true;
+        string path = baseName + ".courses";
+        string tempPath = path + ".tmp";
+        FILE* out = fopen(tempPath.c_str(), "wb");
+        if (out == nullptr) return false;
+        bool written = true;
+        for (auto& entry : courses)
+            written = fprintf(out, "%s\n", entry.first.c_str()) > 0 && written;
+        written = fclose(out) == 0 && written;
+#ifdef _WIN32
+        if (written) remove(path.c_str());
+#endif
+        return written && rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+
+    // Opens the shard's files the first time it is used; other courses
+    // stay available while it loads
+    ELearningSystem& load(CourseShard& shard, const string& courseID) {
+        if (!shard.loaded.load(memory_order_acquire)) {
+            lock_guard<mutex> guard(shard.loadLock);
+            if (!shard.loaded.load(memory_order_relaxed)) {
+                // Storage and file store only: the router writes the one
+                // metrics file. A shard that cannot open its files runs in
+                // memory, as ELearningSystem does; storage.isEnabled() tells.
+                if (!baseName.empty()) {
+                    shard.system.blobs.open(shardPath(courseID) + ".blobs");
+                    shard.system.storage.open(shardPath(courseID));
+                }
+                shard.loaded.store(true, memory_order_release);
+            }
+        }
+        return shard.system;
+    }
+
+    // Shards in course ID order; pointers stay valid for the router's life
+    vector<pair<string, CourseShard*>> shards(bool loadedOnly) {
+        vector<pair<string, CourseShard*>> list;
+        shared_lock<shared_mutex> reading(routerLock);
+        for (auto& entry : courses) {
+            if (!loadedOnly || entry.second->loaded.load(memory_order_acquire))
+                list.push_back({entry.first, entry.second.get()});
+        }
+        return list;
+    }
+
+public:
+    CourseRouter() {
+        courses[DEFAULT_COURSE].reset(new CourseShard());
+    }
+
+    CourseRouter(const CourseRouter&) = delete;
+    CourseRouter& operator=(const CourseRouter&) = delete;
+
+    // Reads the course list; no shard is loaded until it is used. false
+    // if the list exists but cannot be read
+    bool open(string base) {
+        unique_lock<shared_mutex> writing(routerLock);
+        baseName = base;
+        FILE* in = fopen((baseName + ".courses").c_str(), "rb");
+        if (in == nullptr) return errno == ENOENT;
+        char line[MAX_COURSE_ID + 2];
+        while (fgets(line, sizeof(line), in) != nullptr) {
+            string courseID = line;
+            while (!courseID.empty() && (courseID.back() == '\n' || courseID.back() == '\r'))
+                courseID.pop_back();
+            if (normalizeCourseID(courseID) && courses.find(courseID) == courses.end())
+                courses[courseID].reset(new CourseShard());
+        }
+        bool ok = !ferror(in);
+        fclose(in);
+        return ok;
+    }
+
+    // Letters, digits, '-' and '_', at most MAX_COURSE_ID of them; letters
+    // are upper-cased so "cs101" and "CS101" share one set of files even
+    // on case-insensitive file systems
+    static bool normalizeCourseID(string& courseID) {
+        if (courseID.empty() || courseID.size() > MAX_COURSE_ID) return false;
+        for (char& c : courseID) {
+            if (!isalnum((unsigned char)c) && c != '-' && c != '_') return false;
+            c = (char)toupper((unsigned char)c);
+        }
+        return true;
+    }
+
+    // The course's shard, loading it on first use. With create, an unknown
+    // course is added to the list; without it, it is STATUS_NOT_FOUND.
+    Status course(string courseID, ELearningSystem** shard, bool create = false) {
+        if (!normalizeCourseID(courseID)) return STATUS_INVALID;
+        CourseShard* found = nullptr;
+        {
+            shared_lock<shared_mutex> reading(routerLock);
+            auto it = courses.find(courseID);
+            if (it != courses.end()) found = it->second.get();
+        }
+        if (found == nullptr) {
+            if (!create) return STATUS_NOT_FOUND;
+            unique_lock<shared_mutex> writing(routerLock);
+            unique_ptr<CourseShard>& slot = courses[courseID];
+            if (!slot) {
+                slot.reset(new CourseShard());
+                saveCourseList();
+            }
+            found = slot.get();
+        }
+        ELearningSystem& system = load(*found, courseID);
+        if (shard) *shard = &system;
+        return STATUS_OK;
+    }
+
+    ELearningSystem& defaultCourse() {
+        ELearningSystem* shard = nullptr;
+        course(DEFAULT_COURSE, &shard);
+        return *shard;
+    }
+
+    vector<string> courseIDs() {
+        vector<string> ids;
+        shared_lock<shared_mutex> reading(routerLock);
+        for (auto& entry : courses) ids.push_back(entry.first);
+        return ids;
+    }
+
+    // Calls work(courseID, system) for every course, loading each, with the
+    // courses split across up to `threads` threads. Calls for one course
+    // never overlap, but work must be safe to run for different courses
+    // at once: use the facade's operations, not the members directly.
+    template <typename Work>
+    void forEachCourse(Work work, int threads = hardwareThreads()) {
+        vector<pair<string, CourseShard*>> list = shards(false);
+        int workers = (int)max<size_t>(1, min<size_t>(threads, list.size()));
+        forEachPartition(list.size(), workers, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; i++)
+                work(list[i].first, load(*list[i].second, list[i].first));
+        });
+    }
+
+    vector<CourseSummary> courseSummaries(int threads = hardwareThreads()) {
+        vector<string> ids = courseIDs();
+        vector<CourseSummary> summaries(ids.size());
+        forEachCourse([&](const string& courseID, ELearningSystem& system) {
+            size_t slot = lower_bound(ids.begin(), ids.end(), courseID) - ids.begin();
+            if (slot == ids.size() || ids[slot] != courseID) return;  // added after ids was taken
+            GradeTotals totals = system.gradeTotals();
+            CourseSummary summary{courseID, 0, totals.submitted, totals.graded, totals.pending(),
+                                  totals.average(), system.storage.isEnabled()};
+            summary.assignments = system.assignmentCount();
+            summaries[slot] = summary;
+        }, threads);
+        return summaries;
+    }
+
+    // Institution-wide leaderboard: each student's totals summed over all
+    // courses, in RankingTree order
+    vector<StudentAggregate> rankStudents(int threads = hardwareThreads()) {
+        mutex mergeLock;
+        unordered_map<Symbol, StudentAggregate> totals;
+        forEachCourse([&](const string&, ELearningSystem& system) {
+            vector<StudentAggregate> ranked = system.rankStudents(1);
+            lock_guard<mutex> guard(mergeLock);
+            for (const StudentAggregate& entry : ranked) {
+                StudentAggregate& total = totals.emplace(entry.studentID,
+                                                         StudentAggregate{entry.studentID, 0, 0, 0}).first->second;
+                total.totalScore += entry.totalScore;
+                total.graded += entry.graded;
+            }
+        }, threads);
+
+        vector<StudentAggregate> ranked;
+        ranked.reserve(totals.size());
+        for (auto& entry : totals) {
+            entry.second.average = (double)entry.second.totalScore / entry.second.graded;
+            ranked.push_back(entry.second);
+        }
+        sort(ranked.begin(), ranked.end(), [](const StudentAggregate& a, const StudentAggregate& b) {
+            if (a.totalScore != b.totalScore) return a.totalScore > b.totalScore;
+            return symbolText(a.studentID) < symbolText(b.studentID);
+        });
+        return ranked;
+    }
+
+    // Latencies, counters and the shared symbol pool once, then the pools
+    // of every loaded course
+    string metricsText() {
+        string out;
+        appendPrometheusMetrics(out);
+        vector<pair<string, vector<pair<string, PoolStats>>>> groups;
+        groups.push_back({"", {{"Symbol", symbols().memoryStats()}}});
+        for (auto& entry : shards(true)) {
+            vector<pair<string, PoolStats>> pools = entry.second->system.memoryStats();
+            pools.erase(remove_if(pools.begin(), pools.end(),
+                                  [](const pair<string, PoolStats>& pool) { return pool.first == "Symbol"; }),
+                        pools.end());
+            groups.push_back({entry.first, pools});
+        }
+        appendPoolMetrics(out, groups);
+        return out;
+    }
+
+    // Replaces baseName.prom, as ELearningSystem::writeMetrics does
+    bool writeMetrics() {
+        if (baseName.empty()) return false;
+        string text = metricsText();
+        string path = baseName + ".prom";
+        string tempPath = path + ".tmp";
+        FILE* out = fopen(tempPath.c_str(), "wb");
+        if (out == nullptr) return false;
+        bool written = fwrite(text.data(), 1, text.size(), out) == text.size();
+        written = fclose(out) == 0 && written;
+#ifdef _WIN32
+        if (written) remove(path.c_str());
+#endif
+        return written && rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+
+    // Housekeeping for a single-threaded front end, over loaded courses only;
+    // false if some course's acknowledged changes may not be on disk
+    bool sync() {
+        bool ok = true;
+        for (auto& entry : shards(true))
+            ok = entry.second->system.storage.sync() && ok;
+        return ok;
+    }
+
+    bool checkpointIfNeeded() {
+        bool ok = true;
+        for (auto& entry : shards(true))
+            ok = entry.second->system.storage.checkpointIfNeeded() && ok;
+        return ok;
+    }
+
+    // Closes the loaded courses in parallel, each leaving a snapshot
+    void close(int threads = hardwareThreads()) {
+        vector<pair<string, CourseShard*>> list = shards(true);
+        int workers = (int)max<size_t>(1, min<size_t>(threads, list.size()));
+        forEachPartition(list.size(), workers, [&](size_t begin, size_t end, int) {
+            for (size_t i = begin; i < end; i++) list[i].second->system.close();
+        });
+        writeMetrics();
+    }
+};
+
+#endif
@@ -0,0 +1,76 @@
+// Buffered, column-aligned table output.
+#ifndef ELEARNING_TABLE_H
+#define ELEARNING_TABLE_H
+
+#include "core.h"
+
+// ============== TABLE WRITER (Buffered Output) ==============
+// Formats left-aligned, fixed-width rows into one reusable buffer so a
+// front end can emit a whole page with a single write instead of a stream
+// insertion per cell and a flush per row. Like setw, a cell wider than its
+// column is kept whole and pushes the rest of the row right.
+class TableWriter {
+private:
+    string buffer;
+    vector<int> widths;
+    size_t column;
+
+    TableWriter& pad(size_t used) {
+        size_t width = column < widths.size() ? (size_t)widths[column] : 0;
+        if (used < width) buffer.append(width - used, ' ');
+        column++;
+        return *this;
+    }
+
+public:
+    TableWriter() : column(0) {}
+
+    // Width of each column in characters; 0 means no padding
+    void setColumns(vector<int> columnWidths) {
+        widths = move(columnWidths);
+        column = 0;
+    }
+
+    TableWriter& cell(string_view text) {
+        buffer.append(text);
+        return pad(text.size());
+    }
+
+    TableWriter& cell(long long value) {
+        char digits[24];
+        int length = snprintf(digits, sizeof(digits), "%lld", value);
+        return cell(string_view(digits, length));
+    }
+
+    TableWriter& cell(double value, int precision) {
+        char digits[64];
+        int length = snprintf(digits, sizeof(digits), "%.*f", precision, value);
+        return cell(string_view(digits, min(length, (int)sizeof(digits) - 1)));
+    }
+
+    void endRow() {
+        buffer += '\n';
+        column = 0;
+    }
+
+    void rule(int width) {
+        buffer.append(width, '-');
+        buffer += '\n';
+    }
+
+    void text(string_view line) {
+        buffer.append(line);
+    }
+
+    const string& str() const {
+        return buffer;
+    }
+
+    // Empties the buffer but keeps its capacity for the next page
+    void clear() {
+        buffer.clear();
+        column = 0;
+    }
+};
+
+#endif
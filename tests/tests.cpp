@@ -0,0 +1,985 @@
+// Behaviour checks for the engine, run by ctest or directly:
+//
+//   ./elearning-tests [FILTER]
+//
+// Each test drives the library through its API in a fresh scratch
+// directory, with no console I/O beyond one line per failed check and a
+// summary. FILTER runs only the tests whose name contains it.
+#include <iostream>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <set>
+#include "elearning.h"
+
+static int checks = 0;
+static int failures = 0;
+
+#define CHECK(condition)                                                             \
+    do {                                                                             \
+        checks++;                                                                    \
+        if (!(condition)) {                                                          \
+            failures++;                                                              \
+            cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+        }                                                                            \
+    } while (0)
+
+// Writes a small file for submit() to store; returns its path
+static string writeFile(const string& dir, const string& name, const string& contents) {
+    string path = dir + "/" + name;
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == nullptr) return path;
+    fwrite(contents.data(), 1, contents.size(), out);
+    fclose(out);
+    return path;
+}
+
+static string readFile(const string& path) {
+    string contents;
+    FILE* in = fopen(path.c_str(), "rb");
+    if (in == nullptr) return contents;
+    char buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), in)) > 0) contents.append(buffer, got);
+    fclose(in);
+    return contents;
+}
+
+static Student student(const string& id) {
+    return Student{id, "Student " + id, id + "@uni.edu", 0, 0};
+}
+
+// A detached assignment for testing the indexes on their own
+static unique_ptr<Assignment> makeAssignment(const string& id, const string& title, const string& dueDate) {
+    unique_ptr<Assignment> assg(new Assignment());
+    assg->assignmentID = id;
+    assg->title = title;
+    assg->dueDate = dueDate;
+    assg->maxScore = 100;
+    assg->dueDay = dayNumber(dueDate);
+    assg->listOrder = (uint32_t)assignmentNumber(id);
+    assg->next = nullptr;
+    assg->prev = nullptr;
+    return assg;
+}
+
+static vector<string> idsOf(const vector<Assignment*>& found) {
+    vector<string> ids;
+    for (Assignment* assg : found) ids.push_back(assg->assignmentID);
+    return ids;
+}
+
+// ============== SYSTEM FACADE ==============
+static void testAssignmentLifecycle(const string& dir) {
+    ELearningSystem app;
+    CHECK(app.open(dir + "/course"));
+
+    Assignment* lab = nullptr;
+    CHECK(app.createAssignment({"Lab 1", "Linked lists", "2025-02-01", 20}, &lab) == STATUS_OK);
+    CHECK(lab != nullptr && lab->maxScore == 20);
+    CHECK(app.createAssignment({"", "no title", "2025-02-01", 20}) == STATUS_INVALID);
+    CHECK(app.createAssignment({"Lab 2", "", "2025-02-30", 20}) == STATUS_INVALID);
+    CHECK(app.createAssignment({"Lab 2", "", "2025-02-03", 0}) == STATUS_INVALID);
+    CHECK(app.assignmentCount() == 1);
+
+    string labID = lab->assignmentID;
+    string file = writeFile(dir, "lab1.txt", "struct Node { int value; Node* next; };\n");
+    Submission* sub = nullptr;
+    CHECK(app.submit(student("S1"), labID, file, &sub) == STATUS_OK);
+    CHECK(sub != nullptr && sub->status == SUBMISSION_PENDING);
+    CHECK(app.submit(student("S1"), labID, file) == STATUS_DUPLICATE);
+    CHECK(app.submit(student("S2"), "ASSG9999", file) == STATUS_NOT_FOUND);
+    CHECK(app.submit(student("S2"), labID, dir + "/missing.txt") == STATUS_FILE_ERROR);
+    CHECK(app.submissions.pendingCount() == 1);
+
+    string subID = formatSubmissionID(sub->submissionID);
+    CHECK(app.regrade(subID, 10, "early") == STATUS_NOT_GRADED);
+    CHECK(app.grade(subID, 21, "too high") == STATUS_INVALID);
+    CHECK(app.grade(subID, -1, "too low") == STATUS_INVALID);
+    CHECK(app.grade(subID, 18, "good") == STATUS_OK);
+    CHECK(app.grade(subID, 19, "again") == STATUS_ALREADY_GRADED);
+    CHECK(app.regrade(subID, 20, "better") == STATUS_OK);
+    CHECK(app.grade("SUB99999", 5, "none") == STATUS_NOT_FOUND);
+    CHECK(app.submissions.pendingCount() == 0);
+    app.close();
+
+    ELearningSystem reopened;
+    CHECK(reopened.open(dir + "/course"));
+    Assignment* found = reopened.assignments.searchByID(labID);
+    CHECK(found != nullptr && found->title == "Lab 1" && found->dueDate == "2025-02-01");
+    Submission* graded = reopened.submissions.searchByID(subID);
+    CHECK(graded != nullptr && graded->status == SUBMISSION_GRADED);
+    CHECK(graded != nullptr && graded->score == 20 && graded->feedback == "better");
+    CHECK(reopened.submit(student("S1"), labID, file) == STATUS_DUPLICATE);
+    reopened.close();
+}
+
+// ============== B+ TREE ==============
+// The expected result of a scan: IDs of the model's keys in [low, high], in
+// (title, ID) order
+static vector<string> modelRange(const set<pair<string, string>>& model, const string& low, const string& high) {
+    vector<string> ids;
+    for (auto it = model.lower_bound({low, ""}); it != model.end() && it->first <= high; ++it)
+        ids.push_back(it->second);
+    return ids;
+}
+
+static vector<string> modelPrefix(const set<pair<string, string>>& model, const string& prefix) {
+    vector<string> ids;
+    for (auto it = model.lower_bound({prefix, ""}); it != model.end(); ++it) {
+        if (it->first.compare(0, prefix.size(), prefix) != 0) break;
+        ids.push_back(it->second);
+    }
+    return ids;
+}
+
+// Every title is shared by three assignments, and the tree grows to three
+// levels before deletes shrink it back to nothing
+static void testBPlusDuplicatesAndScans(const string&) {
+    const int TITLES = 1000;
+    const int COPIES = 3;
+    vector<unique_ptr<Assignment>> owned;
+    for (int i = 0; i < TITLES * COPIES; i++) {
+        char title[16];
+        snprintf(title, sizeof(title), "Topic %03d", i % TITLES);
+        owned.push_back(makeAssignment("ASSG" + to_string(10000 + i), title, "2025-03-01"));
+    }
+    vector<Assignment*> order;
+    for (auto& assg : owned) order.push_back(assg.get());
+    mt19937 random(3);
+    shuffle(order.begin(), order.end(), random);
+
+    BPlusTree tree;
+    set<pair<string, string>> model;
+    for (Assignment* assg : order) {
+        tree.insertItem(assg->title, assg);
+        model.insert({assg->title, assg->assignmentID});
+    }
+    CHECK(tree.getSize() == TITLES * COPIES);
+
+    vector<string> copies = idsOf(tree.searchAll("Topic 042"));
+    CHECK(copies == (vector<string>{"ASSG10042", "ASSG11042", "ASSG12042"}));
+    CHECK(tree.searchByTitle("Topic 042") == owned[42].get());
+    CHECK(tree.searchByTitle("Topic 1000") == nullptr);
+    CHECK(tree.searchAll("Topic").empty());
+
+    CHECK(idsOf(tree.searchPrefix("Topic 04")) == modelPrefix(model, "Topic 04"));
+    CHECK(tree.searchPrefix("Topic 04").size() == 10 * COPIES);
+    CHECK(tree.searchPrefix("Lab").empty());
+    CHECK(idsOf(tree.searchRange("Topic 100", "Topic 199")) == modelRange(model, "Topic 100", "Topic 199"));
+    CHECK(tree.searchRange("Topic 100", "Topic 199").size() == 100 * COPIES);
+    CHECK(tree.searchRange("Topic 5", "Topic 4").empty());
+    CHECK(idsOf(tree.searchRange("", "~")) == modelRange(model, "", "~"));
+
+    // Deleting one copy leaves the others; deleting an absent pair does nothing
+    tree.deleteItem("Topic 042", owned[1042].get());
+    model.erase({"Topic 042", "ASSG11042"});
+    CHECK(idsOf(tree.searchAll("Topic 042")) == (vector<string>{"ASSG10042", "ASSG12042"}));
+    tree.deleteItem("Topic 043", owned[42].get());
+    CHECK(tree.getSize() == TITLES * COPIES - 1);
+
+    shuffle(order.begin(), order.end(), random);
+    int removed = 1;
+    for (Assignment* assg : order) {
+        if (assg == owned[1042].get()) continue;
+        tree.deleteItem(assg->title, assg);
+        model.erase({assg->title, assg->assignmentID});
+        removed++;
+        if (removed % 500 == 0) {
+            CHECK(tree.getSize() == (int)model.size());
+            CHECK(idsOf(tree.searchRange("", "~")) == modelRange(model, "", "~"));
+            CHECK(idsOf(tree.searchPrefix("Topic 7")) == modelPrefix(model, "Topic 7"));
+        }
+    }
+    CHECK(tree.getSize() == 0);
+    CHECK(tree.searchRange("", "~").empty());
+    CHECK(tree.searchByTitle("Topic 042") == nullptr);
+
+    // An emptied tree takes inserts again, one at a time or in bulk
+    tree.insertItem(owned[7]->title, owned[7].get());
+    vector<Assignment*> batch;
+    for (int i = 100; i < 700; i++) batch.push_back(owned[i].get());
+    tree.bulkInsert(batch);
+    CHECK(tree.getSize() == 601);
+    CHECK(idsOf(tree.searchAll("Topic 107")) == (vector<string>{"ASSG10107"}));
+    CHECK(tree.searchRange("Topic 000", "Topic 099").size() == 1);
+    CHECK(tree.searchPrefix("Topic 6").size() == 100);
+}
+
+// ============== WRITE-AHEAD LOG ==============
+// A crash can leave the log ending in a partial record. Cuts the log of a
+// session inside each record in turn and checks that a restart keeps exactly
+// the records before the cut, and that the torn tail is gone before new
+// records are appended.
+static void testWalReplayAfterTruncation(const string& dir) {
+    string wal;
+    string subID;
+    {
+        ELearningSystem app;
+        CHECK(app.open(dir + "/course"));
+        Assignment* first = nullptr;
+        Assignment* second = nullptr;
+        CHECK(app.createAssignment({"Lab 1", "", "2025-02-01", 10}, &first) == STATUS_OK);
+        CHECK(app.createAssignment({"Lab 2", "", "2025-02-08", 10}, &second) == STATUS_OK);
+        Submission* sub = nullptr;
+        CHECK(app.submit(student("S1"), first->assignmentID, writeFile(dir, "a.txt", "answer"), &sub) == STATUS_OK);
+        subID = formatSubmissionID(sub->submissionID);
+        CHECK(app.grade(subID, 7, "fine") == STATUS_OK);
+        CHECK(app.deleteAssignment(second->assignmentID) == STATUS_OK);
+        // What a crash right now would leave behind: no snapshot, this log
+        wal = readFile(dir + "/course.wal");
+        app.close();
+    }
+
+    vector<size_t> ends;  // offset just past each record
+    for (size_t pos = 0; pos + 8 <= wal.size();) {
+        RecordReader header(wal.data() + pos, 8);
+        pos += 8 + header.getU32();
+        ends.push_back(pos);
+    }
+    CHECK(ends.size() == 5 && ends.back() == wal.size());
+
+    // Assignments and the submission's state after the first k records
+    const int assignmentsAfter[] = {0, 1, 2, 2, 2, 1};
+    for (size_t k = 0; k < ends.size(); k++) {
+        string base = dir + "/crash" + to_string(k);
+        size_t cut = ends[k] - 3;  // inside record k
+        writeFile(dir, "crash" + to_string(k) + ".wal", wal.substr(0, cut));
+
+        uint64_t lastSequence = 0;
+        int records = -1;
+        CHECK(!WriteAheadLog::replay(base + ".wal", lastSequence, records,
+                                     [](uint64_t, LogRecordType, RecordReader&) {}));
+        CHECK(records == (int)k);
+
+        ELearningSystem app;
+        CHECK(app.open(base));
+        CHECK(app.assignmentCount() == assignmentsAfter[k]);
+        Submission* sub = app.submissions.searchByID(subID);
+        CHECK((sub != nullptr) == (k >= 3));
+        if (sub != nullptr) CHECK(sub->status == (k >= 4 ? SUBMISSION_GRADED : SUBMISSION_PENDING));
+        if (k == 3) CHECK(app.grade(subID, 9, "after restart") == STATUS_OK);
+        app.close();
+
+        if (k != 3) continue;
+        // The torn tail was cut off at open, so the new grade replays too
+        ELearningSystem reopened;
+        CHECK(reopened.open(base));
+        Submission* graded = reopened.submissions.searchByID(subID);
+        CHECK(graded != nullptr && graded->score == 9 && graded->feedback == "after restart");
+        reopened.close();
+    }
+
+    // The untouched log replays in full
+    writeFile(dir, "whole.wal", wal);
+    ELearningSystem whole;
+    CHECK(whole.open(dir + "/whole"));
+    CHECK(whole.assignmentCount() == assignmentsAfter[5]);
+    Submission* sub = whole.submissions.searchByID(subID);
+    CHECK(sub != nullptr && sub->score == 7);
+    whole.close();
+}
+
+// ============== MAPPED SNAPSHOT ==============
+// Everything a listing can show, one line per assignment and submission
+static string describe(ELearningSystem& app) {
+    string text;
+    app.assignments.forEachByDueDate([&](string_view id, string_view title, string_view due, int maxScore) {
+        text += string(id) + "|" + string(title) + "|" + string(due) + "|" + to_string(maxScore) + "\n";
+    });
+    app.submissions.forEachSubmission([&](const Submission& sub) {
+        text += formatSubmissionID(sub.submissionID) + "|" + symbolText(sub.studentID) + "|" +
+                symbolText(sub.studentName) + "|" + symbolText(sub.assignmentID) + "|" +
+                symbolText(sub.assignmentTitle) + "|" + sub.submittedDate + "|" + sub.file + "|" +
+                statusName(sub.status) + "|" + to_string(sub.score) + "|" + sub.feedback + "\n";
+    });
+    for (int s = 0; s < 12; s++) {
+        GradeTotals totals = app.transcript("S" + to_string(s));
+        text += to_string(totals.submitted) + "/" + to_string(totals.graded) + "/" + to_string(totals.scoreTotal) + "\n";
+    }
+    return text;
+}
+
+// A clean close leaves only a snapshot; reopening maps it and must show the
+// same state, and changes made on top of the mapped state must survive the
+// next round trip
+static void testSnapshotRoundTrip(const string& dir) {
+    string base = dir + "/course";
+    string before;
+    vector<string> ids;
+    {
+        ELearningSystem app;
+        CHECK(app.open(base));
+        mt19937 random(6);
+        for (int i = 0; i < 40; i++) {
+            char due[16];
+            snprintf(due, sizeof(due), "2025-%02d-%02d", 1 + (int)(random() % 12), 1 + (int)(random() % 28));
+            Assignment* assg = nullptr;
+            CHECK(app.createAssignment({"Essay " + to_string(i % 7), "Part " + to_string(i), due, 50 + i}, &assg) ==
+                  STATUS_OK);
+            ids.push_back(assg->assignmentID);
+        }
+        CHECK(app.deleteAssignment(ids[5]) == STATUS_OK);
+        for (int i = 0; i < 120; i++) {
+            string id = ids[random() % ids.size()];
+            Submission* sub = nullptr;
+            string file = writeFile(dir, "essay" + to_string(i % 9) + ".txt", "draft " + to_string(i % 9));
+            if (app.submit(student("S" + to_string(i % 12)), id, file, &sub) != STATUS_OK) continue;
+            if (i % 3 != 0)
+                CHECK(app.grade(formatSubmissionID(sub->submissionID), i % 50, "note " + to_string(i)) == STATUS_OK);
+        }
+        before = describe(app);
+        app.close();
+    }
+    CHECK(filesystem::file_size(base + ".wal") == 0);
+
+    MappedSnapshot snapshot;
+    CHECK(snapshot.open(base + ".snap") == SNAPSHOT_OK);
+    CHECK(snapshot.assignmentCount() == 39);
+    CHECK(snapshot.submissionCount() > 0 && snapshot.studentCount() <= 12);
+    for (uint32_t pos = 1; pos < snapshot.assignmentCount(); pos++) {
+        CHECK(snapshot.text(snapshot.assignment(snapshot.byDue(pos - 1)).dueDate) <=
+              snapshot.text(snapshot.assignment(snapshot.byDue(pos)).dueDate));
+        CHECK(snapshot.text(snapshot.assignment(snapshot.byTitle(pos - 1)).title) <=
+              snapshot.text(snapshot.assignment(snapshot.byTitle(pos)).title));
+    }
+    long found = snapshot.findAssignment(ids[7]);
+    CHECK(found >= 0 && snapshot.text(snapshot.assignment((uint32_t)found).description) == "Part 7");
+    CHECK(snapshot.findAssignment(ids[5]) == -1);
+    snapshot.close();
+
+    string after;
+    {
+        ELearningSystem app;
+        CHECK(app.open(base));
+        CHECK(describe(app) == before);
+        CHECK(app.editAssignment(ids[7], {"Essay 7b", "Part 7, revised", "2025-06-30", 80}) == STATUS_OK);
+        CHECK(app.deleteAssignment(ids[8]) == STATUS_OK);
+        app.submissions.forEachPending([&](const Submission& sub) {
+            if (after.empty()) after = formatSubmissionID(sub.submissionID);
+        });
+        CHECK(!after.empty() && app.grade(after, 1, "late review") == STATUS_OK);
+        after = describe(app);
+        app.close();
+    }
+    ELearningSystem app;
+    CHECK(app.open(base));
+    CHECK(describe(app) == after);
+    CHECK(app.searchAssignments("revised", true).size() == 1);
+    app.close();
+
+    // A damaged header or a cut-short file is refused, not mapped
+    string bytes = readFile(base + ".snap");
+    string damaged = bytes;
+    damaged[offsetof(SnapHeader, lastSequence)] ^= 1;
+    writeFile(dir, "damaged.snap", damaged);
+    CHECK(snapshot.open(dir + "/damaged.snap") == SNAPSHOT_CORRUPT);
+    writeFile(dir, "short.snap", bytes.substr(0, bytes.size() / 2));
+    CHECK(snapshot.open(dir + "/short.snap") == SNAPSHOT_CORRUPT);
+    CHECK(snapshot.open(dir + "/absent.snap") == SNAPSHOT_MISSING);
+    ELearningSystem refused;
+    CHECK(!refused.open(dir + "/damaged"));
+}
+
+// ============== CONCURRENT INTAKE ==============
+// Every producer thread tries every (student, assignment) pair, half through
+// submitConcurrent and half through submit, while a grader thread drains
+// the intake: each pair must be accepted exactly once, and the drain must
+// keep each producer's submissions in the order it made them.
+static void testConcurrentDuplicateClaims(const string& dir) {
+    const int PRODUCERS = 8;
+    const int STUDENTS = 40;
+    const int ASSIGNMENTS = 4;
+    ELearningSystem app;
+    CHECK(app.open(dir + "/course"));
+    vector<string> ids;
+    for (int i = 0; i < ASSIGNMENTS; i++) {
+        Assignment* assg = nullptr;
+        CHECK(app.createAssignment({"Lab " + to_string(i), "", "2025-05-01", 10}, &assg) == STATUS_OK);
+        ids.push_back(assg->assignmentID);
+    }
+    string file = writeFile(dir, "lab.txt", "same file for everyone");
+
+    atomic<int> accepted[STUDENTS * ASSIGNMENTS] = {};
+    atomic<int> duplicates(0);
+    atomic<int> running(PRODUCERS);
+    vector<vector<string>> madeBy(PRODUCERS);
+    vector<string> drained;
+    thread grader([&]() {
+        while (running.load() > 0)
+            app.drainSubmissions([&](const Submission& sub) { drained.push_back(formatSubmissionID(sub.submissionID)); });
+    });
+    vector<thread> producers;
+    for (int t = 0; t < PRODUCERS; t++) {
+        producers.emplace_back([&, t]() {
+            mt19937 random(t);
+            vector<int> pairs(STUDENTS * ASSIGNMENTS);
+            for (int i = 0; i < (int)pairs.size(); i++) pairs[i] = i;
+            shuffle(pairs.begin(), pairs.end(), random);
+            for (int pair : pairs) {
+                Student who = student("S" + to_string(pair / ASSIGNMENTS));
+                const string& assignmentID = ids[pair % ASSIGNMENTS];
+                Status status;
+                if (t % 2 == 0) {
+                    string submissionID;
+                    status = app.submitConcurrent(who, assignmentID, file, &submissionID);
+                    if (status == STATUS_OK) madeBy[t].push_back(submissionID);
+                } else {
+                    status = app.submit(who, assignmentID, file);
+                }
+                if (status == STATUS_OK) accepted[pair]++;
+                else if (status == STATUS_DUPLICATE) duplicates++;
+            }
+            running--;
+        });
+    }
+    for (thread& producer : producers) producer.join();
+    grader.join();
+    app.drainSubmissions([&](const Submission& sub) { drained.push_back(formatSubmissionID(sub.submissionID)); });
+
+    int once = 0;
+    for (atomic<int>& count : accepted) once += count.load() == 1;
+    CHECK(once == STUDENTS * ASSIGNMENTS);
+    CHECK(duplicates.load() == (PRODUCERS - 1) * STUDENTS * ASSIGNMENTS);
+    CHECK(app.submissions.pendingCount() == (size_t)(STUDENTS * ASSIGNMENTS));
+    CHECK(app.gradeTotals().submitted == STUDENTS * ASSIGNMENTS);
+
+    unordered_map<string, size_t> position;
+    for (size_t i = 0; i < drained.size(); i++) position[drained[i]] = i;
+    for (int t = 0; t < PRODUCERS; t += 2) {
+        for (size_t i = 0; i < madeBy[t].size(); i++) {
+            CHECK(position.count(madeBy[t][i]) == 1);
+            if (i > 0) CHECK(position[madeBy[t][i - 1]] < position[madeBy[t][i]]);
+        }
+    }
+
+    // The claims are rebuilt from the saved state after a restart
+    app.close();
+    ELearningSystem reopened;
+    CHECK(reopened.open(dir + "/course"));
+    CHECK(reopened.submissions.pendingCount() == (size_t)(STUDENTS * ASSIGNMENTS));
+    CHECK(reopened.submitConcurrent(student("S3"), ids[1], file) == STATUS_DUPLICATE);
+    CHECK(reopened.submit(student("S3"), ids[2], file) == STATUS_DUPLICATE);
+    CHECK(reopened.submitConcurrent(student("S" + to_string(STUDENTS)), ids[1], file) == STATUS_OK);
+    reopened.close();
+}
+
+// ============== CHANGE HISTORY ==============
+static string titleOf(ELearningSystem& app, const string& id) {
+    Assignment* assg = app.assignments.searchByID(id);
+    return assg == nullptr ? "-" : assg->title + "/" + to_string(assg->maxScore);
+}
+
+// Two assignments share a title, so undoing one creation must remove that
+// assignment and not its namesake. Undo and redo walk create, edit, grade
+// and delete both ways, survive a restart, and the log keeps only the last
+// HISTORY_LIMIT changes.
+static void testUndoRedo(const string& dir) {
+    string base = dir + "/course";
+    ELearningSystem app;
+    CHECK(app.open(base));
+    CHECK(app.undo() == STATUS_EMPTY);
+    Assignment* assg = nullptr;
+    CHECK(app.createAssignment({"Quiz", "", "2025-04-01", 10}, &assg) == STATUS_OK);
+    string first = assg->assignmentID;
+    CHECK(app.createAssignment({"Quiz", "", "2025-04-08", 10}, &assg) == STATUS_OK);
+    string second = assg->assignmentID;
+    CHECK(app.editAssignment(first, {"Quiz (final)", "", "2025-04-02", 20}) == STATUS_OK);
+    Submission* sub = nullptr;
+    CHECK(app.submit(student("S1"), second, writeFile(dir, "q.txt", "answers"), &sub) == STATUS_OK);
+    string subID = formatSubmissionID(sub->submissionID);
+    CHECK(app.grade(subID, 8, "ok") == STATUS_OK);
+    CHECK(app.deleteAssignment(first) == STATUS_OK);
+    CHECK(app.history.size() == 5);
+
+    Change change;
+    CHECK(app.undo(&change) == STATUS_OK && change.type == CHANGE_DELETE);
+    CHECK(titleOf(app, first) == "Quiz (final)/20");
+    CHECK(app.undo(&change) == STATUS_OK && change.type == CHANGE_GRADE);
+    CHECK(app.submissions.searchByID(subID)->status == SUBMISSION_PENDING);
+    CHECK(app.submissions.pendingCount() == 1);
+    CHECK(app.undo(&change) == STATUS_OK && change.type == CHANGE_EDIT);
+    CHECK(titleOf(app, first) == "Quiz/10");
+    CHECK(app.assignments.searchAllByTitle("Quiz").size() == 2);
+    CHECK(app.undo(&change) == STATUS_OK && change.type == CHANGE_CREATE && change.assignmentID == second);
+    CHECK(titleOf(app, second) == "-");
+    CHECK(titleOf(app, first) == "Quiz/10");
+    CHECK(app.assignments.searchAllByTitle("Quiz").size() == 1);
+
+    vector<bool> undone;
+    app.history.forEachChange([&](const Change&, bool reverted) { undone.push_back(reverted); });
+    CHECK(undone == (vector<bool>{true, true, true, true, false}));
+
+    CHECK(app.redo(&change) == STATUS_OK && change.type == CHANGE_CREATE);
+    CHECK(titleOf(app, second) == "Quiz/10");
+    CHECK(app.redo(&change) == STATUS_OK && change.type == CHANGE_EDIT);
+    CHECK(titleOf(app, first) == "Quiz (final)/20");
+    CHECK(app.redo(&change) == STATUS_OK && change.type == CHANGE_GRADE);
+    CHECK(app.submissions.searchByID(subID)->score == 8);
+    app.close();
+
+    // Undo and redo pick up where they were after a restart, and a new
+    // change discards what could have been redone
+    ELearningSystem reopened;
+    CHECK(reopened.open(base));
+    CHECK(reopened.history.size() == 5);
+    CHECK(reopened.redo(&change) == STATUS_OK && change.type == CHANGE_DELETE);
+    CHECK(titleOf(reopened, first) == "-");
+    CHECK(reopened.undo() == STATUS_OK);
+    CHECK(reopened.undo() == STATUS_OK);
+    CHECK(reopened.submissions.searchByID(subID)->status == SUBMISSION_PENDING);
+    CHECK(reopened.createAssignment({"Essay", "", "2025-05-01", 5}) == STATUS_OK);
+    CHECK(reopened.redo() == STATUS_EMPTY);
+    CHECK(reopened.history.size() == 4);
+
+    for (size_t i = 0; i < HISTORY_LIMIT + 20; i++)
+        CHECK(reopened.createAssignment({"Filler " + to_string(i), "", "2025-06-01", 5}) == STATUS_OK);
+    CHECK(reopened.history.size() == HISTORY_LIMIT);
+    size_t steps = 0;
+    while (reopened.undo() == STATUS_OK) steps++;
+    CHECK(steps == HISTORY_LIMIT);
+    CHECK(reopened.assignmentCount() == 23);
+    CHECK(titleOf(reopened, first) == "Quiz (final)/20");
+    reopened.close();
+}
+
+// ============== CALENDAR INDEX ==============
+static vector<string> dueBetween(ELearningSystem& app, const string& from, const string& to) {
+    vector<string> dates;
+    app.assignments.forEachDueBetween(dayNumber(from), dayNumber(to),
+        [&](string_view, string_view, string_view dueDate, int) { dates.push_back(string(dueDate)); });
+    return dates;
+}
+
+// Month ends, leap days and year ends: day numbers must be consecutive
+// across them, and range queries must include both end days whether the
+// assignments are in the calendar or in a mapped snapshot
+static void testCalendarMonthEnds(const string& dir) {
+    CHECK(isValidDate("2024-02-29"));
+    CHECK(isValidDate("2000-02-29"));
+    CHECK(!isValidDate("2025-02-29"));
+    CHECK(!isValidDate("2100-02-29"));
+    CHECK(!isValidDate("2025-04-31"));
+    CHECK(!isValidDate("2025-13-01"));
+    CHECK(!isValidDate("2025-00-10"));
+    CHECK(isValidDate("2025-12-31"));
+    CHECK(dayNumber("1970-01-01") == 0);
+    CHECK(dayNumber("2025-03-01") - dayNumber("2025-02-28") == 1);
+    CHECK(dayNumber("2024-03-01") - dayNumber("2024-02-28") == 2);
+    CHECK(dayNumber("2025-01-01") - dayNumber("2024-12-31") == 1);
+    CHECK(dayNumber("2025-05-01") - dayNumber("2025-04-30") == 1);
+
+    // Every day from 1999 to 2101 formats back to a valid date, one day on
+    int mismatches = 0;
+    string previous = "1998-12-31";
+    for (int day = dayNumber("1999-01-01"); day <= dayNumber("2101-12-31"); day++) {
+        string date = formatDay(day);
+        if (!isValidDate(date) || dayNumber(date) != day || date <= previous) mismatches++;
+        previous = date;
+    }
+    CHECK(mismatches == 0);
+
+    string base = dir + "/course";
+    const char* dates[] = {"2025-03-31", "2025-01-31", "2024-02-29", "2025-02-28", "2025-03-01",
+                           "2025-04-30", "2024-12-31", "2025-01-01", "2025-02-28"};
+    ELearningSystem app;
+    CHECK(app.open(base));
+    for (const char* date : dates) CHECK(app.createAssignment({"Due " + string(date), "", date, 10}) == STATUS_OK);
+    CHECK(app.createAssignment({"Bad", "", "2025-02-29", 10}) == STATUS_INVALID);
+
+    auto checkRanges = [&](ELearningSystem& system) {
+        CHECK(dueBetween(system, "2025-02-01", "2025-02-28") == (vector<string>{"2025-02-28", "2025-02-28"}));
+        CHECK(dueBetween(system, "2025-02-28", "2025-03-01") ==
+              (vector<string>{"2025-02-28", "2025-02-28", "2025-03-01"}));
+        CHECK(dueBetween(system, "2024-02-01", "2024-02-29") == (vector<string>{"2024-02-29"}));
+        CHECK(dueBetween(system, "2024-12-31", "2025-01-01") == (vector<string>{"2024-12-31", "2025-01-01"}));
+        CHECK(dueBetween(system, "2025-03-02", "2025-03-30").empty());
+        CHECK(dueBetween(system, "2025-03-31", "2025-04-30") == (vector<string>{"2025-03-31", "2025-04-30"}));
+        CHECK(dueBetween(system, "2025-05-01", "2025-12-31").empty());
+        CHECK(dueBetween(system, "2020-01-01", "2030-01-01").size() == 9);
+    };
+    checkRanges(app);
+    app.close();
+
+    ELearningSystem reopened;
+    CHECK(reopened.open(base));
+    checkRanges(reopened);
+    // New assignments on top of the snapshot interleave with it
+    CHECK(reopened.createAssignment({"Late Feb", "", "2025-02-28", 10}) == STATUS_OK);
+    CHECK(reopened.createAssignment({"Early Mar", "", "2025-03-01", 10}) == STATUS_OK);
+    CHECK(dueBetween(reopened, "2025-02-28", "2025-03-01") ==
+          (vector<string>{"2025-02-28", "2025-02-28", "2025-02-28", "2025-03-01", "2025-03-01"}));
+
+    // "Due within a week" counts today and the seventh day from now
+    int today = reopened.today();
+    for (int offset : {-1, 0, 7, 8})
+        CHECK(reopened.createAssignment({"Soon " + to_string(offset), "", formatDay(today + offset), 10}) == STATUS_OK);
+    vector<string> soon;
+    reopened.forEachDueWithin(7, [&](string_view, string_view title, string_view, int) { soon.push_back(string(title)); });
+    CHECK(soon == (vector<string>{"Soon 0", "Soon 7"}));
+    reopened.close();
+}
+
+// ============== FULL-TEXT INDEX ==============
+// BM25 computed the slow way over a plain copy of the documents
+static vector<TextHit> bm25(const map<uint32_t, vector<string>>& docs, const string& query, bool matchAll,
+                            size_t limit) {
+    vector<string> words;
+    forEachToken(query, [&](const string& word) {
+        if (find(words.begin(), words.end(), word) == words.end()) words.push_back(word);
+    });
+    double totalLength = 0;
+    for (auto& doc : docs) totalLength += doc.second.size();
+    vector<double> idf;
+    for (const string& word : words) {
+        double live = 0;
+        for (auto& doc : docs) live += count(doc.second.begin(), doc.second.end(), word) > 0;
+        if (live == 0 && matchAll) return {};
+        idf.push_back(log(1 + (docs.size() - live + 0.5) / (live + 0.5)));
+    }
+    vector<TextHit> hits;
+    for (auto& doc : docs) {
+        double score = 0;
+        bool any = false, all = true;
+        for (size_t i = 0; i < words.size(); i++) {
+            double tf = (double)count(doc.second.begin(), doc.second.end(), words[i]);
+            if (tf == 0) {
+                all = false;
+                continue;
+            }
+            any = true;
+            double norm = 1 - BM25_B + BM25_B * docs.size() / totalLength * doc.second.size();
+            score += idf[i] * tf * (BM25_K1 + 1) / (tf + BM25_K1 * norm);
+        }
+        if (matchAll ? all && any : any) hits.push_back({doc.first, score});
+    }
+    sort(hits.begin(), hits.end(), [](const TextHit& a, const TextHit& b) {
+        return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+    });
+    if (hits.size() > limit) hits.resize(limit);
+    return hits;
+}
+
+static bool sameHits(const vector<TextHit>& got, const vector<TextHit>& expected) {
+    if (got.size() != expected.size()) return false;
+    for (size_t i = 0; i < got.size(); i++)
+        if (got[i].doc != expected[i].doc || fabs(got[i].score - expected[i].score) > 1e-9) return false;
+    return true;
+}
+
+// Ranked AND and OR queries match a brute-force BM25 while documents are
+// added out of order, replaced and removed; then the index is checked
+// through the facade, where it follows edits, grades and undo
+static void testBm25Ranking(const string& dir) {
+    CHECK(TextIndex().search("anything", false, 10).empty());
+
+    TextIndex index;
+    index.add(1, "Linked list: a linked list, reversed");
+    index.add(2, "Binary search trees");
+    index.add(3, "Hash tables with linear probing, a long description of probing and of tables in general");
+    index.add(4, "LINKED list, sorted and reversed");
+    index.add(5, "Linked list");
+    vector<TextHit> hits = index.search("linked", false, 10);
+    // Same length: twice beats once. Once in two words beats once in five.
+    CHECK(hits.size() == 3 && hits[0].doc == 1 && hits[1].doc == 5 && hits[2].doc == 4);
+    hits = index.search("list tables", true, 10);
+    CHECK(hits.empty());
+    hits = index.search("list tables", false, 10);
+    CHECK(hits.size() == 4 && hits[0].doc == 3);  // the rare word outweighs the common one
+    CHECK(index.search("linked binary", false, 1).size() == 1);
+    CHECK(index.search("probing!", true, 10).size() == 1);
+    index.remove(1);
+    hits = index.search("linked", false, 10);
+    CHECK(hits.size() == 2 && hits[0].doc == 5 && hits[1].doc == 4);
+    CHECK(index.documentCount() == 4);
+
+    const char* vocabulary[] = {"array", "list", "tree", "graph", "heap", "hash", "sort", "search", "queue",
+                                "stack", "trie", "matrix", "string", "bit", "path", "cycle", "merge", "split"};
+    mt19937 random(17);
+    map<uint32_t, vector<string>> docs;
+    TextIndex ranked;
+    auto write = [&](uint32_t doc) {
+        string text;
+        vector<string> words;
+        int length = 1 + (int)(random() % 40);
+        for (int i = 0; i < length; i++) {
+            // Skewed: early words are common, later ones rare
+            int pick = (int)min<unsigned>(random() % 18, random() % 18);
+            words.push_back(vocabulary[pick]);
+            text += (i % 5 == 0 ? "  " : ", ") + string(vocabulary[pick]);
+        }
+        if (doc % 7 == 0) for (char& c : text) c = (char)toupper((unsigned char)c);
+        ranked.add(doc, text);
+        docs[doc] = words;
+    };
+    vector<uint32_t> order;
+    for (uint32_t doc = 1; doc <= 600; doc++) order.push_back(doc);
+    shuffle(order.begin(), order.end(), random);
+    for (uint32_t doc : order) write(doc);
+    for (int i = 0; i < 150; i++) {
+        uint32_t doc = 1 + (uint32_t)(random() % 600);
+        if (i % 2 == 0) {
+            ranked.remove(doc);
+            docs.erase(doc);
+        } else {
+            write(doc);
+        }
+    }
+    CHECK(ranked.documentCount() == docs.size());
+
+    const char* queries[] = {"list", "trie", "split merge", "array list tree", "cycle path graph",
+                             "hash HEAP", "queue stack queue", "missing", "array missing"};
+    for (const char* query : queries) {
+        for (bool matchAll : {false, true}) {
+            for (size_t limit : {1, 10, 1000}) {
+                bool same = sameHits(ranked.search(query, matchAll, limit), bm25(docs, query, matchAll, limit));
+                CHECK(same);
+                if (!same) cerr << "  query \"" << query << "\" matchAll=" << matchAll << " limit=" << limit << "\n";
+            }
+        }
+    }
+
+    ELearningSystem app;
+    CHECK(app.open(dir + "/course"));
+    Assignment* assg = nullptr;
+    CHECK(app.createAssignment({"Graphs", "Shortest paths with Dijkstra", "2025-03-01", 10}, &assg) == STATUS_OK);
+    string graphs = assg->assignmentID;
+    CHECK(app.createAssignment({"Paths", "Paths in grids and paths in graphs", "2025-03-08", 10}, &assg) == STATUS_OK);
+    string paths = assg->assignmentID;
+    vector<Assignment*> found = app.searchAssignments("paths", false);
+    CHECK(found.size() == 2 && found[0]->assignmentID == paths);
+    CHECK(app.searchAssignments("dijkstra grids", true).empty());
+    CHECK(app.editAssignment(graphs, {"Graphs", "Shortest paths in grids", "2025-03-01", 10}) == STATUS_OK);
+    CHECK(app.searchAssignments("dijkstra", false).empty());
+    CHECK(app.searchAssignments("dijkstra grids", false).size() == 2);
+    CHECK(app.undo() == STATUS_OK);
+    CHECK(app.searchAssignments("dijkstra", false).size() == 1);
+
+    Submission* sub = nullptr;
+    CHECK(app.submit(student("S1"), paths, writeFile(dir, "p.txt", "bfs"), &sub) == STATUS_OK);
+    string subID = formatSubmissionID(sub->submissionID);
+    CHECK(app.searchFeedback("recursion", false).empty());
+    CHECK(app.grade(subID, 9, "Clean recursion, missing base case") == STATUS_OK);
+    CHECK(app.searchFeedback("recursion base", true).size() == 1);
+    CHECK(app.undo() == STATUS_OK);
+    CHECK(app.searchFeedback("recursion", false).empty());
+    app.close();
+}
+
+// ============== GRADING SCHEDULER ==============
+static GraderStats statsOf(const vector<GraderStats>& all, const string& grader) {
+    for (const GraderStats& stats : all)
+        if (stats.grader == grader) return stats;
+    return GraderStats{grader, 0, 0, 0, 0, 0.0};
+}
+
+// Leases run out at exactly claim time + lease time; an expired item goes
+// back to the queue in its old place, its former holder can no longer
+// complete or release it, and a stale lease never returns an item that was
+// claimed again, completed or removed since
+static void testLeaseExpiry(const string& dir) {
+    typedef GradingScheduler::Clock Clock;
+    const Clock::time_point start = Clock::time_point() + chrono::hours(1);
+    auto at = [&](int minutes) { return start + chrono::minutes(minutes); };
+    auto always = [](uint32_t) { return true; };
+
+    GradingScheduler scheduler(chrono::minutes(10));
+    for (uint32_t id = 1; id <= 5; id++) scheduler.add(id, intern(id % 2 ? "ASSG1" : "ASSG2"), 100 - id);
+    uint32_t claimed = 0;
+    CHECK(scheduler.claim("ann", GRADE_OLDEST_FIRST, at(0), claimed, always) && claimed == 1);
+    CHECK(scheduler.claim("bob", GRADE_OLDEST_FIRST, at(2), claimed, always) && claimed == 2);
+    CHECK(scheduler.queued() == 3);
+    CHECK(scheduler.holds("ann", 1, at(10) - chrono::nanoseconds(1)));
+    CHECK(scheduler.complete("bob", 1, at(5)) == STATUS_INVALID);
+    CHECK(scheduler.release("bob", 1, at(5)) == STATUS_INVALID);
+
+    CHECK(!scheduler.holds("ann", 1, at(10)));
+    CHECK(scheduler.queued() == 4);
+    CHECK(scheduler.complete("ann", 1, at(11)) == STATUS_INVALID);
+    CHECK(scheduler.release("ann", 1, at(11)) == STATUS_INVALID);
+    CHECK(scheduler.holds("bob", 2, at(11)));
+    CHECK(!scheduler.holds("bob", 2, at(12)));
+    CHECK(scheduler.queued() == 5);
+
+    // Back in arrival order; the new lease is the only one that counts
+    CHECK(scheduler.claim("cat", GRADE_OLDEST_FIRST, at(13), claimed, always) && claimed == 1);
+    CHECK(scheduler.claim("cat", GRADE_NEAREST_DUE, at(13), claimed, always) && claimed == 5);
+    CHECK(scheduler.holds("cat", 1, at(22)));
+    CHECK(scheduler.complete("cat", 1, at(22)) == STATUS_OK);
+    CHECK(scheduler.release("cat", 5, at(22)) == STATUS_OK);
+    CHECK(!scheduler.holds("cat", 5, at(22)));
+    CHECK(scheduler.queued() == 4);
+
+    // A submission graded elsewhere while leased is gone for good
+    CHECK(scheduler.claim("dan", GRADE_BY_ASSIGNMENT, at(30), claimed, always) && claimed == 2);
+    CHECK(scheduler.claim("dan", GRADE_BY_ASSIGNMENT, at(30), claimed, always) && claimed == 4);
+    scheduler.remove(2);
+    CHECK(!scheduler.holds("dan", 2, at(31)));
+    CHECK(scheduler.queued() == 2);
+    CHECK(!scheduler.holds("dan", 4, at(40)));
+    CHECK(scheduler.queued() == 3);
+    vector<uint32_t> rest;
+    while (scheduler.claim("eve", GRADE_OLDEST_FIRST, at(41), claimed, always)) rest.push_back(claimed);
+    CHECK(rest == (vector<uint32_t>{3, 4, 5}));
+
+    vector<GraderStats> stats = scheduler.graderStats();
+    CHECK(statsOf(stats, "ann").claimed == 1 && statsOf(stats, "ann").expired == 1);
+    CHECK(statsOf(stats, "bob").expired == 1);
+    CHECK(statsOf(stats, "cat").completed == 1 && statsOf(stats, "cat").released == 1);
+    CHECK(fabs(statsOf(stats, "cat").busySeconds - 9 * 60) < 1e-6);
+    CHECK(statsOf(stats, "dan").expired == 1);
+
+    // The same through the facade, on the real clock
+    ELearningSystem app;
+    CHECK(app.open(dir + "/course"));
+    Assignment* assg = nullptr;
+    CHECK(app.createAssignment({"Lab", "", "2025-02-01", 10}, &assg) == STATUS_OK);
+    CHECK(app.submit(student("S1"), assg->assignmentID, writeFile(dir, "a.txt", "a")) == STATUS_OK);
+    app.setLeaseTime(chrono::milliseconds(50));
+    string first, second;
+    CHECK(app.claimNextSubmission("ann", GRADE_OLDEST_FIRST, &first) == STATUS_OK);
+    CHECK(app.claimNextSubmission("bob", GRADE_OLDEST_FIRST, &second) == STATUS_EMPTY);
+    this_thread::sleep_for(chrono::milliseconds(80));
+    CHECK(app.completeGrading("ann", first, 5, "late") == STATUS_INVALID);
+    CHECK(app.claimNextSubmission("bob", GRADE_OLDEST_FIRST, &second) == STATUS_OK && second == first);
+    app.setLeaseTime(chrono::minutes(30));
+    CHECK(app.completeGrading("bob", second, 6, "done") == STATUS_OK);
+    CHECK(app.submissions.searchByID(second)->score == 6);
+    CHECK(app.claimNextSubmission("ann", GRADE_OLDEST_FIRST, &first) == STATUS_EMPTY);
+    CHECK(statsOf(app.graderStats(), "ann").expired == 1);
+    app.close();
+}
+
+// ============== BLOB STORE ==============
+static string blobContents(const BlobStore& blobs, const string& digest, bool* ok = nullptr) {
+    string contents;
+    bool read = blobs.read(digest, [&](const unsigned char* data, size_t size) { contents.append((const char*)data, size); });
+    if (ok) *ok = read;
+    return contents;
+}
+
+// Files are stored once under their SHA-256 however often they are put and
+// whichever way they were stored, and compressed blobs read back byte for
+// byte: compressible, incompressible, empty and multi-chunk files alike
+static void testBlobDedupAndCompression(const string& dir) {
+    BlobStore blobs;
+    CHECK(blobs.open(dir + "/blobs"));
+    string digest, again;
+    CHECK(blobs.put(writeFile(dir, "abc.txt", "abc"), digest) == STATUS_OK);
+    CHECK(digest == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(blobs.put(writeFile(dir, "copy.txt", "abc"), again) == STATUS_OK && again == digest);
+    CHECK(blobs.put(writeFile(dir, "empty.txt", ""), again) == STATUS_OK);
+    CHECK(again == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(blobs.sizeOf(again) == 0 && blobContents(blobs, again).empty());
+    CHECK(blobs.put(dir + "/missing.txt", again) == STATUS_FILE_ERROR);
+    BlobStats stats = blobs.stats();
+    CHECK(stats.stored == 2 && stats.deduplicated == 1);
+
+    mt19937 random(25);
+    string text;  // repetitive, like source code
+    while (text.size() < 3 * BLOB_CHUNK + 123)
+        text += "for (int i = 0; i < n; i++) total += values[" + to_string(random() % 50) + "];\n";
+    string noise(2 * BLOB_CHUNK + 7, '\0');
+    for (char& c : noise) c = (char)(random() & 0xFF);
+    string run(BLOB_CHUNK, 'a');  // overlapping matches at distance 1
+
+    long long writtenBefore = blobs.stats().bytesWritten;
+    blobs.setCompression(true);
+    CHECK(blobs.put(writeFile(dir, "abc2.txt", "abc"), again) == STATUS_OK && again == digest);  // stored raw before
+    CHECK(blobContents(blobs, digest) == "abc");
+    for (const string* contents : {&text, &noise, &run}) {
+        string path = writeFile(dir, "file.bin", *contents);
+        string packed;
+        CHECK(blobs.put(path, packed) == STATUS_OK && blobs.contains(packed));
+        bool ok = false;
+        CHECK(blobContents(blobs, packed, &ok) == *contents && ok);
+        CHECK(blobs.sizeOf(packed) == (long long)contents->size());
+        CHECK(blobs.put(path, again) == STATUS_OK && again == packed);
+        CHECK(blobs.checkout(packed, dir + "/out.bin") == STATUS_OK);
+        CHECK(readFile(dir + "/out.bin") == *contents);
+    }
+    stats = blobs.stats();
+    CHECK(stats.stored == 5 && stats.deduplicated == 5);
+    long long written = stats.bytesWritten - writtenBefore;
+    CHECK(written < (long long)(text.size() / 4 + noise.size() + noise.size() / 100 + run.size() / 50));
+
+    // Chunks round-trip at every small size and at the chunk limit
+    vector<uint32_t> table;
+    vector<unsigned char> packed(BLOB_CHUNK + BLOB_CHUNK / 255 + 16), unpacked(BLOB_CHUNK);
+    int mismatches = 0;
+    for (size_t size : {(size_t)1, (size_t)3, (size_t)4, (size_t)5, (size_t)12, (size_t)13, (size_t)100, BLOB_CHUNK}) {
+        for (const string* contents : {&text, &noise, &run}) {
+            const unsigned char* in = (const unsigned char*)contents->data();
+            size_t stored = compressChunk(in, size, packed.data(), table);
+            if (!decompressChunk(packed.data(), stored, unpacked.data(), size) || memcmp(in, unpacked.data(), size) != 0)
+                mismatches++;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    // A cut-short compressed blob reads as corrupt, not as a shorter file
+    string textDigest;
+    CHECK(blobs.put(writeFile(dir, "text.txt", text), textDigest) == STATUS_OK);
+    string blobPath = dir + "/blobs/" + textDigest.substr(0, 2) + "/" + textDigest.substr(2) + ".lz";
+    string stored = readFile(blobPath);
+    CHECK(!stored.empty());
+    writeFile(dir + "/blobs/" + textDigest.substr(0, 2), textDigest.substr(2) + ".lz", stored.substr(0, stored.size() / 2));
+    bool ok = true;
+    blobContents(blobs, textDigest, &ok);
+    CHECK(!ok);
+    CHECK(!blobs.read(string(64, 'z'), [](const unsigned char*, size_t) {}));
+
+    // Submissions reference the digest, so two students' identical files
+    // share one blob
+    ELearningSystem app;
+    CHECK(app.open(dir + "/course"));
+    Assignment* assg = nullptr;
+    CHECK(app.createAssignment({"Lab", "", "2025-02-01", 10}, &assg) == STATUS_OK);
+    Submission* first = nullptr;
+    Submission* second = nullptr;
+    CHECK(app.submit(student("S1"), assg->assignmentID, writeFile(dir, "one.txt", text), &first) == STATUS_OK);
+    CHECK(app.submit(student("S2"), assg->assignmentID, writeFile(dir, "two.txt", text), &second) == STATUS_OK);
+    CHECK(first->file == second->file && isBlobDigest(first->file));
+    CHECK(app.blobs.stats().stored == 1 && app.blobs.stats().deduplicated == 1);
+    CHECK(app.copySubmittedFile(formatSubmissionID(second->submissionID), dir + "/copy.bin") == STATUS_OK);
+    CHECK(readFile(dir + "/copy.bin") == text);
+    app.close();
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)(const string& dir);
+};
+
+static const TestCase TESTS[] = {
+    {"system.assignmentLifecycle", testAssignmentLifecycle},
+    {"bplus.duplicatesAndScans", testBPlusDuplicatesAndScans},
+    {"wal.replayAfterTruncation", testWalReplayAfterTruncation},
+    {"snapshot.roundTrip", testSnapshotRoundTrip},
+    {"intake.concurrentDuplicateClaims", testConcurrentDuplicateClaims},
+    {"history.undoRedo", testUndoRedo},
+    {"calendar.monthEnds", testCalendarMonthEnds},
+    {"text.bm25Ranking", testBm25Ranking},
+    {"scheduler.leaseExpiry", testLeaseExpiry},
+    {"blobs.dedupAndCompression", testBlobDedupAndCompression},
+};
+
+int main(int argc, char** argv) {
+    string filter = argc > 1 ? argv[1] : "";
+    filesystem::path root = filesystem::absolute("elearning-tests.tmp");
+    int ran = 0;
+    for (const TestCase& test : TESTS) {
+        if (string(test.name).find(filter) == string::npos) continue;
+        filesystem::path dir = root / test.name;
+        filesystem::remove_all(dir);
+        filesystem::create_directories(dir);
+        int failedBefore = failures;
+        test.run(dir.string());
+        if (failures != failedBefore) cerr << "FAILED " << test.name << "\n";
+        filesystem::remove_all(dir);
+        ran++;
+    }
+    filesystem::remove_all(root);
+    cout << ran << " tests, " << checks << " checks, " << failures << " failed\n";
+    return failures == 0 && ran > 0 ? 0 : 1;
+}